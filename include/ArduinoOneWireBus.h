@@ -0,0 +1,25 @@
+#ifndef ARDUINO_ONE_WIRE_BUS_H
+#define ARDUINO_ONE_WIRE_BUS_H
+
+#include <Arduino.h>
+#include <OneWire.h>
+#include "OneWireBus.h"
+
+// Reserveløsning oven på OneWire-biblioteket. Hvert tidsvindue bit-banges med
+// interrupts slået fra, så den bruges kun, hvis RMT-kanalerne ikke kan fås.
+class ArduinoOneWireBus : public OneWireBus {
+public:
+  explicit ArduinoOneWireBus(uint8_t pin);
+
+  bool begin() override;
+  bool reset() override;
+  void writeBytes(const uint8_t *data, uint8_t len) override;
+  void readBytes(uint8_t *data, uint8_t len) override;
+  bool readBit() override;
+  void writeBit(bool bit) override;
+
+private:
+  OneWire wire;
+};
+
+#endif // ARDUINO_ONE_WIRE_BUS_H
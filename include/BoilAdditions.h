@@ -0,0 +1,71 @@
+#ifndef BOIL_ADDITIONS_H
+#define BOIL_ADDITIONS_H
+
+#include <Arduino.h>
+
+// Tilsætninger under kogningen (humle, klaringsmiddel, whirlpool …), angivet
+// som i opskrifter: minutter før kogningens slutning. 0 = ved kogningens
+// afslutning (flameout/whirlpool).
+//
+// Tekstformatet (web og /debug) er én tilsætning pr. ';':
+//   "min,navn[,gram]"  fx "60,Magnum,25;15,Irish moss;0,Whirlpool"
+// ',', ';' og '\' i et navn skrives med '\' foran: "60,Goldings\, East Kent,25".
+struct BoilAddition {
+  static constexpr size_t NAME_SIZE = 20;
+
+  char name[NAME_SIZE];
+  uint16_t minutes;
+  uint16_t grams;  // 0 = ikke angivet
+};
+
+struct BoilAdditions {
+  static constexpr uint8_t MAX_ADDITIONS = 10;
+  static constexpr uint16_t MAX_MINUTES = 240;
+  // Lagerformatet: minutter, gram og navnet uden afsluttende nul.
+  static constexpr size_t STORED_ADDITION_SIZE = 4 + BoilAddition::NAME_SIZE - 1;
+
+  uint8_t count = 0;
+  BoilAddition items[MAX_ADDITIONS] = {};
+
+  // Tilføjer én tilsætning; navnet gemmes, som det er, blot afkortet.
+  // false, hvis listen er fuld.
+  bool add(const char *name, uint16_t minutes, uint16_t grams);
+  bool isValid() const;
+  // Erstatter listen, hvis teksten er gyldig; ellers er listen uændret.
+  bool parse(const char *text);
+  String toString() const;
+
+  void pack(uint8_t index, uint8_t out[STORED_ADDITION_SIZE]) const;
+  void unpack(uint8_t index, const uint8_t in[STORED_ADDITION_SIZE]);
+};
+
+// Nedtællingens tilsætninger ordnet efter, hvornår de skal i: en min-heap med
+// fast kapacitet af (sekunder efter kogestart, indeks i BoilAdditions). Ved
+// samme tidspunkt kommer tilsætningen med laveste indeks først, så
+// rækkefølgen er den samme, når heapen genopbygges efter et strømsvigt.
+class AdditionHeap {
+public:
+  struct Entry {
+    uint32_t dueSec;
+    uint8_t index;
+  };
+
+  void clear() { size = 0; }
+  bool empty() const { return size == 0; }
+  uint8_t count() const { return size; }
+  const Entry &top() const { return entries[0]; }
+  bool push(uint32_t dueSec, uint8_t index);
+  void pop();
+
+  // Heapen for en kogning på boilSec sekunder; tilsætninger, der er længere
+  // end kogningen, skal i ved kogestart.
+  void load(const BoilAdditions &additions, uint32_t boilSec);
+
+private:
+  static bool before(const Entry &a, const Entry &b);
+
+  Entry entries[BoilAdditions::MAX_ADDITIONS];
+  uint8_t size = 0;
+};
+
+#endif // BOIL_ADDITIONS_H
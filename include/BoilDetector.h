@@ -0,0 +1,48 @@
+#ifndef BOIL_DETECTOR_H
+#define BOIL_DETECTOR_H
+
+#include <Arduino.h>
+
+// Genkender et rullende kog ud fra grydetemperaturens plateau. Urten
+// stiger, til den når kogepunktet, og står derefter stille, selvom gassen
+// brænder videre. Detektoren tager én temperatur pr. SAMPLE_MS i et glidende
+// vindue på WINDOW_SAMPLES og melder kog, når
+//   - hele vinduet ligger over tærsklen (kogepunktet minus en margin) og
+//   - hældningen over vinduet (mindste kvadrater) er højst PLATEAU_RATE.
+// Kogepunktet følger højden over havet (barometrisk formel og
+// Clausius-Clapeyron), og marginen dækker sensorens kalibrering og
+// opløste stoffer. Et hul i målingerne (pause, sensorfejl) starter vinduet forfra.
+// Fast hukommelsesforbrug – ingen heap.
+class BoilDetector {
+public:
+  static constexpr unsigned long SAMPLE_MS = 10000;
+  static constexpr uint8_t WINDOW_SAMPLES = 12;  // 2 min
+  static constexpr float PLATEAU_RATE = 0.15f;   // °C/min
+
+  // Vands kogepunkt i højden altitudeM (m over havet).
+  static float boilingPointC(float altitudeM);
+
+  // marginC: hvor langt under kogepunktet vinduet skal ligge.
+  void configure(float altitudeM, float marginC);
+  void reset();
+  // Kaldes med hver gyldig grydetemperatur. Returnerer true én gang, når
+  // kogepunktet er nået; derefter forbliver isBoiling() sand til reset().
+  bool update(float temperatureC, unsigned long nowMs);
+
+  bool isBoiling() const { return boiling; }
+  float getBoilingPoint() const { return boilingPoint; }
+  float getThreshold() const { return boilingPoint - margin; }
+  // Hældning over vinduet i °C/min; NAN, indtil vinduet er fuldt.
+  float getRate() const;
+
+private:
+  float boilingPoint = 100.0f;
+  float margin = 3.0f;
+  float samples[WINDOW_SAMPLES] = {};
+  uint8_t count = 0;
+  uint8_t head = 0;  // Næste plads i ringen
+  unsigned long lastSampleMs = 0;
+  bool boiling = false;
+};
+
+#endif // BOIL_DETECTOR_H
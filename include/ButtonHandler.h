@@ -0,0 +1,33 @@
+#ifndef BUTTON_HANDLER_H
+#define BUTTON_HANDLER_H
+
+#include <Arduino.h>
+
+// Knappen (aktiv lav) uden polling i loop(): en GPIO-ISR stempler hvert
+// niveauskift i en lille låsefri ring, og en periodisk timer (Hal::startPeriodic)
+// debouncer skiftene og genkender gestus. Et tryk går derfor ikke tabt, selvom
+// loop() er optaget af sensorlæsning eller webserveren.
+//
+//   SHORT   – sluppet inden LONG_PRESS_MS og ikke fulgt af et nyt tryk inden
+//             for DOUBLE_GAP_MS
+//   DOUBLE  – to korte tryk inden for DOUBLE_GAP_MS
+//   LONG    – holdt i LONG_PRESS_MS (meldes, mens knappen stadig er nede)
+//
+// Gestus leveres til sink'en fra timerens kontekst, stemplet med tidspunktet
+// (Hal::millis64) for det slip eller tryk, der afgjorde den.
+class ButtonHandler {
+public:
+  enum class Gesture : uint8_t { SHORT, DOUBLE, LONG };
+  using Sink = bool (*)(Gesture gesture, uint64_t timestampMs);
+
+  static constexpr unsigned long DEBOUNCE_MS = 30;
+  static constexpr unsigned long DOUBLE_GAP_MS = 400;
+  static constexpr unsigned long LONG_PRESS_MS = 3000;
+  static constexpr unsigned long TICK_MS = 10;
+
+  static void begin(uint8_t pin, Sink sink);
+  // Skift, der ikke var plads til i ringen (kun ved prel ud over det sædvanlige).
+  static uint32_t getLostEdges();
+};
+
+#endif // BUTTON_HANDLER_H
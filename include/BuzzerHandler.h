@@ -0,0 +1,36 @@
+#ifndef BUZZER_HANDLER_H
+#define BUZZER_HANDLER_H
+
+#include <Arduino.h>
+
+// Buzzeren spiller mønstre (tone/varighed-sekvenser fra en tabel i
+// BuzzerHandler.cpp) uden delay() og uden at loop() skal holde tonen i live:
+// en periodisk timer (Hal::startPeriodic) går sekvensen igennem og skriver
+// kun til LEDC, når tonen faktisk skifter.
+//
+// Flere mønstre kan være ønsket på én gang; det med højest prioritet spilles,
+// og de øvrige genoptages forfra, når det stopper. Gentagne mønstre spiller
+// til stop(); enkeltstående (STEP_DONE) stopper af sig selv.
+class BuzzerHandler {
+public:
+  // I stigende prioritet.
+  enum class Pattern : uint8_t {
+    STEP_DONE,  // Kort stigende signal: trin eller mæskning færdig
+    CONFIRM,    // Kalder på bekræftelse
+    ADDITION,   // Kalder på en kogetilsætning
+    FAULT,      // Sensoralarm
+    COUNT
+  };
+
+  static constexpr unsigned long TICK_MS = 10;
+
+  static void begin(uint8_t pin);
+  // Kan kaldes fra loop() og andre tasks; timeren ser ønsket ved næste tick.
+  static void start(Pattern pattern);
+  static void stop(Pattern pattern);
+  static bool isRequested(Pattern pattern);
+  // Et mønster spiller (også i dets pauser).
+  static bool isSounding();
+};
+
+#endif // BUZZER_HANDLER_H
@@ -0,0 +1,35 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+
+// Tidsbasen for styringen.
+//  - nowMs(): monotont 64-bit ur (esp_timer), der aldrig løber over; bruges
+//    til alle varigheder (nedtællinger, pauser, hændelsernes tidsstempler).
+//  - epoch(): vægurets tid i UTC fra SNTP-klienten, der kører i baggrunden
+//    i IDF/lwIP. Kaldet læser kun systemuret – ingen netværkstrafik.
+//  - Visningen følger tidszonen (POSIX TZ med sommertidsregler), og
+//    klokkeslættet formateres højst én gang i sekundet.
+class Clock {
+public:
+  static constexpr const char *DEFAULT_TIMEZONE = "CET-1CEST,M3.5.0,M10.5.0/3";  // Danmark
+  static constexpr size_t TIMEZONE_SIZE = 48;
+
+  static void begin(const char *timezone);
+  // Ugyldig eller tom tekst giver DEFAULT_TIMEZONE. Kan skiftes når som helst.
+  static void setTimezone(const char *timezone);
+  static const char *getTimezone();
+  static bool isValidTimezone(const char *timezone);
+  // Venter højst timeoutMs på første SNTP-synkronisering (kun ved opstart).
+  static bool waitForSync(unsigned long timeoutMs);
+
+  static uint64_t nowMs();
+  static unsigned long epoch();  // Sekunder siden 1970 (UTC), 0 hvis ukendt
+  static bool isSynced();
+
+  // Lokal tid som "HH:MM:SS" ("--:--:--", når tiden ikke er kendt).
+  static const String &localTimeString();
+  static String formatLocal(unsigned long epoch);
+};
+
+#endif // CLOCK_H
@@ -2,6 +2,11 @@
 #define EEPROMHANDLER_H
 
 #include <Arduino.h>
+#include "MashSchedule.h"
+#include "BoilAdditions.h"
+#include "Clock.h"
+#include "RelayActuator.h"
+#include "Vessel.h"
 
 struct Config {
     char ssid[32];
@@ -11,11 +16,22 @@ struct Config {
     char sn[16];
     float tempOffset;
     float hysteresis;
+    // Mæskning/udmæskning fra før mæskeplanen. Bruges kun til at danne
+    // planen første gang; derefter er det planen, der gemmes og ændres.
     unsigned long mashTime;      // i sekunder
     unsigned long mashoutTime;   // i sekunder
     unsigned long boilTime;      // i sekunder
     float mashSetpoint;
     float mashoutSetpoint;
+    // PID-regulering af gassen (se PidController.h)
+    float pidKp;                 // %/°C
+    float pidKi;                 // %/(°C·s)
+    float pidKd;                 // %·s/°C
+    unsigned long pidWindow;     // Tidsproportionalt vindue i sekunder
+    char timezone[Clock::TIMEZONE_SIZE];  // POSIX TZ, fx "CET-1CEST,M3.5.0,M10.5.0/3"
+    // Automatisk kogepunkt (se BoilDetector.h)
+    float boilAltitude;          // Højde over havet i meter
+    float boilThreshold;         // °C under kogepunktet, hvor plateauet søges
 };
 
 class EEPROMHandler {
@@ -25,10 +41,46 @@ public:
     static void saveConfig(const Config &cfg);
     static void resetToDefaults();
     static String getConfigAsString();
+    // Mæskeplanen ligger for sig selv i et kompakt format (se MashSchedule.h).
+    static MashSchedule getSchedule();
+    static void saveSchedule(const MashSchedule &schedule);
+    // Tilsætningerne under kogningen (se BoilAdditions.h); tom, hvis ingen er gemt.
+    static BoilAdditions getAdditions();
+    static void saveAdditions(const BoilAdditions &additions);
+    // Hvert kars indstillinger (se Vessel.h). Gryden (KETTLE_VESSEL) bruger
+    // Config, mæskeplanen og tilsætningerne ovenfor; de øvrige kar har hver sin
+    // post med mæskeplan og PID og ellers standardværdier.
+    static Vessel::Settings getVesselSettings(uint8_t index);
+    static void saveVesselSchedule(uint8_t index, const MashSchedule &schedule);
+    static void saveVesselGains(uint8_t index, float kp, float ki, float kd);
+    // Hvert kars relæers levetidstællere (se RelayActuator.h); 0, hvis ingen er gemt.
+    static void getRelayCounters(uint8_t index, RelayActuator::Counters &heat, RelayActuator::Counters &pump);
+    static void saveRelayCounters(uint8_t index, const RelayActuator::Counters &heat,
+                                  const RelayActuator::Counters &pump);
     
 private:
     static Config config;
+    static MashSchedule schedule;
+    static BoilAdditions additions;
+    static RelayActuator::Counters gasCounters;
+    static RelayActuator::Counters pumpCounters;
+    // Et kar ud over gryden; post 0 (gryden) bruges ikke.
+    struct VesselRecord {
+        RelayActuator::Counters heat;
+        RelayActuator::Counters pump;
+        float pidKp;
+        float pidKi;
+        float pidKd;
+        unsigned long pidWindow;
+        MashSchedule schedule;
+    };
+    static VesselRecord vessels[VESSEL_COUNT];
     static void save();
+    static bool loadSchedule();
+    static bool loadAdditions();
+    static bool loadRelayCounters();
+    static bool loadVessel(uint8_t index);
+    static void saveVessel(uint8_t index);
 };
 
 #endif // EEPROMHANDLER_H
@@ -0,0 +1,67 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+class OneWireBus;
+
+// Tyndt hardwarelag. Styringsmodulerne (ProcessHandler, TemperatureHandler,
+// EEPROMHandler, StatusLED og webhandlerne) rører kun hardware gennem disse
+// funktioner. På ESP32-S3 ligger implementeringen i src/hal/HalEsp32.cpp; i
+// env:native ligger en simuleret udgave i src/hal/HalNative.cpp (se HalSim.h).
+namespace Hal {
+  // Ur (ms siden opstart, samme semantik som millis())
+  unsigned long millis();
+  // Samme ur med 64 bit (esp_timer), der ikke løber over efter 49 dage. ISR-sikker.
+  uint64_t millis64();
+  void delay(unsigned long ms);
+
+  // GPIO
+  void pinMode(uint8_t pin, uint8_t mode);
+  void digitalWrite(uint8_t pin, bool high);
+  bool digitalRead(uint8_t pin);  // ISR-sikker
+  // handler kaldes fra en ISR ved hvert niveauskift på pin og skal derfor
+  // være kort og ligge i IRAM (IRAM_ATTR).
+  void attachPinChange(uint8_t pin, void (*handler)());
+  // callback kaldes hvert periodMs uden for loop() (esp_timer-tasken), så den
+  // ikke venter på langsomme loop-gennemløb. Må ikke blokere.
+  bool startPeriodic(void (*callback)(), unsigned long periodMs);
+  void buzzerBegin(uint8_t pin);
+  void buzzerTone(uint16_t frequencyHz);  // 0 = stille
+  void rgbWrite(uint8_t pin, uint8_t r, uint8_t g, uint8_t b);
+
+  // Task-watchdog: watchdogBegin() melder den kaldende task til. Kører
+  // watchdoggen allerede, beholder den sin opsætning (timeout, og om den
+  // genstarter eller blot melder); ellers startes den med timeoutS og genstart.
+  bool watchdogBegin(uint32_t timeoutS);
+  void watchdogFeed();
+  // Var seneste genstart en watchdog (task, interrupt eller anden)?
+  bool wasWatchdogReset();
+
+  // Persistent lager, byte-adresseret som EEPROM. Ændringer er først gemt efter storageCommit().
+  bool storageBegin(size_t size);
+  void storageRead(int address, void *data, size_t len);
+  void storageWrite(int address, const void *data, size_t len);
+  bool storageCommit();
+
+  template <typename T>
+  void storageGet(int address, T &value) {
+    storageRead(address, &value, sizeof(T));
+  }
+
+  template <typename T>
+  void storagePut(int address, const T &value) {
+    storageWrite(address, &value, sizeof(T));
+  }
+
+  // Sensorer: en klar 1-Wire-bus på den angivne pin (nullptr hvis der ikke er flere).
+  OneWireBus *oneWireBus(uint8_t pin);
+
+  // Netværk og system
+  // Starter SNTP-klienten i baggrunden; epochTime() læser blot systemuret.
+  void networkTimeBegin();
+  unsigned long epochTime();  // Sekunder siden 1970 (UTC), 0 hvis ukendt
+  void restart();
+}
+
+#endif // HAL_H
@@ -0,0 +1,35 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <Arduino.h>
+#include "SimOneWireBus.h"
+
+// Styring af den simulerede hardware i env:native (src/hal/HalNative.cpp).
+// Uret er virtuelt og står stille, indtil simuleringen flytter det – også
+// Hal::delay() flytter blot uret, så en kørsel er helt deterministisk.
+namespace HalSim {
+  constexpr size_t STORAGE_SIZE = 4096;
+
+  void advance(unsigned long ms);
+
+  // Indgange sættes udefra (fx knappen); udgange læses tilbage.
+  void setInput(uint8_t pin, bool high);
+  bool getOutput(uint8_t pin);
+  uint32_t getWriteCount(uint8_t pin);  // Antal niveauskift på udgangen
+  bool isBuzzerOn();
+  uint32_t getBuzzerWrites();  // Antal Hal::buzzerTone()-kald
+
+  // Sensorbussen på en pin. Sensorer skal tilføjes, før TemperatureHandler::begin()
+  // søger bussen igennem. Returnerer nullptr, hvis der ikke er flere busser.
+  SimOneWireBus *sensorBus(uint8_t pin);
+
+  // Lageret overlever Hal::restart(), ligesom flash på den rigtige enhed.
+  uint8_t *storageData();
+  void eraseStorage();
+  uint32_t getCommitCount();  // Antal storageCommit() – skrivninger til flash på enheden
+
+  void setNetworkTime(unsigned long epoch);  // 0 = ingen tid (fx AP-mode)
+  uint32_t getRestartCount();
+}
+
+#endif // HAL_SIM_H
@@ -0,0 +1,47 @@
+#ifndef KETTLE_MODEL_H
+#define KETTLE_MODEL_H
+
+#include <Arduino.h>
+
+// Parametre for gryden i simuleringen. Standardværdierne svarer til ca. 30 L
+// urt i en 50 L gryde over en gasbrænder.
+struct KettleParams {
+  float ambientC = 18.0f;
+  float heatCapacityJPerK = 128000.0f;  // Urt + gryde
+  float burnerW = 6000.0f;              // Effektiv effekt ind i urten
+  float burnerTauS = 45.0f;             // Bunden opmagasinerer varme: effekten følger gassen med denne lag
+  float lossWPerK = 14.0f;              // Varmetab til omgivelserne
+  float boilC = 100.0f;                 // Overskydende effekt fordamper ved kogepunktet
+  float grydeSensorTauS = 15.0f;        // Dykrør om grydesensoren
+  float ventilSensorTauS = 20.0f;
+  float ventilRiseC = 10.0f;            // Ventilsensoren over urten ved fuld brænder uden pumpe
+  float ventilRisePumpC = 4.0f;         // … og med pumpen kørende (omrøring)
+};
+
+// Førsteordens termisk model af gryden og de to sensorer, drevet af gas- og
+// pumperelæet. Hvert led er et førsteordens system, integreret med Euler:
+//   brænder:  P' = (gas·Pmax − P) / τb
+//   urt:      C·T' = P − UA·(T − Tamb), begrænset til kogepunktet
+//   sensorer: S' = (mål − S) / τs, hvor ventilens mål ligger over urten,
+//             når brænderen varmer.
+class KettleModel {
+public:
+  explicit KettleModel(const KettleParams &params = KettleParams());
+
+  void reset(float tempC);
+  void step(float dtS, bool gasOn, bool pumpOn);
+
+  float getKettleTemp() const { return kettle; }
+  float getGrydeSensorTemp() const { return grydeSensor; }
+  float getVentilSensorTemp() const { return ventilSensor; }
+  const KettleParams &getParams() const { return params; }
+
+private:
+  KettleParams params;
+  float burnerPower = 0.0f;
+  float kettle = 0.0f;
+  float grydeSensor = 0.0f;
+  float ventilSensor = 0.0f;
+};
+
+#endif // KETTLE_MODEL_H
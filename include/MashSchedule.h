@@ -0,0 +1,57 @@
+#ifndef MASH_SCHEDULE_H
+#define MASH_SCHEDULE_H
+
+#include <Arduino.h>
+#include "Temperature.h"
+
+// Mæskeplan: en tabel af trin, som ProcessHandler afvikler i rækkefølge under
+// MASHING – fx proteinrast, beta- og alfarast og til sidst udmæskning. Sidste
+// trin i en plan med flere trin regnes for udmæskningen (/startMashout
+// springer dertil, og legacy-indstillingerne for udmæskning retter det).
+//
+// Tekstformatet (web og /debug) er ét trin pr. ';':
+//   "temp,min[,flag]"  fx "52,15;64,45;72,20,PGS;78,10"
+// hvor flag er bogstaverne P (pumpe kører), G (gassen regulerer mod temp),
+// S (bekræft med knappen, når temp er nået) og E (bekræft, når tiden er gået).
+// Udelades flag, bruges "PGSE" som i den faste mæskning/udmæskning.
+enum class PumpMode : uint8_t { OFF, ON };
+// OFF giver et passivt hvil: ingen gas, og nedtællingen starter med det samme.
+enum class GasPolicy : uint8_t { OFF, REGULATE };
+
+struct MashStep {
+  TempRaw target;
+  uint16_t minutes;
+  PumpMode pump;
+  GasPolicy gas;
+  bool confirmStart;  // Vent på knappen, når target er nået, før nedtællingen
+  bool confirmEnd;    // Vent på knappen, når tiden er gået, før næste trin
+};
+
+struct MashSchedule {
+  static constexpr uint8_t MAX_STEPS = 8;
+  static constexpr uint16_t MAX_MINUTES = 240;
+  // Lagerformatet: 5 bytes pr. trin (target, minutter, flag-byte).
+  static constexpr size_t STORED_STEP_SIZE = 5;
+
+  uint8_t count = 0;
+  MashStep steps[MAX_STEPS] = {};
+
+  // Plan med to trin svarende til den faste mæskning + udmæskning.
+  static MashSchedule makeDefault(float mashC, unsigned long mashS, float mashoutC, unsigned long mashoutS);
+
+  bool isValid() const;
+  // Erstatter planen, hvis teksten er gyldig; ellers er planen uændret.
+  bool parse(const char *text);
+  String toString() const;
+
+  const MashStep &first() const { return steps[0]; }
+  const MashStep &last() const { return steps[count - 1]; }
+  MashStep &first() { return steps[0]; }
+  MashStep &last() { return steps[count - 1]; }
+
+  void packStep(uint8_t index, uint8_t out[STORED_STEP_SIZE]) const;
+  // false, hvis flag-byten ikke kan være skrevet af packStep.
+  bool unpackStep(uint8_t index, const uint8_t in[STORED_STEP_SIZE]);
+};
+
+#endif // MASH_SCHEDULE_H
@@ -0,0 +1,40 @@
+#ifndef ONE_WIRE_BUS_H
+#define ONE_WIRE_BUS_H
+
+#include <Arduino.h>
+
+typedef uint8_t OneWireRom[8];
+
+// Transportlag for én 1-Wire-bus. TemperatureHandler taler kun DS18B20-
+// kommandoer gennem dette interface, så den konkrete timing kan ligge i
+// hardware (RmtOneWireBus), i OneWire-biblioteket (ArduinoOneWireBus) eller
+// i en simulering på værten (SimOneWireBus).
+class OneWireBus {
+public:
+  virtual ~OneWireBus() {}
+
+  virtual bool begin() = 0;
+  // Reset-puls. Returnerer true, hvis mindst én enhed svarede med presence.
+  virtual bool reset() = 0;
+  virtual void writeBytes(const uint8_t *data, uint8_t len) = 0;
+  virtual void readBytes(uint8_t *data, uint8_t len) = 0;
+  virtual bool readBit() = 0;
+  virtual void writeBit(bool bit) = 0;
+
+  void write(uint8_t value) { writeBytes(&value, 1); }
+  void select(const OneWireRom rom);
+  void skip();
+
+  // Search ROM (Maxim AN187). Kald resetSearch() og derefter search() indtil false.
+  void resetSearch();
+  bool search(OneWireRom rom);
+
+  static uint8_t crc8(const uint8_t *data, uint8_t len);
+
+private:
+  OneWireRom searchRom = {};
+  int8_t lastDiscrepancy = -1;
+  bool lastDevice = false;
+};
+
+#endif // ONE_WIRE_BUS_H
@@ -0,0 +1,66 @@
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <Arduino.h>
+
+// PID-regulator på float i °C med udgang i procent (0–100 %).
+//   P: kp · e
+//   I: ki · e · dt lægges til integralet i hvert skridt, så det holdes som
+//      færdigt I-led i procent, og ki kan ændres undervejs uden spring i
+//      udgangen. Der integreres kun, når fejlen er inden for 2 °C af setpoint
+//      og udgangen ikke er i mætning i fejlens retning; ellers står integralet
+//      stille. Integralet begrænses til udgangsområdet.
+//   Udgangen P + I + D begrænses til udgangsområdet.
+//   D: beregnes på målingen (−kd · dT/dt), ikke på fejlen, så et nyt setpoint
+//      ikke giver et "derivative kick". Hældningen lavpasfiltreres.
+class PidController {
+public:
+  void setGains(float kp, float ki, float kd);  // %/°C, %/(°C·s), %·s/°C
+  void setOutputLimits(float minOut, float maxOut);
+  void reset();
+
+  // Ét reguleringsskridt; dtS er tiden siden forrige kald.
+  float update(float setpoint, float measurement, float dtS);
+  // Følger kun målingen (til D-leddet), mens udgangen er tvunget udefra –
+  // integralet står stille, så der ikke opbygges windup.
+  void hold(float measurement, float dtS);
+
+  float getOutput() const { return output; }
+
+private:
+  void trackMeasurement(float measurement, float dtS);
+
+  float kp = 0.0f;
+  float ki = 0.0f;
+  float kd = 0.0f;
+  float outMin = 0.0f;
+  float outMax = 100.0f;
+
+  float integral = 0.0f;
+  float lastMeasurement = 0.0f;
+  float slope = 0.0f;  // Filtreret dT/dt (°C/s)
+  float output = 0.0f;
+  bool initialized = false;
+};
+
+// Tidsproportional udgang: en duty i procent omsættes til én on-puls pr.
+// vindue, så relæet skifter højst to gange pr. vindue. Dutyen låses ved
+// vinduets start; falder den undervejs, afkortes pulsen, men den forlænges
+// aldrig. Pulser (og pauser) kortere end minPulseMs udelades helt.
+class TimeProportioningOutput {
+public:
+  void configure(unsigned long windowMs, unsigned long minPulseMs);
+  void reset();
+  bool update(float dutyPercent, unsigned long nowMs);
+
+private:
+  unsigned long pulseLength(float dutyPercent) const;
+
+  unsigned long windowMs = 20000;
+  unsigned long minPulseMs = 1000;
+  unsigned long windowStart = 0;
+  unsigned long onTimeMs = 0;
+  bool started = false;
+};
+
+#endif // PID_CONTROLLER_H
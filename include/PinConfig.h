@@ -13,5 +13,39 @@ constexpr uint8_t PIN_OLED_SDA    = 8;
 constexpr uint8_t PIN_OLED_SCL    = 9;
 constexpr uint8_t PIN_RGB_LED     = 48;
 constexpr int8_t  PIN_RGB_LED_PWR = -1;  // Sæt til -1 hvis strømstyring ikke er nødvendig
+constexpr uint8_t PIN_HLT_HEAT    = 16;  // Kun med -D ENABLE_HLT
+
+// Karrene (se Vessel.h). Hvert kar har sin egen bryggeproces; gryden er
+// det første. Sensorerne angives med det navn, TemperatureHandler giver dem:
+// "Gryde" er den første sensor på grydebussen, "Gryde 2" den anden osv.
+// limitSensorName er en grænsesensor (ventilen), som varmen aldrig må drive
+// over setpoint + ventil offset; nullptr = ingen. pumpPin -1 = ingen pumpe.
+//
+// Standard er kun gryden. HLT'en (el-varme på PIN_HLT_HEAT, sensoren som den
+// anden på grydebussen) kommer med, når der bygges med -D ENABLE_HLT i
+// build_flags; env:native gør det, så simulatoren og testene kører med begge.
+enum class HeatSource : uint8_t {
+  GAS,       // Overvåges af SafetySupervisor (uafbrudt gas)
+  ELECTRIC
+};
+
+struct VesselPins {
+  const char *name;
+  const char *sensorName;
+  const char *limitSensorName;
+  uint8_t heatPin;
+  int8_t pumpPin;
+  HeatSource source;
+  bool boils;  // Går videre til kog efter mæskeplanen; ellers holdes sidste trin
+};
+
+constexpr VesselPins VESSEL_PINS[] = {
+  {"Gryde", "Gryde", "Ventil", PIN_GAS, PIN_PUMP, HeatSource::GAS, true},
+#ifdef ENABLE_HLT
+  {"HLT", "Gryde 2", nullptr, PIN_HLT_HEAT, -1, HeatSource::ELECTRIC, false},
+#endif
+};
+constexpr uint8_t VESSEL_COUNT = sizeof(VESSEL_PINS) / sizeof(VESSEL_PINS[0]);
+constexpr uint8_t KETTLE_VESSEL = 0;  // Gryden: knappen, displayet og de faste indstillinger
 
 #endif // PIN_CONFIG_H
@@ -2,124 +2,48 @@
 #define PROCESS_HANDLER_H
 
 #include <Arduino.h>
-#include <NTPClient.h>
-#include <WiFiUdp.h>
-
+#include "PinConfig.h"
+#include "Vessel.h"
+#include "TemperatureHandler.h"
+#include "ButtonHandler.h"
+
+// Driver karrene i VESSEL_PINS. Hvert kar (Vessel.h) har sin egen
+// bryggeproces; ProcessHandler ejer dem, fører alle hændelser gennem én kø,
+// fordeler knappen og samler buzzer, LED og måleprofil for dem alle.
 class ProcessHandler {
 public:
-  enum class BrewState { IDLE, MASHING, MASHOUT, BOILHEATUP, BOILING, PAUSED };
-
-  // Initiering og opdatering
-  static void begin(uint8_t gasP, uint8_t pumpP, uint8_t buzzerP, uint8_t buttonP);
-  static void update(float tGryde, float tVentil);
-  static String getProcessStep();
-
-  // Start/stop for de enkelte trin
-  static void startMashing();
-  static void startMashout();
-  static void startBoiling();
-  static void stopProcess();
-  static void pauseProcess();
-  static void resumeProcess();
-  
-  // Funktioner til at gemme og gendanne proces state
-  static void saveProcessState();
-  static bool restoreProcessState();
-  static void resetProcessState();
-
-  // Status og tid
-  static String getProcessStatus();
-  static unsigned long getRemainingTime();
-  static String getRemainingTimeFormatted();
-  static String getStartTime();
-  static String getEndTime();
+  using Event = Vessel::Event;
+  using SamplingPolicy = Vessel::SamplingPolicy;
+
+  // Initiering og opdatering. begin() kaldes efter TemperatureHandler::begin(),
+  // så karrene kan finde deres sensorer ved navn.
+  static void begin(uint8_t buzzerP, uint8_t buttonP);
+  // Lægger hvert kars måling fra målesættet i køen som SAMPLE, poller
+  // nedtællinger og tilsætninger og behandler derefter alle ventende hændelser.
+  static void update(const TemperatureSnapshot &sample);
+  // Kan kaldes fra andre tasks/kerner og fra ISR (låsefri); false, hvis køen er fuld.
+  static bool post(const Event &event);
+  static uint32_t getDroppedEvents();
+
+  static uint8_t getVesselCount() { return VESSEL_COUNT; }
+  static Vessel &getVessel(uint8_t index);
+  // Gryden: knappen, displayet og de faste indstillinger gælder den.
+  static Vessel &kettle() { return getVessel(KETTLE_VESSEL); }
+
+  // Den hurtigste måling, et af karrene har brug for.
+  static SamplingPolicy getSamplingPolicy();
+  static bool isProcessActive();       // Mindst ét kar er i gang
+  static bool isSensorAlarmActive();   // Mindst ét kar har sensoralarm
   static String getFormattedTime();
-  static String getOLEDStatus();
-  static String getProcessSymbol();
-  static bool mashoutComplete;
-  static bool boilingComplete;
-
-  // Ekstra getters (valgfrit)
-  static BrewState getCurrentState();
-  static bool isTimerStarted();
-
-  // Toggle-funktioner
-  static bool togglePump();
-  static bool toggleGasValve();
-  static bool isPumpOn();
-  static bool isGasValveOn();
-
-  // Konfigurationsparametre
-  static void setHysteresis(float value);
-  static float getHysteresis();
-  static void setValveOffset(float value);
-  static float getValveOffset();
-  static void setMashTime(unsigned long time);       // i sekunder
-  static unsigned long getMashTime();
-  static void setMashoutTime(unsigned long time);
-  static unsigned long getMashoutTime();
-  static void setBoilTime(unsigned long time);
-  static unsigned long getBoilTime();
-  static void setMashSetpoint(float temp);
-  static float getMashSetpoint();
-  static void setMashoutSetpoint(float temp);
-  static float getMashoutSetpoint();
 
 private:
-  // Hardwarestyring
-  static void gasControl(bool state);
-  static void pumpControl(bool state);
-  static void handleBuzzer();
-  // Ændret signatur for at inkludere ventiltemperatur
-  static void temperatureControl(float currentTemp, float setpoint, float tVentil);
-
-  // Tidsstyring
-  static void checkTimeAndNextStep(unsigned long stepTimeSec);
-  static void nextStep();
-  static String formatEpochTime(unsigned long epoch);
-
-  // NTP
-  static WiFiUDP ntpUDP;
-  static NTPClient timeClient;
-
-  // Hardware pins
-  static uint8_t pinGas;
-  static uint8_t pinPump;
-  static uint8_t pinBuzzer;
-  static uint8_t pinButton;
-
-  // Status for pumpe og gasventil
-  static bool pumpOn;
-  static bool gasValveOn;
-
-  // Tidsvariabler
-  static unsigned long processStartEpoch;
-  static unsigned long processStartMillis;
-  static bool timerStarted;
-  static unsigned long pauseOffset;       // Tid der var forløbet, da pausen aktiveres
-  
-  // Procestrinvarigheder (i sekunder)
-  static unsigned long mashTime;
-  static unsigned long mashoutTime;
-  static unsigned long boilTime;
-
-  // Temperatur-setpoints og hysterese
-  static float mashSetpoint;
-  static float mashoutSetpoint;
-  static float hysteresis;
-  // Tilføjet: ventil offset (max ventiltemperatur = setpoint + valveOffset)
-  static float valveOffset;
-
-  // Buzzer
-  static bool userConfirmed;
-  static bool buzzerActive;
-  static unsigned long buzzerStartTime;
+  static bool postGesture(ButtonHandler::Gesture gesture, uint64_t timestampMs);
+  static void dispatch(const Event &event);
+  static void updateSignals();
+  static void updateSamplingPolicy();
 
-  // Bryg-tilstand og visningstider
-  static BrewState currentState;
-  static BrewState previousState;         // Gemmer den aktive tilstand før pause
-  static String startTimeStr;
-  static String endTimeStr;
+  static Vessel vessels[VESSEL_COUNT];
+  static SamplingPolicy samplingPolicy;
 };
 
 #endif // PROCESS_HANDLER_H
@@ -0,0 +1,54 @@
+#ifndef PROCESS_JOURNAL_H
+#define PROCESS_JOURNAL_H
+
+#include <Arduino.h>
+
+// Det, der skal til for at fortsætte en proces efter et strømsvigt.
+struct JournalEntry {
+  uint8_t state;          // BrewState
+  uint8_t previousState;  // Til PAUSED og genoptagelse
+  uint8_t stepIndex;      // Trin i mæskeplanen
+  uint8_t additionsDone;  // Bekræftede kogetilsætninger
+  bool timerStarted;
+  bool boilingComplete;
+  uint32_t elapsedMs;     // Forløbet af nedtællingen (under PAUSED: ved pausen)
+  uint32_t epoch;         // UTC ved checkpointet, 0 = ukendt
+};
+
+// Fremdriftsjournal i EEPROM: en ring af SLOTS poster med løbenummer og CRC.
+// Hver post skrives i næste plads, så en post, der blev afbrudt midt i
+// skrivningen, kun koster det seneste checkpoint – den forrige post er intakt.
+// Ved opstart bruges den gyldige post med højeste løbenummer. Pladserne slides
+// ligeligt, og antallet af skrivninger styres af den, der kalder append().
+// Hvert kar (Vessel.h) har sin egen journal: gryden fra STORAGE_START, de
+// øvrige kar efter hinanden fra EXTRA_STORAGE_START.
+class ProcessJournal {
+public:
+  static constexpr uint8_t SLOTS = 16;
+  static constexpr size_t SLOT_SIZE = 20;
+  static constexpr int STORAGE_SIZE = SLOTS * SLOT_SIZE;
+  static constexpr int STORAGE_START = 640;
+  static constexpr int STORAGE_END = STORAGE_START + STORAGE_SIZE;
+  static constexpr int EXTRA_STORAGE_START = 1280;
+
+  static constexpr int storageStart(uint8_t vessel) {
+    return vessel == 0 ? STORAGE_START : EXTRA_STORAGE_START + (vessel - 1) * STORAGE_SIZE;
+  }
+
+  // Finder den seneste post fra start; kaldes efter Hal::storageBegin().
+  void begin(int start);
+  bool latest(JournalEntry &entry) const;
+  void append(const JournalEntry &entry);
+  uint32_t getWrites() const { return writes; }
+
+private:
+  int slotAddress(uint32_t sequence) const;
+
+  int start = STORAGE_START;
+  bool hasEntry = false;
+  JournalEntry last = {};
+  uint32_t sequence = 0;  // Løbenummer på den seneste post
+  uint32_t writes = 0;    // Poster skrevet siden opstart
+};
+
+#endif // PROCESS_JOURNAL_H
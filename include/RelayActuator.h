@@ -0,0 +1,91 @@
+#ifndef RELAY_ACTUATOR_H
+#define RELAY_ACTUATOR_H
+
+#include <Arduino.h>
+
+// Et relæ bag en skifteplan. Styringen beder om en tilstand med request();
+// udgangen skifter først, når relæet har været tændt minOnMs eller slukket
+// minOffMs, og når skifteraten tillader det. Gentagne ønsker om samme
+// tilstand giver ingen skrivninger. forceOff() slukker straks uden om
+// minimumstiden – til sikkerhed (ventilgrænse, sensorfejl, stop).
+//
+// Skifteraten er en token bucket: hver tænding koster ét token, der fyldes
+// op med maxCyclesPerHour pr. time, og der kan højst spares et kvarters
+// tokens op. Relæet tæller tændinger og tid tændt, både siden opstart og
+// over hele levetiden (gemt i EEPROM i portioner, se ProcessHandler).
+//
+// En spærre (setInterlock) holder relæet slukket, så længe den er sand, fx
+// mens SafetySupervisor har en låst alarm. Et ønske om at tænde står ved og
+// udføres, når spærren slippes.
+class RelayActuator {
+public:
+  struct Limits {
+    unsigned long minOnMs;
+    unsigned long minOffMs;
+    uint16_t maxCyclesPerHour;  // 0 = ingen grænse
+  };
+
+  // Levetidstællerne, som de gemmes.
+  struct Counters {
+    uint32_t cycles;     // Antal tændinger
+    uint32_t onSeconds;  // Samlet tid tændt
+  };
+
+  struct Stats {
+    Counters lifetime;
+    uint32_t sessionCycles;   // Siden opstart
+    float sessionDuty;        // Andel af tiden siden opstart, relæet var tændt (%)
+    float averageOnSeconds;   // Gennemsnitlig tændtid pr. tænding (levetid)
+    uint32_t deferred;        // Skift, der måtte vente på grænserne
+  };
+
+  void begin(uint8_t pin, const Limits &limits, const Counters &stored, uint64_t nowMs);
+  void request(bool on, uint64_t nowMs);
+  void forceOff(uint64_t nowMs);
+  void setInterlock(bool (*blocked)()) { interlock = blocked; }
+  // Udfører et ventende ønske, når grænserne tillader det.
+  void update(uint64_t nowMs);
+
+  bool isOn() const { return on; }
+  bool isRequested() const { return desired; }
+  bool isPending() const { return desired != on; }
+
+  // Tællerne inkl. den igangværende tænding.
+  Counters getCounters(uint64_t nowMs) const;
+  Stats getStats(uint64_t nowMs) const;
+  // Ændring siden markSaved(): styrer, hvornår tællerne gemmes.
+  uint32_t getUnsavedCycles() const { return cycles - savedCycles; }
+  uint64_t getUnsavedOnMs(uint64_t nowMs) const;
+  void markSaved(uint64_t nowMs);
+
+private:
+  bool allowed(bool target, uint64_t nowMs);
+  bool isBlocked() const { return interlock && interlock(); }
+  void write(bool target, uint64_t nowMs);
+  void refill(uint64_t nowMs);
+  uint64_t currentOnMs(uint64_t nowMs) const;
+
+  uint8_t pin = 0;
+  Limits limits = {0, 0, 0};
+  bool (*interlock)() = nullptr;
+  bool on = false;
+  bool desired = false;
+  bool waiting = false;      // Det aktuelle ønske er talt med i deferred
+  bool switched = false;     // Grænserne gælder først efter første skift
+  uint64_t changedAt = 0;    // Seneste skift af udgangen
+  uint64_t sessionStart = 0;
+
+  float tokens = 0.0f;
+  uint64_t refilledAt = 0;
+
+  // Levetid: tændinger og tid tændt til og med seneste slukning
+  uint32_t cycles = 0;
+  uint64_t onMs = 0;
+  uint32_t sessionStartCycles = 0;
+  uint64_t sessionStartOnMs = 0;
+  uint32_t savedCycles = 0;
+  uint64_t savedOnMs = 0;
+  uint32_t deferred = 0;
+};
+
+#endif // RELAY_ACTUATOR_H
@@ -0,0 +1,92 @@
+#ifndef RELAY_AUTO_TUNER_H
+#define RELAY_AUTO_TUNER_H
+
+#include <Arduino.h>
+#include "Temperature.h"
+
+// Relæ-autotuning efter Åström–Hägglund. Gassen slås helt til under
+// setpoint − NOISE_BAND og helt fra over setpoint + NOISE_BAND, så gryden
+// svinger om setpoint. Ud fra svingningens amplitude a og periode Tu fås den
+// kritiske forstærkning
+//   Ku = 4·d / (π·√(a² − ε²))      (d = relæets halve udsving i %, ε = båndet)
+// og PID-gains efter Tyreus–Luyben, der er mere forsigtig end Ziegler–Nichols
+// og passer bedre til en gryde, hvor varmen kommer med lang forsinkelse:
+//   Kp = 0,45·Ku,  Ti = 2,2·Tu,  Td = Tu/6,3.
+// Fast hukommelsesforbrug – sporet ligger i en ringbuffer.
+class RelayAutoTuner {
+public:
+  enum class Status : uint8_t { IDLE, RUNNING, DONE, FAILED };
+
+  struct Result {
+    float ku;        // %/°C
+    float tuS;       // Svingningsperiode i sekunder
+    float amplitude; // °C (halv peak-til-peak)
+    float kp;        // %/°C
+    float ki;        // %/(°C·s)
+    float kd;        // %·s/°C
+  };
+
+  // Ét punkt i sporet. seq tæller fortløbende, så en klient kan hente
+  // "alt efter seq N", selvom ringbufferen er løbet rundt.
+  struct TracePoint {
+    uint32_t seq;
+    uint32_t timeS;  // Sekunder siden start
+    TempRaw temp;
+    bool gasOn;
+  };
+
+  static constexpr uint8_t TRACE_SIZE = 240;  // 20 min ved 5 s pr. punkt
+
+  void start(float setpointC, unsigned long nowMs);
+  void abort();
+  // Returnerer relæets ønskede gas-tilstand. Ventilgrænsen håndhæves af kalderen.
+  bool update(float temperatureC, unsigned long nowMs);
+
+  Status getStatus() const { return status; }
+  const Result &getResult() const { return result; }
+  float getSetpoint() const { return setpoint; }
+  uint8_t getCycles() const { return cycleCount; }
+  const char *getFailReason() const { return failReason; }
+
+  // Kopierer punkter med seq > since til out; returnerer antallet.
+  size_t getTrace(uint32_t since, TracePoint *out, size_t maxPoints) const;
+  uint32_t getTraceSeq() const { return traceSeq; }
+
+private:
+  static constexpr uint8_t HISTORY = 3;
+
+  void addTrace(float temperatureC, unsigned long nowMs);
+  void finishCycle(unsigned long nowMs);
+  void fail(const char *reason);
+  bool converged() const;
+  void computeResult();
+
+  Status status = Status::IDLE;
+  Result result = {};
+  const char *failReason = "";
+  float setpoint = 0.0f;
+  bool relayOn = false;
+  bool primed = false;  // Relæets starttilstand sættes ved første måling
+  unsigned long startMs = 0;
+
+  // Ekstremer i den igangværende halvperiode og tiden for sidste skift til "on".
+  float phaseMax = 0.0f;
+  float phaseMin = 0.0f;
+  float lastMin = 0.0f;
+  unsigned long lastOnMs = 0;
+  bool haveOnEdge = false;
+  bool haveMin = false;
+
+  // De seneste hele svingninger (ældste først efter rotation)
+  float periods[HISTORY] = {};
+  float amplitudes[HISTORY] = {};
+  uint8_t cycleCount = 0;
+
+  TracePoint trace[TRACE_SIZE] = {};
+  uint8_t traceHead = 0;
+  uint8_t traceCount = 0;
+  uint32_t traceSeq = 0;
+  unsigned long lastTraceMs = 0;
+};
+
+#endif // RELAY_AUTO_TUNER_H
@@ -0,0 +1,36 @@
+#ifndef RMT_ONE_WIRE_BUS_H
+#define RMT_ONE_WIRE_BUS_H
+
+#include <Arduino.h>
+#include "OneWireBus.h"
+
+// 1-Wire via ESP32-S3's RMT-periferi. TX-kanalen genererer reset- og bit-
+// vinduerne i hardware, og RX-kanalen på samme (open drain) pin optager
+// linjen. Kalderen venter på en FreeRTOS-semafor/ringbuffer fra RMT-driveren
+// i stedet for at bit-bange med interrupts slået fra, så WiFi og LEDC ikke
+// forstyrres.
+class RmtOneWireBus : public OneWireBus {
+public:
+  RmtOneWireBus(uint8_t pin, uint8_t txChannel, uint8_t rxChannel);
+
+  bool begin() override;
+  bool reset() override;
+  void writeBytes(const uint8_t *data, uint8_t len) override;
+  void readBytes(uint8_t *data, uint8_t len) override;
+  bool readBit() override;
+  void writeBit(bool bit) override;
+
+private:
+  // Sender count tidsvinduer og returnerer længden (µs) af hver lav-puls,
+  // som RX-kanalen så på linjen. Returnerer antallet af fundne pulser.
+  int readSlots(const void *items, uint8_t count, uint16_t *lowDurations, uint8_t maxPulses);
+  bool writeSlots(const void *items, uint8_t count);
+
+  uint8_t pin;
+  uint8_t txChannel;
+  uint8_t rxChannel;
+  void *rxBuffer = nullptr;
+  bool ready = false;
+};
+
+#endif // RMT_ONE_WIRE_BUS_H
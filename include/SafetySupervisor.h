@@ -0,0 +1,78 @@
+#ifndef SAFETY_SUPERVISOR_H
+#define SAFETY_SUPERVISOR_H
+
+#include <Arduino.h>
+
+// Uafhængig sikkerhedsvagt for gassen. Den kører i sin egen FreeRTOS-task med
+// højere prioritet end loop() og måletasken og fodrer selv task-watchdoggen,
+// så den kan gribe ind, mens loop() hænger i et blokerende kald (WiFi-forbindelse,
+// OTA-upload, en 1-Wire-læsning, der sidder fast). Kun vagtens egen task
+// meldes til watchdoggen; dens opsætning deles med resten af systemet og
+// ændres ikke. Hænger vagten selv, genstarter watchdoggen enheden, hvis den er
+// sat op til det, og ellers gør heartbeat() det – relæudgangene falder fra.
+//
+// Hver CHECK_MS kontrolleres:
+//   LOOP_STALLED     – loop() har ikke kaldt heartbeat() i HEARTBEAT_TIMEOUT_MS,
+//                      mens gas, pumpe eller et kars varme er tændt. Er intet
+//                      tændt, holdes udgangene blot nede uden at låse alarmen.
+//   SENSORS_STALE    – varmen er tændt, men seneste målesæt er ældre end
+//                      STALE_FACTOR × TemperatureHandler::getStaleThreshold()
+//   KETTLE_OVERTEMP  – grydens sensor over MAX_KETTLE_C
+//   VALVE_OVERTEMP   – et kars grænsesensor (ventilen) over MAX_VALVE_C
+//   VESSEL_OVERTEMP  – et andet kars sensor (fx HLT'ens) over MAX_KETTLE_C
+//   GAS_ON_TOO_LONG  – gassen har været tændt uafbrudt længere end grænsen for
+//                      den aktuelle fase (startGasPhase())
+//   WATCHDOG_RESET   – enheden er genstartet af en watchdog (sættes i begin())
+//
+// Temperaturgrænserne gælder hvert kar i VESSEL_PINS med de sensorer, karret
+// selv styrer efter (watchVessel()).
+//
+// Ved fejl lægges gas, pumpe og karrenes varme ned direkte på GPIO'erne,
+// uanset hvad ProcessHandler mener, og alarmen låses med FAULT-mønstret på
+// buzzeren. Relæerne (RelayActuator::setInterlock) kan ikke tænde igen, før
+// alarmen er nulstillet med reset(). I env:native, hvor der ikke er nogen
+// scheduler, kører kontrollen som periodisk callback (Hal::startPeriodic).
+class SafetySupervisor {
+public:
+  enum class Trip : uint8_t {
+    NONE,
+    LOOP_STALLED,
+    SENSORS_STALE,
+    KETTLE_OVERTEMP,
+    VALVE_OVERTEMP,
+    GAS_ON_TOO_LONG,
+    WATCHDOG_RESET,
+    VESSEL_OVERTEMP
+  };
+
+  static constexpr unsigned long CHECK_MS = 250;
+  static constexpr unsigned long HEARTBEAT_TIMEOUT_MS = 5000;
+  static constexpr uint8_t STALE_FACTOR = 2;
+  static constexpr float MAX_KETTLE_C = 105.0f;
+  static constexpr float MAX_VALVE_C = 125.0f;
+  static constexpr uint32_t WATCHDOG_TIMEOUT_S = 5;
+  static constexpr unsigned long DEFAULT_MAX_GAS_ON_S = 2UL * 60 * 60;
+
+  // Kaldes tidligt i setup(), før noget kan tænde gassen. Hjerteslaget
+  // overvåges først fra det første heartbeat(), så setup() må tage sin tid.
+  static void begin(uint8_t gasPin, uint8_t pumpPin);
+  // Kaldes fra hvert gennemløb af loop().
+  static void heartbeat();
+  // En ny fase (fx kogningen) begynder: gassen må fra nu brænde uafbrudt i
+  // højst maxSeconds, uanset hvor længe den har brændt i fasen før.
+  static void startGasPhase(unsigned long maxSeconds);
+  static unsigned long getMaxGasOnTime();
+  // Kaldes af Vessel::begin(), når karrets sensorer er fundet (indeks i
+  // TemperatureSnapshot::estimates; -1 = ingen). Kar uden sensor overvåges ikke –
+  // deres varme holdes alligevel slukket.
+  static void watchVessel(uint8_t vessel, int8_t sensorIndex, int8_t limitIndex);
+
+  static bool isTripped();  // Låsefri; bruges som relæernes spærre
+  static Trip getTrip();
+  static unsigned long getTrippedAt();  // Hal::millis() ved udløsningen
+  // Nulstiller alarmen, hvis årsagen er væk; ellers false.
+  static bool reset();
+  static const char *tripName(Trip trip);
+};
+
+#endif // SAFETY_SUPERVISOR_H
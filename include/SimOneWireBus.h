@@ -0,0 +1,59 @@
+#ifndef SIM_ONE_WIRE_BUS_H
+#define SIM_ONE_WIRE_BUS_H
+
+#include <Arduino.h>
+#include "OneWireBus.h"
+#include "Temperature.h"
+
+// Simuleret 1-Wire-bus med et antal DS18B20'ere. Den fortolker ROM- og
+// funktionskommandoer (Search/Match/Skip ROM, Convert T, Read/Write Scratchpad)
+// på byte-niveau, så TemperatureHandler kan køres uden hardware. Fejl kan
+// sprøjtes ind pr. sensor for at teste sundhedslogikken.
+class SimOneWireBus : public OneWireBus {
+public:
+  static constexpr uint8_t MAX_DEVICES = 8;
+
+  // Returnerer sensorens indeks eller -1, hvis bussen er fuld.
+  int8_t addDevice(const OneWireRom rom, float celsius);
+  void setTemperature(uint8_t index, float celsius);
+  void setPresent(uint8_t index, bool present);
+  void injectCrcError(uint8_t index);       // Næste scratchpad-læsning får forkert CRC
+  void injectPowerOnReset(uint8_t index);   // Sensoren mister strøm: 85 °C og 12 bit
+  uint8_t getResolution(uint8_t index) const;
+  uint32_t getTransactionCount() const { return transactions; }
+
+  bool begin() override;
+  bool reset() override;
+  void writeBytes(const uint8_t *data, uint8_t len) override;
+  void readBytes(uint8_t *data, uint8_t len) override;
+  bool readBit() override;
+  void writeBit(bool bit) override;
+
+private:
+  enum class State { Idle, RomCommand, MatchRom, Search, Function, ReadScratchpad, WriteScratchpad };
+
+  struct Device {
+    OneWireRom rom;
+    TempRaw temperature;
+    uint8_t scratchpad[9];
+    bool present;
+    bool selected;
+    bool corruptNextRead;
+  };
+
+  void handleByte(uint8_t value);
+  void convert(Device &device);
+  void updateCrc(Device &device);
+  Device *singleSelected();
+
+  Device devices[MAX_DEVICES] = {};
+  uint8_t deviceCount = 0;
+  State state = State::Idle;
+  uint8_t position = 0;
+  OneWireRom matchRom = {};
+  uint8_t searchBit = 0;
+  bool searchReadComplement = false;
+  uint32_t transactions = 0;
+};
+
+#endif // SIM_ONE_WIRE_BUS_H
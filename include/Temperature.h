@@ -0,0 +1,74 @@
+#ifndef TEMPERATURE_H
+#define TEMPERATURE_H
+
+#include <Arduino.h>
+
+// Temperaturer holdes internt som DS18B20's rå format: int16 i 1/16 °C.
+// Der konverteres kun til float/tekst ved præsentation (web, OLED, log).
+typedef int16_t TempRaw;
+
+constexpr TempRaw TEMP_RAW_INVALID = INT16_MIN;
+constexpr int16_t TEMP_RAW_PER_DEGREE = 16;
+
+constexpr TempRaw tempRawFromC(float celsius) {
+  return static_cast<TempRaw>(celsius >= 0.0f ? celsius * TEMP_RAW_PER_DEGREE + 0.5f
+                                              : celsius * TEMP_RAW_PER_DEGREE - 0.5f);
+}
+
+inline float tempRawToC(TempRaw raw) {
+  return raw == TEMP_RAW_INVALID ? NAN : static_cast<float>(raw) / TEMP_RAW_PER_DEGREE;
+}
+
+// Omsætter en CRC-kontrolleret DS18B20-scratchpad til 1/16 °C. Ved lavere
+// opløsning er de nederste bits udefinerede og maskeres væk (byte 4 =
+// konfigurationsregister).
+inline TempRaw tempRawFromScratchpad(const uint8_t *sp) {
+  int16_t raw = static_cast<int16_t>((static_cast<uint16_t>(sp[1]) << 8) | sp[0]);
+  uint8_t unusedBits = 3 - ((sp[4] >> 5) & 0x03);
+  return static_cast<TempRaw>(raw & ~((1 << unusedBits) - 1));
+}
+
+inline bool isTempRawValid(TempRaw raw) {
+  return raw != TEMP_RAW_INVALID;
+}
+
+// Formaterer med én decimal ("64.5", "-0.3") uden float og uden heap-allokering.
+inline void formatTempRaw(TempRaw raw, char *buf, size_t len) {
+  if (raw == TEMP_RAW_INVALID) {
+    snprintf(buf, len, "--.-");
+    return;
+  }
+  int32_t tenths = (static_cast<int32_t>(raw) * 10 + (raw >= 0 ? 8 : -8)) / TEMP_RAW_PER_DEGREE;
+  int32_t absTenths = tenths < 0 ? -tenths : tenths;
+  snprintf(buf, len, "%s%ld.%ld", tenths < 0 ? "-" : "", static_cast<long>(absTenths / 10),
+           static_cast<long>(absTenths % 10));
+}
+
+// Sundhedstilstand for en sensor – styrer ProcessHandlers degraderede drift.
+//   OK      – friske, plausible målinger
+//   SUSPECT – CRC-fejl, 85 °C reset-værdi eller urealistisk spring (men stadig frisk)
+//   STALE   – ingen gyldig måling inden for tærsklen
+//   FAILED  – gentagne fejl; læses kun med eksponentiel backoff
+enum class SensorHealth : uint8_t { OK, SUSPECT, STALE, FAILED };
+
+inline bool isSensorUsable(SensorHealth health) {
+  return health == SensorHealth::OK || health == SensorHealth::SUSPECT;
+}
+
+inline const char* sensorHealthName(SensorHealth health) {
+  switch (health) {
+    case SensorHealth::OK:      return "OK";
+    case SensorHealth::SUSPECT: return "SUSPECT";
+    case SensorHealth::STALE:   return "STALE";
+    case SensorHealth::FAILED:  return "FAILED";
+  }
+  return "?";
+}
+
+inline String tempRawToString(TempRaw raw) {
+  char buf[12];
+  formatTempRaw(raw, buf, sizeof(buf));
+  return String(buf);
+}
+
+#endif // TEMPERATURE_H
@@ -0,0 +1,47 @@
+#ifndef TEMPERATURE_FILTER_H
+#define TEMPERATURE_FILTER_H
+
+#include <Arduino.h>
+#include "Temperature.h"
+
+// Filtreret tilstand for én sensor.
+struct SensorEstimate {
+  TempRaw temp;     // Filtreret temperatur (1/16 °C)
+  float rate;       // dT/dt i °C/min
+  float variance;   // Estimeret varians på temperaturen (°C²)
+  bool valid;
+};
+
+// Signalbehandling pr. sensor: et rullende median-vindue fjerner enkeltstående
+// spikes (fx 85 °C power-on-værdien), hvorefter et Kalman-filter med tilstanden
+// (temperatur, hældning) glatter målingen og estimerer dT/dt.
+// Fast hukommelsesforbrug – ingen heap.
+class TemperatureFilter {
+public:
+  void reset();
+  // Returnerer false, hvis målingen blev afvist som spike og erstattet af medianen.
+  bool update(TempRaw raw, unsigned long timestampMs);
+  SensorEstimate getEstimate() const;
+
+private:
+  static constexpr uint8_t MEDIAN_WINDOW = 5;
+
+  TempRaw median() const;
+  void predict(float dt);
+  void correct(float measurement);
+
+  TempRaw window[MEDIAN_WINDOW] = {};
+  uint8_t windowCount = 0;
+  uint8_t windowHead = 0;
+
+  // Kalman-tilstand: temperatur (°C), hældning (°C/s) og kovariansmatrix P.
+  float x = 0.0f;
+  float v = 0.0f;
+  float p00 = 0.0f;
+  float p01 = 0.0f;
+  float p11 = 0.0f;
+  unsigned long lastTimestamp = 0;
+  bool initialized = false;
+};
+
+#endif // TEMPERATURE_FILTER_H
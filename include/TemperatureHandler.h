@@ -2,16 +2,86 @@
 #define TEMPERATURE_HANDLER_H
 
 #include <Arduino.h>
-#include <DallasTemperature.h>
+#include "OneWireBus.h"
+#include "Temperature.h"
+#include "TemperatureFilter.h"
+
+// Maks. antal DS18B20-sensorer i alt på tværs af begge busser
+constexpr uint8_t MAX_TEMP_SENSORS = 8;
+constexpr uint8_t SENSOR_NAME_LENGTH = 16;
+
+// Et sammenhængende målesæt fra begge busser (samme konverteringstidspunkt).
+struct TemperatureSnapshot {
+  uint32_t sequence;        // Øges for hvert nyt målesæt (0 = ingen måling endnu)
+  unsigned long timestamp;  // millis() ved konverteringsstart
+  TempRaw grydeTemp;        // Første sensor på grydebussen (1/16 °C)
+  TempRaw ventilTemp;       // Første sensor på ventilbussen (1/16 °C)
+  bool grydeValid;
+  bool ventilValid;
+  SensorHealth grydeHealth;
+  SensorHealth ventilHealth;
+  uint8_t sensorCount;      // Alle fundne sensorer, i samme rækkefølge som getSensorName()
+  TempRaw temps[MAX_TEMP_SENSORS];
+  bool valid[MAX_TEMP_SENSORS];
+  SensorHealth health[MAX_TEMP_SENSORS];
+  // Filtreret temperatur, dT/dt og varians – det er disse, styringen bruger.
+  SensorEstimate grydeEstimate;
+  SensorEstimate ventilEstimate;
+  SensorEstimate estimates[MAX_TEMP_SENSORS];
+};
+
+// Periodestatistik for måletasken (alle tider i ms).
+struct AcquisitionStats {
+  uint32_t samples;
+  unsigned long period;
+  unsigned long lastJitter;
+  unsigned long maxJitter;
+  float avgJitter;
+};
 
 class TemperatureHandler {
 public:
-  static void begin(uint8_t grydePin, uint8_t ventilPin);
-  static void readTemperatures();
-  static float getGrydeTemp();
-  static float getVentilTemp();
+  static void begin(uint8_t grydePin, uint8_t ventilPin, unsigned long sampleIntervalMs = 1000);
+  // Med færdige busser – bruges med SimOneWireBus til test uden hardware.
+  static void begin(OneWireBus* grydeBus, OneWireBus* ventilBus, unsigned long sampleIntervalMs = 1000);
+  // Flytter målingen over i en selvstændig FreeRTOS-task, låst til den angivne kerne.
+  static bool startTask(uint8_t core = 0, uint8_t priority = 2);
+  // Ikke-blokerende: starter konvertering på begge busser og henter resultaterne,
+  // når konverteringstiden er gået. Returnerer true, når et nyt målesæt er klar.
+  // Bruges kun, når måletasken ikke kører.
+  static bool update();
+  static void setSampleInterval(unsigned long intervalMs);
+  // Ny opløsning (9-12 bit) programmeres først ved næste konverteringsstart.
+  static void setResolution(uint8_t bits);
+  static uint8_t getResolution();
+  static bool isConversionPending();
+
+  // Låsefri læsning af seneste målesæt (seqlock) – sikker fra alle tasks/kerner.
+  static TemperatureSnapshot getSnapshot();
+  static AcquisitionStats getStats();
+
+  // Sensorer findes én gang i begin(); derefter læses de direkte på ROM-adresse.
+  static uint8_t getSensorCount();
+  static const char* getSensorName(uint8_t index);
+  static void setSensorName(uint8_t index, const char* name);
+  static bool getSensorAddress(uint8_t index, OneWireRom address);
+  static int8_t findSensor(const char* name);
+
+  static unsigned long getLastSampleTime();
+  static TempRaw getGrydeTemp();
+  static TempRaw getVentilTemp();
   static bool isGrydeValid();
   static bool isVentilValid();
+  static SensorEstimate getGrydeEstimate();
+  static SensorEstimate getVentilEstimate();
+  static SensorEstimate getEstimate(uint8_t index);
+
+  // Sundhed set fra læserens side: et snapshot, der er ældre end tærsklen,
+  // regnes som STALE, selv hvis måletasken selv er gået i stå.
+  static SensorHealth checkStaleness(SensorHealth published, unsigned long timestamp);
+  static unsigned long getStaleThreshold();
+  static SensorHealth getGrydeHealth();
+  static SensorHealth getVentilHealth();
 };
 
 #endif // TEMPERATURE_HANDLER_H
@@ -0,0 +1,81 @@
+#ifndef THERMAL_MODEL_H
+#define THERMAL_MODEL_H
+
+#include <Arduino.h>
+
+// Online first-order-plus-dead-time-model af gryden, fittet med rekursive
+// mindste kvadrater (RLS) ud fra gasrelæet og grydetemperaturen.
+//
+// Med samplingtid Ts og u = andel af Ts, gassen var tændt, er den diskrete model
+//   T[k+1] − T[k] = θ1·u[k−d] + θ2·(T[k] − T_REF) + θ3
+// hvor θ1 er opvarmningen pr. sample ved fuld gas, θ2 = −Ts/τ (varmetab) og θ3
+// samler omgivelsestemperaturen. Dødtiden d kendes ikke på forhånd, så der køres
+// én RLS pr. kandidat (0 … MAX_DELAY samples), og den med mindst
+// prædiktionsfejl bruges.
+//
+// Modellen bruges til to ting:
+//   - ETA: hvor længe der går, før setpoint nås ved fuld gas
+//   - forudsigende gasstop: hvor højt temperaturen når, hvis gassen lukkes nu
+//     (varmen, der allerede er på vej gennem dødtiden, kommer stadig)
+// Fast hukommelsesforbrug – ingen heap.
+class ThermalModel {
+public:
+  static constexpr unsigned long SAMPLE_MS = 10000;
+  static constexpr uint8_t MAX_DELAY = 12;  // 120 s
+
+  void reset();
+  // Kaldes løbende med grydetemperaturen og gasrelæets tilstand. Med
+  // adapt = false følges temperatur og gas kun (til prædiktionerne), mens
+  // parametrene står stille – fx under et hvil, hvor korte gaspulser næsten
+  // ingen information giver, og estimatet ellers driver.
+  void update(float temperatureC, bool gasOn, unsigned long nowMs, bool adapt = true);
+  // Stop indsamlingen (fx uden for mæskning); de lærte parametre bevares.
+  void pause();
+
+  // Modellen kan bruges til ETA (nok samples og fysisk meningsfulde parametre).
+  bool isValid() const;
+  // Modellen har set både gas til og fra og kan derfor skelne gassens bidrag.
+  bool canPredictCutoff() const;
+
+  // Sekunder til targetC nås ved fuld gas; false, hvis ukendt eller uden for horisonten.
+  bool estimateSecondsTo(float targetC, unsigned long &seconds) const;
+  // Højeste temperatur, hvis gassen lukkes nu.
+  bool predictPeakIfOff(float &peakC) const;
+
+  float getTauS() const;         // Tidskonstant for varmetabet
+  float getDeadTimeS() const;
+  float getHeatRate() const;     // °C/min ved fuld gas (ved den aktuelle temperatur)
+  float getTemperature() const { return lastTemp; }
+
+private:
+  struct Estimator {
+    float theta[3];
+    float p[3][3];
+    float errorVar;  // Eksponentielt vægtet kvadreret a priori-fejl
+    uint16_t samples;
+  };
+
+  void initEstimator(Estimator &est);
+  void updateEstimator(Estimator &est, const float phi[3], float y);
+  void completeSample(float temperatureC, bool adapt);
+  const Estimator *best() const;
+  float inputAt(int8_t index, float futureInput) const;
+  float step(const Estimator &est, float temp, float input) const;
+
+  Estimator estimators[MAX_DELAY + 1];
+  float inputs[MAX_DELAY + 1];  // inputs[0] = seneste hele sample
+  uint8_t inputCount = 0;
+
+  float lastTemp = 0.0f;
+  bool haveTemp = false;
+  unsigned long sampleStart = 0;
+  unsigned long lastUpdateMs = 0;
+  unsigned long gasOnMs = 0;
+  bool lastGas = false;
+  bool sampling = false;
+
+  uint16_t gasOnSamples = 0;
+  uint16_t gasOffSamples = 0;
+};
+
+#endif // THERMAL_MODEL_H
@@ -0,0 +1,392 @@
+#ifndef VESSEL_H
+#define VESSEL_H
+
+#include <Arduino.h>
+#include "PinConfig.h"
+#include "Temperature.h"
+#include "TemperatureHandler.h"
+#include "RelayAutoTuner.h"
+#include "ThermalModel.h"
+#include "MashSchedule.h"
+#include "BoilAdditions.h"
+#include "RelayActuator.h"
+#include "BoilDetector.h"
+#include "PidController.h"
+#include "ProcessJournal.h"
+
+// Et kar med sin egen bryggeproces: gryden, HLT'en eller et hvilket som helst
+// andet kar i VESSEL_PINS. Hvert kar har sin egen tilstandsmaskine, sin egen
+// mæskeplan og PID, sit eget varmerelæ (gas eller el) og evt. pumpe, sine
+// egne sensorer (fundet ved navn i TemperatureHandler) og sin egen plads i
+// fremdriftsjournalen. ProcessHandler ejer karrene, fører deres hændelser
+// gennem én kø og kalder dem fra loop().
+//
+// Alle kar opfører sig ens. Forskellene står i VESSEL_PINS: et kar, der ikke
+// koger (boils = false), holder planens sidste trin, til det stoppes, i
+// stedet for at gå videre til kog; uden grænsesensor (ventilen) er der ingen
+// ventilgrænse.
+class Vessel {
+public:
+  // Nye tilstande tilføjes sidst, da værdien gemmes i EEPROM (ProcessState).
+  // MASHING afvikler mæskeplanens trin; 2 var MASHOUT, der nu er planens
+  // sidste trin, og værdien genbruges derfor ikke.
+  enum class BrewState { IDLE = 0, MASHING = 1, BOILHEATUP = 3, BOILING = 4, PAUSED = 5, AUTOTUNE = 6 };
+
+  // Kort status til web og display, afledt af tilstanden.
+  enum class Status : uint8_t {
+    OFF,           // IDLE eller PAUSED
+    HEATING,       // På vej op til trinnets temperatur (eller kog)
+    HOLDING,       // Nedtællingen kører; temperaturen holdes
+    SENSOR_FAULT   // Ingen brugbar måling – varmen er slukket
+  };
+
+  // Hvor hurtigt og hvor fint temperaturen skal måles i den aktuelle fase.
+  struct SamplingPolicy {
+    uint8_t resolutionBits;
+    unsigned long intervalMs;
+  };
+
+  // Alt, der kan ændre et kars tilstand, kommer som en hændelse gennem
+  // ProcessHandlers kø og behandles af karrets transitionstabel (se Vessel.cpp).
+  struct Event {
+    enum class Type : uint8_t {
+      SAMPLE,      // Temperaturmåling: driver reguleringen i den aktuelle tilstand
+      BUTTON,        // Kort tryk (bekræftelse)
+      LONG_PRESS,    // Knappen holdt inde: start mæskning fra IDLE
+      DOUBLE_PRESS,  // Dobbelttryk: pause/genoptag
+      COMMAND,     // Webkommando
+      TIMER,       // Nedtællingen er udløbet
+      FAULT,       // Sensoralarm opstået (value 1) eller ophørt (value 0)
+      DONE,        // Tilstandens aktivitet er færdig (autotuning, kogepunktet fundet)
+      ADDITION     // En kogetilsætning skal i nu (value = indeks i BoilAdditions)
+    };
+    enum class Command : uint8_t {
+      NONE, START_MASHING, START_MASHOUT, START_BOILING, STOP, PAUSE, RESUME, START_AUTOTUNE, TOGGLE_PUMP,
+      TOGGLE_GAS, RESET
+    };
+
+    Type type;
+    Command command;
+    uint8_t vessel;          // Indeks i VESSEL_PINS
+    uint64_t timestampMs;    // Clock::nowMs()
+    TempRaw temp;            // Karrets sensor
+    TempRaw limitTemp;       // Grænsesensoren (ventilen); ugyldig uden
+    SensorHealth health;
+    SensorHealth limitHealth;
+    float value;  // START_AUTOTUNE: setpoint; FAULT: 1/0; ADDITION: indeks
+  };
+
+  // Det, der gemmes pr. kar (se EEPROMHandler).
+  struct Settings {
+    MashSchedule schedule;
+    BoilAdditions additions;
+    unsigned long boilTime;      // i sekunder
+    float hysteresis;            // °C
+    float valveOffset;           // °C
+    float pidKp;
+    float pidKi;
+    float pidKd;
+    unsigned long pidWindow;     // i sekunder
+    float boilAltitude;          // m
+    float boilThreshold;         // °C
+  };
+
+  // Initiering og opdatering (fra ProcessHandler). begin() kaldes efter
+  // TemperatureHandler::begin(), så sensorerne kan findes ved navn.
+  void begin(uint8_t index, const VesselPins &pins);
+  // Lægger karrets måling i køen som SAMPLE – kun for et nyt målesæt, eller
+  // når sundheden har skiftet (fx STALE, fordi målingerne er udeblevet).
+  void postSample(const TemperatureSnapshot &sample, uint64_t now);
+  // Poller nedtælling og tilsætninger.
+  void poll(uint64_t now);
+  // Behandler en hændelse fra køen, der er stílet til dette kar.
+  void dispatch(const Event &event);
+  // Efter køen er tømt: checkpoint, relæer og relætællere.
+  void service(uint64_t now);
+
+  const char *getName() const { return pins ? pins->name : ""; }
+  uint8_t getIndex() const { return index; }
+  bool boils() const { return pins && pins->boils; }
+  String getProcessStep() const;
+
+  // Webkommandoer: lægges i køen og udføres ved næste update().
+  void startMashing();
+  void startMashout();  // Springer til mæskeplanens sidste trin
+  void startBoiling();
+  void stopProcess();
+  void pauseProcess();
+  void resumeProcess();
+  // Relæ-autotuning af PID-gains om setpointC; kun fra IDLE.
+  bool startAutotune(float setpointC);
+  const RelayAutoTuner &getAutoTuner() const { return autoTuner; }
+
+  // Proces state: saveProcessState() skriver et checkpoint i fremdriftsjournalen
+  // (ProcessJournal.h), restoreProcessState() genoptager fra det seneste.
+  void saveProcessState();
+  bool restoreProcessState();
+  void resetProcessState();
+
+  // Status og tid
+  String getProcessStatus() const;
+  unsigned long getRemainingTime() const;
+  String getRemainingTimeFormatted() const;
+  String getStartTime() const { return startTimeStr; }
+  String getEndTime() const;
+  // Forventede sekunder til setpoint under opvarmning (termisk model); −1 = ukendt.
+  long getSetpointEta() const;
+  const ThermalModel &getThermalModel() const { return thermalModel; }
+  String getProcessSymbol() const;
+  Status getStatus() const;
+  static const char *statusName(Status status);
+
+  BrewState getCurrentState() const { return currentState; }
+  bool isActive() const { return currentState != BrewState::IDLE && currentState != BrewState::PAUSED; }
+  uint8_t getStepIndex() const { return stepIndex; }  // Aktuelt trin i mæskeplanen (0-baseret)
+  bool isTimerStarted() const { return timerStarted; }
+  bool isBoilingComplete() const { return boilingComplete; }
+  SamplingPolicy getSamplingPolicy() const;
+  bool isSensorAlarmActive() const { return sensorAlarm; }
+  // Venter på knappen; isCalling() er sand, når buzzeren skal kalde på det.
+  bool isAwaitingConfirmation() const { return awaiting != Awaiting::NONE; }
+  bool isCalling() const { return calling; }
+  // Seneste måling (ugyldig uden brugbar måling) og målet i den aktuelle fase.
+  TempRaw getTemp() const { return temp; }
+  SensorHealth getHealth() const { return health; }
+  TempRaw getTarget() const;
+
+  // Toggle-funktioner (kun i IDLE/PAUSE); returnerer den tilstand, relæet får.
+  bool togglePump();
+  bool toggleGasValve();
+  bool hasPump() const { return pins && pins->pumpPin >= 0; }
+  bool isPumpOn() const { return hasPump() && pumpRelay.isOn(); }
+  bool isGasValveOn() const { return heatRelay.isOn(); }
+  bool isHeating() const { return heatRelay.isOn(); }
+  // Relæernes slid og forbrug: tændinger og tid tændt (levetid og siden opstart).
+  RelayActuator::Stats getGasRelayStats() const;
+  RelayActuator::Stats getPumpRelayStats() const;
+
+  // Konfigurationsparametre
+  void setHysteresis(float value);
+  float getHysteresis() const;
+  void setValveOffset(float value);
+  float getValveOffset() const;
+  // Mæskeplanen; under mæskningen kan kun trinnenes temperaturer rettes.
+  bool setSchedule(const MashSchedule &newSchedule);
+  const MashSchedule &getSchedule() const { return schedule; }
+  // Mæskning = planens første trin, udmæskning = dens sidste.
+  void setMashTime(unsigned long time);       // i sekunder
+  unsigned long getMashTime() const;
+  void setMashoutTime(unsigned long time);
+  unsigned long getMashoutTime() const;
+  void setBoilTime(unsigned long time) { boilTime = time; }
+  unsigned long getBoilTime() const { return boilTime; }
+  // Kogetilsætningerne kaldes op med buzzer og LED på deres tidspunkt i
+  // kogningen og skal bekræftes på knappen. Listen kan ikke skiftes under kogning.
+  bool setAdditions(const BoilAdditions &newAdditions);
+  const BoilAdditions &getAdditions() const { return additions; }
+  // Tilsætningen, der venter på bekræftelse, ellers nullptr.
+  const BoilAddition *getDueAddition() const;
+  // Næste tilsætning i den igangværende kogning og sekunder til den, ellers nullptr.
+  const BoilAddition *getNextAddition(unsigned long &secondsLeft) const;
+  void setMashSetpoint(float temp);
+  float getMashSetpoint() const;
+  void setMashoutSetpoint(float temp);
+  float getMashoutSetpoint() const;
+  // PID-regulering af varmen (se temperatureControl)
+  void setPidGains(float kp, float ki, float kd);
+  float getPidKp() const { return pidKp; }
+  float getPidKi() const { return pidKi; }
+  float getPidKd() const { return pidKd; }
+  void setPidWindow(unsigned long seconds);
+  unsigned long getPidWindow() const { return pidWindow; }
+  float getGasDuty() const;  // Aktuel varme-duty i procent
+  // Automatisk kogepunkt (se BoilDetector.h): højde over havet og hvor langt
+  // under det beregnede kogepunkt, der ledes efter plateauet.
+  void setBoilDetection(float altitudeM, float thresholdC);
+  float getBoilAltitude() const { return boilAltitude; }
+  float getBoilThreshold() const { return boilThreshold; }
+  const BoilDetector &getBoilDetector() const { return boilDetector; }
+
+private:
+  // Hvad en bekræftelse på knappen vil sætte i gang.
+  enum class Awaiting : uint8_t { NONE, START, END, ADDITION };
+  // Samplingpolitik pr. fase (se SAMPLING_POLICIES i Vessel.cpp).
+  enum class SamplingProfile : uint8_t { IDLE, RAMP, HOLD, BOIL };
+  // Fasen, som sikkerhedsvagtens grænse for uafbrudt gas gælder for.
+  enum class GasPhase : uint8_t { NONE, OTHER, HEATUP, BOIL };
+
+  // Én række i transitionstabellen. from er en bitmaske af tilstande; to er
+  // en BrewState, STAY (intern transition uden exit/entry) eller HISTORY
+  // (tilstanden før pausen, genoptaget uden entry).
+  struct Transition {
+    uint8_t from;
+    Event::Type event;
+    Event::Command command;  // Kun for COMMAND
+    bool (Vessel::*guard)() const;
+    int8_t to;
+    void (Vessel::*action)(const Event &event);
+  };
+  // Entry/exit og aktiviteten ved hver måling, pr. tilstand.
+  struct StateActions {
+    void (Vessel::*enter)();
+    void (Vessel::*exit)();
+    void (Vessel::*sample)(const Event &event);
+  };
+  static const Transition TRANSITIONS[];
+  static const StateActions STATE_ACTIONS[];
+
+  // Hændelser og transitioner
+  void fire(const Transition &transition, const Event &event);
+  static const StateActions &actionsFor(BrewState state);
+  void applySample(const Event &event);
+  void pollTimer(uint64_t now);
+  void pollAdditions(uint64_t now);
+  bool postSimple(Event::Type type, Event::Command command = Event::Command::NONE, float value = 0.0f);
+  void checkpointProgress(uint64_t now);
+  void armGasLimit();
+  uint64_t elapsedMs() const;
+  bool restoreLegacyState();
+  bool hasLimitSensor() const { return pins && pins->limitSensorName; }
+
+  // Guards
+  bool awaitingStart() const;
+  bool boilCountdownPending() const;
+  bool awaitingEnd() const;
+  bool awaitingAddition() const;
+  bool awaitingEndWithNextStep() const;
+  bool awaitingEndBeforeBoil() const;
+  bool confirmEndRequired() const;
+  bool hasNextStep() const;
+  bool holdsLastStep() const;
+  bool canBoil() const;
+
+  // Entry/exit og målingsaktiviteter
+  void enterIdle();
+  void enterMashing();
+  void exitMashing();
+  void sampleMashing(const Event &event);
+  void enterBoilHeatup();
+  void enterBoiling();
+  void sampleBoil(const Event &event);
+  void enterPaused();
+  void enterAutotune();
+  void exitAutotune();
+  void sampleAutotune(const Event &event);
+
+  // Transitionshandlinger
+  void selectFirstStep(const Event &event);
+  void selectLastStep(const Event &event);
+  void advanceStep(const Event &event);
+  void holdLastStep(const Event &event);
+  void startStepCountdown(const Event &event);
+  void awaitEndConfirmation(const Event &event);
+  void awaitHeatupConfirmation(const Event &event);
+  void startBoilCountdown(const Event &event);
+  void finishBoil(const Event &event);
+  void announceAddition(const Event &event);
+  void confirmAddition(const Event &event);
+  void resumeCountdown(const Event &event);
+  void startTuner(const Event &event);
+  void abortTuner(const Event &event);
+  void togglePumpOutput(const Event &event);
+  void toggleGasOutput(const Event &event);
+  void clearStoredState(const Event &event);
+  void setSensorAlarm(const Event &event);
+
+  // Hardwarestyring
+  void gasControl(bool state);
+  void pumpControl(bool state);
+  void saveRelayCounters(uint64_t now, bool force);
+  void awaitConfirmation(Awaiting what, bool buzzer);
+  void awaitBoilStart();
+  void clearConfirmation();
+  // PID med tidsproportionalt varmerelæ; ventilgrænsen er en hård grænse
+  void temperatureControl(TempRaw currentTemp, TempRaw setpoint, TempRaw tVentil);
+  void autotuneControl(TempRaw currentTemp, TempRaw tVentil);
+  void startCountdown(unsigned long durationSec);
+  void loadAdditionHeap();
+  const MashStep &currentStep() const;
+  void updateSamplingProfile(TempRaw tVentil);
+
+  // Karret, dets sensorer (indeks i TemperatureHandler, -1 = ikke fundet) og relæer
+  uint8_t index = 0;
+  const VesselPins *pins = nullptr;
+  int8_t sensorIndex = -1;
+  int8_t limitIndex = -1;
+  RelayActuator heatRelay;
+  RelayActuator pumpRelay;
+  unsigned long minPulseMs = 0;
+
+  // Tidsvariabler
+  unsigned long processStartEpoch = 0;  // UTC-epoch (sekunder), 0 = ukendt
+  uint64_t processStartMillis = 0;      // Clock::nowMs() – til nedtælling
+  bool timerStarted = false;
+  bool timerFired = false;              // TIMER er lagt i køen for den aktuelle nedtælling
+  uint64_t countdownMs = 0;
+  uint64_t pauseOffset = 0;             // Tid der var forløbet, da pausen aktiveres
+
+  // Mæskeplan og det trin, der afvikles under MASHING
+  MashSchedule schedule = MashSchedule::makeDefault(64.0f, 90 * 60, 75.0f, 10 * 60);  // Erstattes i begin()
+  uint8_t stepIndex = 0;
+  unsigned long boilTime = 60 * 60;
+
+  // Kogetilsætninger, ordnet efter hvornår de skal i, og hvor mange af dem,
+  // der er bekræftet i denne kogning
+  BoilAdditions additions;
+  AdditionHeap additionHeap;
+  uint8_t additionsDone = 0;
+  bool additionPosted = false;             // ADDITION er lagt i køen for heapens top
+
+  // Hysterese og ventil offset (internt i 1/16 °C, se Temperature.h)
+  TempRaw hysteresis = tempRawFromC(1.0f);  // Bånd under setpoint, hvor setpoint regnes for nået
+  TempRaw valveOffset = tempRawFromC(5.0f); // Max ventiltemperatur = setpoint + valveOffset
+
+  // PID-regulering og den termiske model, der lærer karrets dynamik
+  PidController pid;
+  TimeProportioningOutput heatOutput;
+  TempRaw pidSetpoint = TEMP_RAW_INVALID;
+  unsigned long lastPidUpdate = 0;
+  unsigned long lastControlCall = 0;
+  bool pidRunning = false;
+  float pidKp = 0.0f;
+  float pidKi = 0.0f;
+  float pidKd = 0.0f;
+  unsigned long pidWindow = 20;
+  ThermalModel thermalModel;
+  bool predictiveCutoff = false;
+  BoilDetector boilDetector;
+  float boilAltitude = 0.0f;
+  float boilThreshold = 3.0f;
+  RelayAutoTuner autoTuner;
+  TempRaw autotuneSetpoint = TEMP_RAW_INVALID;
+  bool autotuneValveLimited = false;
+
+  // Seneste SAMPLE: målesæt og sundhed lagt i køen og målingen selv
+  uint32_t postedSequence = 0;
+  SensorHealth postedHealth = SensorHealth::OK;
+  SensorHealth postedLimitHealth = SensorHealth::OK;
+  TempRaw temp = TEMP_RAW_INVALID;
+  SensorHealth health = SensorHealth::OK;
+  SensorHealth limitHealth = SensorHealth::OK;
+  bool sensorAlarm = false;
+
+  // Bekræftelse på knappen; ProcessHandler spiller buzzer og LED for alle kar
+  Awaiting awaiting = Awaiting::NONE;
+  bool calling = false;
+
+  // Bryg-tilstand og visningstider
+  BrewState currentState = BrewState::IDLE;
+  BrewState previousState = BrewState::IDLE;  // Tilstanden før seneste transition (før pausen, når PAUSED)
+  bool boilingComplete = false;
+  String startTimeStr;
+  String endTimeStr;
+
+  SamplingProfile samplingProfile = SamplingProfile::IDLE;
+  bool valveNearLimit = false;
+  GasPhase gasPhase = GasPhase::NONE;
+
+  ProcessJournal journal;
+  uint64_t lastCheckpoint = 0;
+};
+
+#endif // VESSEL_H
@@ -4,12 +4,15 @@
 
 #include <WebServer.h>
 #include <HTTPUpdateServer.h>
+#include "RecipeParser.h"
 
 class WebServerHandler {
 public:
     static void begin();
     static void handleClient();
     static void handleDebug();
+    // Giver simuleringen (env:native) adgang til at sende forespørgsler.
+    static WebServer &getServer();
 
     // Routes
     static void handleRoot();
@@ -27,11 +30,22 @@ public:
     static void handleStopProcess();
     static void handlePauseProcess();
     static void handleResumeProcess();
+    static void handleStartAutotune();
+    static void handleAutotune();  // Status og spor (JSON)
+    static void handleSchedule();
+    static void handleSaveSchedule();
+    static void handleSaveAdditions();
+    static void handleVessel();        // Mål og tænd/sluk for et kar
+    static void handleSafety();        // Sikkerhedsalarmen: status og nulstilling
+    static void handleRecipe();        // Import af BeerXML/BeerJSON (multipart)
+    static void handleRecipeUpload();
 
 private:
     static void handleResetProcessState();
     static WebServer server;
     static HTTPUpdateServer httpUpdater;
+    static RecipeParser recipeParser;
+    static bool recipeReady;  // Sidste upload blev parset helt
 };
 
 #endif // WEBSERVERHANDLER_H
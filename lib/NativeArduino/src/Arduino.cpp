@@ -0,0 +1,43 @@
+#include "Arduino.h"
+#include <stdarg.h>
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::print(const String &s) {
+  return out ? fwrite(s.c_str(), 1, s.length(), out) : 0;
+}
+
+size_t HardwareSerial::print(const char *s) {
+  return out && fputs(s, out) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c) {
+  return out && fputc(c, out) != EOF ? 1 : 0;
+}
+
+size_t HardwareSerial::print(long value) {
+  return printf("%ld", value);
+}
+
+size_t HardwareSerial::print(unsigned long value) {
+  return printf("%lu", value);
+}
+
+size_t HardwareSerial::print(double value, int digits) {
+  return printf("%.*f", digits, value);
+}
+
+size_t HardwareSerial::println() {
+  return print('\n');
+}
+
+size_t HardwareSerial::printf(const char *format, ...) {
+  if (!out) {
+    return 0;
+  }
+  va_list args;
+  va_start(args, format);
+  int n = vfprintf(out, format, args);
+  va_end(args);
+  return n < 0 ? 0 : n;
+}
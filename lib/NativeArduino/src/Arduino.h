@@ -0,0 +1,62 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Arduino-kompatibelt minimum til env:native. Hardware tilgås ikke herfra,
+// men gennem Hal (include/Hal.h), som har en simuleret implementering på værten.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "WString.h"
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define PI 3.1415926535897932384626433832795
+
+// Ingen IRAM på værten; ISR-kode oversættes som almindelige funktioner.
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+// Serial skriver til stdout, eller til setOutput()'s fil (nullptr = ingen udskrift).
+class HardwareSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void setOutput(FILE *file) { out = file; }
+  size_t print(const String &s);
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(long value);
+  size_t print(unsigned long value);
+  size_t print(int value) { return print(static_cast<long>(value)); }
+  size_t print(unsigned int value) { return print(static_cast<unsigned long>(value)); }
+  size_t print(double value, int digits = 2);
+  size_t println();
+  template <typename T>
+  size_t println(const T &value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+  FILE *out = stdout;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,12 @@
+#ifndef NATIVE_HTTP_UPDATE_SERVER_H
+#define NATIVE_HTTP_UPDATE_SERVER_H
+
+#include "WebServer.h"
+
+// Firmwareopdatering findes ikke på værten; /update registreres ikke.
+class HTTPUpdateServer {
+public:
+  void setup(WebServer *server) { (void)server; }
+};
+
+#endif // NATIVE_HTTP_UPDATE_SERVER_H
@@ -0,0 +1,107 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+  std::string formatInteger(unsigned long long magnitude, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) {
+      base = 10;
+    }
+    char buf[72];
+    char *p = buf + sizeof(buf);
+    *--p = '\0';
+    do {
+      unsigned digit = magnitude % base;
+      *--p = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+      magnitude /= base;
+    } while (magnitude);
+    if (negative) {
+      *--p = '-';
+    }
+    return p;
+  }
+
+  std::string formatDecimal(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimals), value);
+    return buf;
+  }
+}
+
+String::String(int value, unsigned char base)
+  : String(static_cast<long>(value), base) {}
+
+String::String(unsigned int value, unsigned char base)
+  : String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base)
+  : data(base == 10 ? formatInteger(value < 0 ? -static_cast<unsigned long long>(value) : value, value < 0, base)
+                    : formatInteger(static_cast<unsigned long>(value), false, base)) {}
+
+String::String(unsigned long value, unsigned char base)
+  : data(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned int decimals)
+  : data(formatDecimal(value, decimals)) {}
+
+String::String(double value, unsigned int decimals)
+  : data(formatDecimal(value, decimals)) {}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t pos = data.find(c, from);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String &s, unsigned int from) const {
+  size_t pos = data.find(s.data, from);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int tmp = from;
+    from = to;
+    to = tmp;
+  }
+  if (from >= data.size()) {
+    return String();
+  }
+  String result;
+  result.data = data.substr(from, to - from);
+  return result;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return data.size() >= suffix.data.size() &&
+         data.compare(data.size() - suffix.data.size(), suffix.data.size(), suffix.data) == 0;
+}
+
+void String::trim() {
+  size_t begin = 0;
+  size_t end = data.size();
+  while (begin < end && isspace(static_cast<unsigned char>(data[begin]))) {
+    begin++;
+  }
+  while (end > begin && isspace(static_cast<unsigned char>(data[end - 1]))) {
+    end--;
+  }
+  data = data.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+  for (char &c : data) {
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+  }
+}
+
+void String::replace(const String &find, const String &replacement) {
+  if (find.data.empty()) {
+    return;
+  }
+  size_t pos = 0;
+  while ((pos = data.find(find.data, pos)) != std::string::npos) {
+    data.replace(pos, find.data.size(), replacement.data);
+    pos += replacement.data.size();
+  }
+}
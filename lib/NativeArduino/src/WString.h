@@ -0,0 +1,73 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string>
+
+// Arduino String oven på std::string – kun den del af API'et, projektet bruger.
+class String {
+public:
+  String() {}
+  String(const char *s) : data(s ? s : "") {}
+  String(const String &other) = default;
+  String(String &&other) = default;
+  explicit String(char c) : data(1, c) {}
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimals = 2);
+  explicit String(double value, unsigned int decimals = 2);
+
+  String &operator=(const String &other) = default;
+  String &operator=(String &&other) = default;
+  String &operator=(const char *s) { data = s ? s : ""; return *this; }
+
+  String &operator+=(const String &s) { data += s.data; return *this; }
+  String &operator+=(const char *s) { data += s ? s : ""; return *this; }
+  String &operator+=(char c) { data += c; return *this; }
+  template <typename T>
+  String &operator+=(T value) { return *this += String(value); }
+
+  bool concat(const String &s) { data += s.data; return true; }
+  bool reserve(unsigned int size) { data.reserve(size); return true; }
+
+  const char *c_str() const { return data.c_str(); }
+  unsigned int length() const { return data.size(); }
+  bool isEmpty() const { return data.empty(); }
+  char charAt(unsigned int index) const { return index < data.size() ? data[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String &s, unsigned int from = 0) const;
+  String substring(unsigned int from) const { return substring(from, data.size()); }
+  String substring(unsigned int from, unsigned int to) const;
+  bool startsWith(const String &prefix) const { return data.compare(0, prefix.data.size(), prefix.data) == 0; }
+  bool endsWith(const String &suffix) const;
+  bool equals(const String &s) const { return data == s.data; }
+  void trim();
+  void toLowerCase();
+  void replace(const String &find, const String &replacement);
+
+  long toInt() const { return strtol(data.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(data.c_str(), nullptr); }
+
+  bool operator==(const String &s) const { return data == s.data; }
+  bool operator==(const char *s) const { return data == (s ? s : ""); }
+  bool operator!=(const String &s) const { return data != s.data; }
+  bool operator!=(const char *s) const { return !(*this == s); }
+  bool operator<(const String &s) const { return data < s.data; }
+
+private:
+  std::string data;
+};
+
+inline String operator+(const String &lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+inline String operator+(const String &lhs, const char *rhs) { String s(lhs); s += rhs; return s; }
+inline String operator+(const char *lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+inline String operator+(const String &lhs, char rhs) { String s(lhs); s += rhs; return s; }
+template <typename T>
+String operator+(const String &lhs, T rhs) { String s(lhs); s += String(rhs); return s; }
+
+#endif // NATIVE_WSTRING_H
@@ -0,0 +1,113 @@
+#include "WebServer.h"
+
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction handler) {
+  routes.push_back({uri, method, handler, nullptr});
+}
+
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler) {
+  routes.push_back({uri, method, handler, uploadHandler});
+}
+
+const WebServer::Route *WebServer::route(HTTPMethod method, const String &uri) const {
+  for (const Route &r : routes) {
+    if (r.uri == uri && (r.method == HTTP_ANY || r.method == method)) {
+      return &r;
+    }
+  }
+  return nullptr;
+}
+
+void WebServer::send(int code, const char *contentType, const String &content) {
+  lastCode = code;
+  lastType = contentType ? contentType : "";
+  lastBody = content;
+}
+
+void WebServer::sendHeader(const String &name, const String &value, bool first) {
+  (void)name;
+  (void)value;
+  (void)first;
+}
+
+bool WebServer::hasArg(const String &name) const {
+  for (const Arg &a : requestArgs) {
+    if (a.name == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+String WebServer::arg(const String &name) const {
+  for (const Arg &a : requestArgs) {
+    if (a.name == name) {
+      return a.value;
+    }
+  }
+  return String();
+}
+
+int WebServer::request(HTTPMethod method, const String &uri) {
+  requestArgs.clear();
+  requestMethod = method;
+  int query = uri.indexOf('?');
+  requestUri = query < 0 ? uri : uri.substring(0, query);
+  if (query >= 0) {
+    String rest = uri.substring(query + 1);
+    while (rest.length() > 0) {
+      int amp = rest.indexOf('&');
+      String pair = amp < 0 ? rest : rest.substring(0, amp);
+      rest = amp < 0 ? String() : rest.substring(amp + 1);
+      int eq = pair.indexOf('=');
+      requestArgs.push_back({eq < 0 ? pair : pair.substring(0, eq), eq < 0 ? String() : pair.substring(eq + 1)});
+    }
+  }
+
+  lastCode = 404;
+  lastType = "text/plain";
+  lastBody = "Not found";
+  if (!running) {
+    return lastCode;
+  }
+  const Route *r = route(method, requestUri);
+  if (r) {
+    r->handler();
+  }
+  return lastCode;
+}
+
+int WebServer::requestUpload(const String &uri, const String &filename, const uint8_t *data, size_t len) {
+  requestArgs.clear();
+  requestMethod = HTTP_POST;
+  requestUri = uri;
+  lastCode = 404;
+  lastType = "text/plain";
+  lastBody = "Not found";
+  const Route *r = running ? route(HTTP_POST, uri) : nullptr;
+  if (!r) {
+    return lastCode;
+  }
+  if (r->uploadHandler) {
+    HTTPUpload &upload = currentUpload;
+    upload.filename = filename;
+    upload.name = "file";
+    upload.type = "application/octet-stream";
+    upload.totalSize = 0;
+    upload.currentSize = 0;
+    upload.status = UPLOAD_FILE_START;
+    r->uploadHandler();
+    for (size_t offset = 0; offset < len; offset += HTTP_UPLOAD_BUFLEN) {
+      size_t chunk = len - offset < HTTP_UPLOAD_BUFLEN ? len - offset : HTTP_UPLOAD_BUFLEN;
+      memcpy(upload.buf, data + offset, chunk);
+      upload.currentSize = chunk;
+      upload.status = UPLOAD_FILE_WRITE;
+      r->uploadHandler();
+      upload.totalSize += chunk;
+    }
+    upload.currentSize = 0;
+    upload.status = UPLOAD_FILE_END;
+    r->uploadHandler();
+  }
+  r->handler();
+  return lastCode;
+}
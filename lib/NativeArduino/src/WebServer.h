@@ -0,0 +1,88 @@
+#ifndef NATIVE_WEBSERVER_H
+#define NATIVE_WEBSERVER_H
+
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+// Som i Arduino-ESP32: en multipart-upload leveres i bidder af HTTP_UPLOAD_BUFLEN.
+#define HTTP_UPLOAD_BUFLEN 1436
+
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+// WebServer uden sockets: request() sender en forespørgsel direkte til den
+// registrerede handler, og svaret kan læses tilbage. Bruges af simuleringen
+// til at køre webkommandoer mod den rigtige WebServerHandler.
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : port(port) {}
+
+  void begin() { running = true; }
+  void handleClient() {}
+
+  void on(const String &uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void on(const String &uri, HTTPMethod method, THandlerFunction handler);
+  void on(const String &uri, HTTPMethod method, THandlerFunction handler, THandlerFunction uploadHandler);
+
+  void send(int code, const char *contentType = nullptr, const String &content = String());
+  void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content); }
+  void sendHeader(const String &name, const String &value, bool first = false);
+
+  bool hasArg(const String &name) const;
+  String arg(const String &name) const;
+  int args() const { return static_cast<int>(requestArgs.size()); }
+  const String &uri() const { return requestUri; }
+  HTTPMethod method() const { return requestMethod; }
+  HTTPUpload &upload() { return currentUpload; }
+
+  // Simulering. Argumenter kan gives i URI'en ("/saveSettings?boilTime=60").
+  // Returnerer HTTP-statuskoden (404, hvis ingen handler matcher).
+  int request(HTTPMethod method, const String &uri);
+  // POST af en fil som multipart-upload: uploadhandleren kaldes med START,
+  // WRITE pr. bid og END, og derefter den almindelige handler.
+  int requestUpload(const String &uri, const String &filename, const uint8_t *data, size_t len);
+  int responseCode() const { return lastCode; }
+  const String &responseType() const { return lastType; }
+  const String &responseBody() const { return lastBody; }
+
+private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+    THandlerFunction uploadHandler;
+  };
+  struct Arg {
+    String name;
+    String value;
+  };
+
+  int port;
+  bool running = false;
+  const Route *route(HTTPMethod method, const String &uri) const;
+
+  std::vector<Route> routes;
+  HTTPUpload currentUpload;
+  std::vector<Arg> requestArgs;
+  String requestUri;
+  HTTPMethod requestMethod = HTTP_GET;
+  int lastCode = 0;
+  String lastType;
+  String lastBody;
+};
+
+#endif // NATIVE_WEBSERVER_H
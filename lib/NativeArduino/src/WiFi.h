@@ -0,0 +1,14 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include "Arduino.h"
+
+// Kun det, webhandlerne kalder; forbindelsen simuleres i Hal.
+class WiFiClass {
+public:
+  void scanDelete() {}
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
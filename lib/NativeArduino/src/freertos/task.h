@@ -0,0 +1,19 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t,
+                                          TaskHandle_t *handle, BaseType_t) {
+  if (handle) {
+    *handle = nullptr;
+  }
+  return pdFAIL;
+}
+
+inline TickType_t xTaskGetTickCount() { return 0; }
+inline void vTaskDelay(TickType_t) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+
+#endif // NATIVE_FREERTOS_TASK_H
@@ -0,0 +1,27 @@
+#include "ArduinoOneWireBus.h"
+
+ArduinoOneWireBus::ArduinoOneWireBus(uint8_t pin) : wire(pin) {}
+
+bool ArduinoOneWireBus::begin() {
+  return true;
+}
+
+bool ArduinoOneWireBus::reset() {
+  return wire.reset() == 1;
+}
+
+void ArduinoOneWireBus::writeBytes(const uint8_t *data, uint8_t len) {
+  wire.write_bytes(data, len);
+}
+
+void ArduinoOneWireBus::readBytes(uint8_t *data, uint8_t len) {
+  wire.read_bytes(data, len);
+}
+
+bool ArduinoOneWireBus::readBit() {
+  return wire.read_bit() != 0;
+}
+
+void ArduinoOneWireBus::writeBit(bool bit) {
+  wire.write_bit(bit ? 1 : 0);
+}
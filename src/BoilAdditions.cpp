@@ -0,0 +1,203 @@
+#include "BoilAdditions.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+  bool separator(char c) {
+    return c == ',' || c == ';';
+  }
+
+  constexpr char ESCAPE = '\\';
+
+  // Et afkortet navn (her eller i opskriftsparseren) må ikke ende midt i et
+  // UTF-8-tegn (fx ü): længden rykkes tilbage til et ufuldstændigt sidste tegns start.
+  size_t utf8Cut(const char *text, size_t len) {
+    size_t start = len;
+    while (start > 0 && (static_cast<uint8_t>(text[start - 1]) & 0xC0) == 0x80) {
+      start--;
+    }
+    if (start == 0) {
+      return len;
+    }
+    uint8_t lead = text[start - 1];
+    size_t need = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    return len - (start - 1) < need ? start - 1 : len;
+  }
+}
+
+bool BoilAdditions::add(const char *name, uint16_t minutes, uint16_t grams) {
+  if (count >= MAX_ADDITIONS) {
+    return false;
+  }
+  BoilAddition &addition = items[count++];
+  size_t len = 0;
+  for (; name[len] && len < BoilAddition::NAME_SIZE - 1; len++) {
+    addition.name[len] = name[len];
+  }
+  len = utf8Cut(addition.name, len);
+  addition.name[len] = '\0';
+  addition.minutes = minutes < MAX_MINUTES ? minutes : MAX_MINUTES;
+  addition.grams = grams;
+  return true;
+}
+
+bool BoilAdditions::isValid() const {
+  if (count > MAX_ADDITIONS) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (items[i].name[0] == '\0' || items[i].minutes > MAX_MINUTES) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BoilAdditions::parse(const char *text) {
+  BoilAdditions parsed;
+  const char *p = text;
+  while (*p == ' ') {
+    p++;
+  }
+  while (*p) {
+    char *end;
+    long minutes = strtol(p, &end, 10);
+    if (end == p || *end != ',' || minutes < 0 || minutes > MAX_MINUTES) {
+      return false;
+    }
+    p = end + 1;
+    while (*p == ' ') {
+      p++;
+    }
+    char name[BoilAddition::NAME_SIZE];
+    size_t len = 0;
+    for (; *p && !separator(*p); p++) {
+      if (*p == ESCAPE && p[1]) {
+        p++;
+      }
+      if (len < sizeof(name) - 1) {
+        name[len++] = *p;
+      }
+    }
+    while (len > 0 && name[len - 1] == ' ') {
+      len--;
+    }
+    name[len] = '\0';
+    long grams = 0;
+    if (*p == ',') {
+      p++;
+      grams = strtol(p, &end, 10);
+      if (end == p || grams < 0 || grams > 65535) {
+        return false;
+      }
+      p = end;
+    }
+    while (*p == ' ') {
+      p++;
+    }
+    if (*p == ';') {
+      p++;
+    } else if (*p) {
+      return false;
+    }
+    if (len == 0 || !parsed.add(name, minutes, grams)) {
+      return false;
+    }
+    while (*p == ' ') {
+      p++;
+    }
+  }
+  *this = parsed;
+  return true;
+}
+
+String BoilAdditions::toString() const {
+  String text;
+  for (uint8_t i = 0; i < count; i++) {
+    const BoilAddition &addition = items[i];
+    if (i > 0) {
+      text += ";";
+    }
+    text += String(addition.minutes) + ",";
+    for (const char *c = addition.name; *c; c++) {
+      if (separator(*c) || *c == ESCAPE) {
+        text += ESCAPE;
+      }
+      text += *c;
+    }
+    if (addition.grams > 0) {
+      text += "," + String(addition.grams);
+    }
+  }
+  return text;
+}
+
+void BoilAdditions::pack(uint8_t index, uint8_t out[STORED_ADDITION_SIZE]) const {
+  const BoilAddition &addition = items[index];
+  out[0] = addition.minutes & 0xFF;
+  out[1] = addition.minutes >> 8;
+  out[2] = addition.grams & 0xFF;
+  out[3] = addition.grams >> 8;
+  strncpy(reinterpret_cast<char *>(out + 4), addition.name, BoilAddition::NAME_SIZE - 1);
+}
+
+void BoilAdditions::unpack(uint8_t index, const uint8_t in[STORED_ADDITION_SIZE]) {
+  BoilAddition &addition = items[index];
+  addition.minutes = in[0] | (in[1] << 8);
+  addition.grams = in[2] | (in[3] << 8);
+  memcpy(addition.name, in + 4, BoilAddition::NAME_SIZE - 1);
+  addition.name[BoilAddition::NAME_SIZE - 1] = '\0';
+}
+
+bool AdditionHeap::before(const Entry &a, const Entry &b) {
+  return a.dueSec < b.dueSec || (a.dueSec == b.dueSec && a.index < b.index);
+}
+
+bool AdditionHeap::push(uint32_t dueSec, uint8_t index) {
+  if (size >= BoilAdditions::MAX_ADDITIONS) {
+    return false;
+  }
+  uint8_t i = size++;
+  Entry entry = {dueSec, index};
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (!before(entry, entries[parent])) {
+      break;
+    }
+    entries[i] = entries[parent];
+    i = parent;
+  }
+  entries[i] = entry;
+  return true;
+}
+
+void AdditionHeap::pop() {
+  if (size == 0) {
+    return;
+  }
+  Entry last = entries[--size];
+  uint8_t i = 0;
+  for (;;) {
+    uint8_t child = 2 * i + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && before(entries[child + 1], entries[child])) {
+      child++;
+    }
+    if (!before(entries[child], last)) {
+      break;
+    }
+    entries[i] = entries[child];
+    i = child;
+  }
+  entries[i] = last;
+}
+
+void AdditionHeap::load(const BoilAdditions &additions, uint32_t boilSec) {
+  clear();
+  for (uint8_t i = 0; i < additions.count; i++) {
+    uint32_t beforeEnd = additions.items[i].minutes * 60UL;
+    push(beforeEnd < boilSec ? boilSec - beforeEnd : 0, i);
+  }
+}
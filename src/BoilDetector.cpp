@@ -0,0 +1,90 @@
+#include "BoilDetector.h"
+#include <math.h>
+
+namespace {
+  // Standardatmosfæren og vands fordampningsvarme
+  constexpr float SEA_LEVEL_KPA = 101.325f;
+  constexpr float LAPSE_FACTOR = 2.25577e-5f;  // 1/m
+  constexpr float PRESSURE_EXPONENT = 5.25588f;
+  constexpr float WATER_BOIL_K = 373.15f;
+  constexpr float KELVIN = 273.15f;
+  constexpr float GAS_CONSTANT = 8.314f;            // J/(mol·K)
+  constexpr float VAPORIZATION_HEAT = 40660.0f;     // J/mol
+
+  // Er der gået mere end to perioder siden sidste måling, er vinduet forældet.
+  constexpr unsigned long MAX_GAP_MS = 2 * BoilDetector::SAMPLE_MS;
+}
+
+float BoilDetector::boilingPointC(float altitudeM) {
+  float pressure = SEA_LEVEL_KPA * powf(1.0f - LAPSE_FACTOR * altitudeM, PRESSURE_EXPONENT);
+  float inverseT = 1.0f / WATER_BOIL_K - GAS_CONSTANT * logf(pressure / SEA_LEVEL_KPA) / VAPORIZATION_HEAT;
+  return 1.0f / inverseT - KELVIN;
+}
+
+void BoilDetector::configure(float altitudeM, float marginC) {
+  boilingPoint = boilingPointC(altitudeM);
+  margin = marginC;
+}
+
+void BoilDetector::reset() {
+  count = 0;
+  head = 0;
+  lastSampleMs = 0;
+  boiling = false;
+}
+
+bool BoilDetector::update(float temperatureC, unsigned long nowMs) {
+  if (boiling || !isfinite(temperatureC)) {
+    return false;
+  }
+  if (count > 0) {
+    unsigned long since = nowMs - lastSampleMs;
+    if (since > MAX_GAP_MS) {
+      count = 0;
+      head = 0;
+    } else if (since < SAMPLE_MS) {
+      return false;
+    }
+  }
+  lastSampleMs = nowMs;
+  samples[head] = temperatureC;
+  head = (head + 1) % WINDOW_SAMPLES;
+  if (count < WINDOW_SAMPLES) {
+    count++;
+  }
+  if (count < WINDOW_SAMPLES) {
+    return false;
+  }
+
+  float threshold = getThreshold();
+  for (uint8_t i = 0; i < WINDOW_SAMPLES; i++) {
+    if (samples[i] < threshold) {
+      return false;
+    }
+  }
+  boiling = fabsf(getRate()) <= PLATEAU_RATE;
+  return boiling;
+}
+
+float BoilDetector::getRate() const {
+  if (count < WINDOW_SAMPLES) {
+    return NAN;
+  }
+  // Mindste kvadraters hældning med x = 0 … N−1 i rækkefølge fra ældst.
+  constexpr float N = WINDOW_SAMPLES;
+  constexpr float MEAN_X = (N - 1.0f) / 2.0f;
+  float meanY = 0.0f;
+  for (uint8_t i = 0; i < WINDOW_SAMPLES; i++) {
+    meanY += samples[i];
+  }
+  meanY /= N;
+  float sxy = 0.0f;
+  float sxx = 0.0f;
+  for (uint8_t i = 0; i < WINDOW_SAMPLES; i++) {
+    float x = i - MEAN_X;
+    sxy += x * (samples[(head + i) % WINDOW_SAMPLES] - meanY);
+    sxx += x * x;
+  }
+  float perSample = sxy / sxx;
+  return perSample * 60000.0f / SAMPLE_MS;
+}
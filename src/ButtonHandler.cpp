@@ -0,0 +1,141 @@
+#include "ButtonHandler.h"
+#include "Hal.h"
+#include <Arduino.h>
+#include <atomic>
+
+namespace {
+  using Gesture = ButtonHandler::Gesture;
+
+  // Ringen mellem ISR'en (producent) og timeren (forbruger).
+  constexpr uint8_t EDGE_CAPACITY = 16;
+
+  struct Edge {
+    uint64_t timeMs;
+    bool level;
+  };
+
+  Edge edges[EDGE_CAPACITY];
+  std::atomic<uint8_t> edgeHead{0};
+  std::atomic<uint8_t> edgeTail{0};
+  std::atomic<uint32_t> lostEdges{0};
+
+  uint8_t buttonPin = 0;
+  ButtonHandler::Sink gestureSink = nullptr;
+  bool started = false;
+
+  // Debounceren: det rå niveau og hvornår det sidst skiftede
+  bool rawLevel = true;
+  uint64_t rawSince = 0;
+  bool stableLevel = true;
+
+  // Gestusgenkendelsen
+  uint64_t pressedAt = 0;
+  bool longReported = false;
+  bool secondPress = false;   // Det aktuelle tryk kom inden for DOUBLE_GAP_MS
+  bool shortPending = false;  // Et kort tryk venter på, om der kommer et til
+  uint64_t releasedAt = 0;
+
+  void IRAM_ATTR onEdge() {
+    uint8_t head = edgeHead.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % EDGE_CAPACITY;
+    if (next == edgeTail.load(std::memory_order_acquire)) {
+      lostEdges.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    edges[head].timeMs = Hal::millis64();
+    edges[head].level = Hal::digitalRead(buttonPin);
+    edgeHead.store(next, std::memory_order_release);
+  }
+
+  void emit(Gesture gesture, uint64_t timestampMs) {
+    if (gestureSink) {
+      gestureSink(gesture, timestampMs);
+    }
+  }
+
+  void stableChanged(bool level, uint64_t timeMs) {
+    stableLevel = level;
+    if (!level) {
+      pressedAt = timeMs;
+      longReported = false;
+      secondPress = shortPending;
+      shortPending = false;
+    } else if (!longReported) {
+      if (secondPress) {
+        secondPress = false;
+        emit(Gesture::DOUBLE, timeMs);
+      } else {
+        shortPending = true;
+        releasedAt = timeMs;
+      }
+    }
+  }
+
+  // Et råt niveau, der har holdt i DEBOUNCE_MS, bliver det stabile – stemplet
+  // med skiftets tid, ikke med hvornår det blev opdaget.
+  void settle(uint64_t nowMs) {
+    if (rawLevel != stableLevel && nowMs - rawSince >= ButtonHandler::DEBOUNCE_MS) {
+      stableChanged(rawLevel, rawSince);
+    }
+  }
+
+  void rawEdge(bool level, uint64_t timeMs) {
+    settle(timeMs);
+    rawLevel = level;
+    rawSince = timeMs;
+  }
+
+  void tick() {
+    uint8_t tail = edgeTail.load(std::memory_order_relaxed);
+    while (tail != edgeHead.load(std::memory_order_acquire)) {
+      rawEdge(edges[tail].level, edges[tail].timeMs);
+      tail = (tail + 1) % EDGE_CAPACITY;
+      edgeTail.store(tail, std::memory_order_release);
+    }
+
+    uint64_t now = Hal::millis64();
+    // Er et skift gået tabt (fuld ring), rettes niveauet op ud fra pinnen.
+    bool level = Hal::digitalRead(buttonPin);
+    if (level != rawLevel && tail == edgeHead.load(std::memory_order_acquire)) {
+      rawEdge(level, now);
+    }
+    settle(now);
+
+    if (!stableLevel && !longReported && now - pressedAt >= ButtonHandler::LONG_PRESS_MS) {
+      longReported = true;
+      if (secondPress) {
+        // Det første tryk var et almindeligt kort tryk.
+        secondPress = false;
+        emit(Gesture::SHORT, pressedAt);
+      }
+      emit(Gesture::LONG, pressedAt + ButtonHandler::LONG_PRESS_MS);
+    }
+    if (shortPending && stableLevel && now - releasedAt >= ButtonHandler::DOUBLE_GAP_MS) {
+      shortPending = false;
+      emit(Gesture::SHORT, releasedAt);
+    }
+  }
+}
+
+void ButtonHandler::begin(uint8_t pin, Sink sink) {
+  buttonPin = pin;
+  gestureSink = sink;
+  Hal::pinMode(pin, INPUT_PULLUP);
+  rawLevel = Hal::digitalRead(pin);
+  rawSince = Hal::millis64();
+  stableLevel = rawLevel;
+  longReported = !stableLevel;  // Holdt nede ved opstart: ingen gestus før slip
+  secondPress = false;
+  shortPending = false;
+  if (!started) {
+    started = true;
+    Hal::attachPinChange(pin, onEdge);
+    if (!Hal::startPeriodic(tick, TICK_MS)) {
+      Serial.println("[ButtonHandler] Kunne ikke starte timeren – knappen virker ikke!");
+    }
+  }
+}
+
+uint32_t ButtonHandler::getLostEdges() {
+  return lostEdges.load(std::memory_order_relaxed);
+}
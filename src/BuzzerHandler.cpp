@@ -0,0 +1,135 @@
+#include "BuzzerHandler.h"
+#include "Hal.h"
+#include <Arduino.h>
+#include <atomic>
+
+namespace {
+  using Pattern = BuzzerHandler::Pattern;
+
+  struct Note {
+    uint16_t frequencyHz;  // 0 = pause
+    uint16_t durationMs;
+  };
+
+  struct PatternDef {
+    const Note *notes;
+    uint8_t count;
+    bool repeat;
+  };
+
+  const Note STEP_DONE_NOTES[] = {{1000, 120}, {0, 60}, {1300, 120}, {0, 60}, {1600, 200}};
+  // To bip og en pause: kalder, til der er bekræftet.
+  const Note CONFIRM_NOTES[] = {{750, 200}, {0, 150}, {750, 200}, {0, 1450}};
+  // Tre korte, høje bip – til at skelne fra en almindelig bekræftelse.
+  const Note ADDITION_NOTES[] = {{1500, 100}, {0, 80}, {1500, 100}, {0, 80}, {1500, 100}, {0, 1040}};
+  // Vekseltone uden pause.
+  const Note FAULT_NOTES[] = {{1000, 250}, {750, 250}};
+
+  template <size_t N>
+  constexpr PatternDef pattern(const Note (&notes)[N], bool repeat) {
+    return {notes, static_cast<uint8_t>(N), repeat};
+  }
+
+  // Samme rækkefølge som Pattern.
+  const PatternDef PATTERNS[] = {
+    pattern(STEP_DONE_NOTES, false),
+    pattern(CONFIRM_NOTES, true),
+    pattern(ADDITION_NOTES, true),
+    pattern(FAULT_NOTES, true),
+  };
+  static_assert(sizeof(PATTERNS) / sizeof(PATTERNS[0]) == static_cast<size_t>(Pattern::COUNT),
+                "PATTERNS skal have én post pr. Pattern");
+
+  constexpr uint8_t NONE = static_cast<uint8_t>(Pattern::COUNT);
+
+  // Ønskede mønstre som bitmaske; skrives fra loop(), læses af timeren.
+  std::atomic<uint8_t> requested{0};
+  bool started = false;
+
+  // Afspilleren (kun timeren)
+  uint8_t playing = NONE;
+  uint8_t noteIndex = 0;
+  uint64_t noteStartedAt = 0;
+  uint16_t currentHz = 0;
+
+  uint8_t bit(Pattern pattern) {
+    return 1u << static_cast<uint8_t>(pattern);
+  }
+
+  void tone(uint16_t frequencyHz) {
+    if (frequencyHz != currentHz) {
+      currentHz = frequencyHz;
+      Hal::buzzerTone(frequencyHz);
+    }
+  }
+
+  uint8_t highestRequested() {
+    uint8_t mask = requested.load(std::memory_order_acquire);
+    for (uint8_t i = NONE; i-- > 0;) {
+      if (mask & (1u << i)) {
+        return i;
+      }
+    }
+    return NONE;
+  }
+
+  void tick() {
+    uint64_t now = Hal::millis64();
+    uint8_t wanted = highestRequested();
+    if (wanted != playing) {
+      playing = wanted;
+      noteIndex = 0;
+      noteStartedAt = now;
+    }
+    if (playing == NONE) {
+      tone(0);
+      return;
+    }
+
+    const PatternDef &def = PATTERNS[playing];
+    while (now - noteStartedAt >= def.notes[noteIndex].durationMs) {
+      noteStartedAt += def.notes[noteIndex].durationMs;
+      if (++noteIndex < def.count) {
+        continue;
+      }
+      if (!def.repeat) {
+        // Færdig: næste tick tager det næste ønskede mønster.
+        requested.fetch_and(static_cast<uint8_t>(~(1u << playing)), std::memory_order_acq_rel);
+        playing = NONE;
+        tone(0);
+        return;
+      }
+      noteIndex = 0;
+    }
+    tone(def.notes[noteIndex].frequencyHz);
+  }
+}
+
+void BuzzerHandler::begin(uint8_t pin) {
+  requested.store(0, std::memory_order_release);
+  Hal::buzzerBegin(pin);
+  currentHz = 0;
+  playing = NONE;
+  if (!started) {
+    started = true;
+    if (!Hal::startPeriodic(tick, TICK_MS)) {
+      Serial.println("[BuzzerHandler] Kunne ikke starte timeren – buzzeren er tavs!");
+    }
+  }
+}
+
+void BuzzerHandler::start(Pattern pattern) {
+  requested.fetch_or(bit(pattern), std::memory_order_acq_rel);
+}
+
+void BuzzerHandler::stop(Pattern pattern) {
+  requested.fetch_and(static_cast<uint8_t>(~bit(pattern)), std::memory_order_acq_rel);
+}
+
+bool BuzzerHandler::isRequested(Pattern pattern) {
+  return requested.load(std::memory_order_acquire) & bit(pattern);
+}
+
+bool BuzzerHandler::isSounding() {
+  return requested.load(std::memory_order_acquire) != 0;
+}
@@ -0,0 +1,86 @@
+#include "Clock.h"
+#include "Hal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+  char tzText[Clock::TIMEZONE_SIZE] = "";
+  unsigned long cachedEpoch = 0;
+  String cachedTime = "--:--:--";
+}
+
+void Clock::begin(const char *tz) {
+  // SNTP startes først; tidszonen sættes bagefter, så den ikke overskrives.
+  Hal::networkTimeBegin();
+  setTimezone(tz);
+}
+
+void Clock::setTimezone(const char *tz) {
+  const char *chosen = isValidTimezone(tz) ? tz : DEFAULT_TIMEZONE;
+  strncpy(tzText, chosen, sizeof(tzText) - 1);
+  tzText[sizeof(tzText) - 1] = '\0';
+  setenv("TZ", tzText, 1);
+  tzset();
+  cachedEpoch = 0;
+}
+
+const char *Clock::getTimezone() {
+  return tzText;
+}
+
+// En POSIX TZ-tekst indeholder kun synlige ASCII-tegn; alt andet stammer
+// fra et tomt eller gammelt lager.
+bool Clock::isValidTimezone(const char *text) {
+  size_t len = strnlen(text, TIMEZONE_SIZE);
+  if (len == 0 || len >= TIMEZONE_SIZE) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (text[i] <= ' ' || text[i] > '~') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Clock::waitForSync(unsigned long timeoutMs) {
+  uint64_t start = nowMs();
+  while (!isSynced() && nowMs() - start < timeoutMs) {
+    Hal::delay(50);
+  }
+  return isSynced();
+}
+
+uint64_t Clock::nowMs() {
+  return Hal::millis64();
+}
+
+unsigned long Clock::epoch() {
+  return Hal::epochTime();
+}
+
+bool Clock::isSynced() {
+  return epoch() != 0;
+}
+
+const String &Clock::localTimeString() {
+  unsigned long now = epoch();
+  if (now != cachedEpoch) {
+    cachedEpoch = now;
+    cachedTime = formatLocal(now);
+  }
+  return cachedTime;
+}
+
+String Clock::formatLocal(unsigned long epochUtc) {
+  if (epochUtc == 0) {
+    return "--:--:--";
+  }
+  time_t t = static_cast<time_t>(epochUtc);
+  struct tm local;
+  localtime_r(&t, &local);
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%02d:%02d:%02d", local.tm_hour, local.tm_min, local.tm_sec);
+  return String(buf);
+}
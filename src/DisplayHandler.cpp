@@ -17,6 +17,8 @@ static Adafruit_SSD1306 display(128, 64, &Wire, OLED_RESET);
 
 namespace {
   unsigned long lastUpdate = 0;
+  // Med flere kar end linjer skiftes der mellem dem.
+  constexpr unsigned long VESSEL_ROTATE_MS = 2000;
   
   void drawText(const String &text, int16_t x, int16_t y, uint8_t size = 1) {
     display.setCursor(x, y);
@@ -45,11 +47,13 @@ void DisplayHandler::showMessage(const String &msg) {
  * Update OLED-displayet med følgende layout:
  * - Linje 0: Venstre: processStep (fx "Mæskning", "Venter på kogepunkt" osv.)
  *          Højre: et status-symbol (f.eks. ">>", "||" eller "[ ]")
- * - Linje 1: Resterende tid i mm:ss-format.
+ * - Linje 1: Resterende tid i mm:ss-format (under opvarmning: "ETA" til setpoint).
  * - Linje 2: Grydetemperatur.
  * - Linje 3: Ventiltemperatur (hvis showVentil er true, ellers tomt).
+ * - Linje 4: Et af de ekstra kar (skifter hvert VESSEL_ROTATE_MS): navn,
+ *            temperatur/mål og '*', mens det varmer.
  */
-void DisplayHandler::update(float tGryde, float tVentil, bool showVentil, const String &processStep, unsigned long remainingTime) {
+void DisplayHandler::update(TempRaw tGryde, TempRaw tVentil, bool showVentil, const String &processStep, unsigned long remainingTime) {
   unsigned long now = millis();
   if (now - lastUpdate < 500)
     return;
@@ -61,29 +65,57 @@ void DisplayHandler::update(float tGryde, float tVentil, bool showVentil, const
   
   // Linje 0: ProcessStep og status-symbol
   drawText(processStep, 0, 0, 1);
-  String symbol = ProcessHandler::getProcessSymbol();
+  String symbol = ProcessHandler::kettle().getProcessSymbol();
   drawText(symbol, 100, 0, 1);
   
-  // Linje 1: Resterende tid i mm:ss-format
-  uint16_t mm = remainingTime / 60;
-  uint16_t ss = remainingTime % 60;
+  // Linje 1: Resterende tid i mm:ss-format – eller, før nedtællingen er
+  // startet, modellens bud på tiden til setpoint.
+  long eta = ProcessHandler::kettle().getSetpointEta();
+  unsigned long shownTime = eta >= 0 ? static_cast<unsigned long>(eta) : remainingTime;
+  uint16_t mm = shownTime / 60;
+  uint16_t ss = shownTime % 60;
   char timeBuf[16];
   snprintf(timeBuf, sizeof(timeBuf), "%02u:%02u", mm, ss);
   display.setFont(&FreeSans9pt7b);
-  drawText("Tid: " + String(timeBuf), 0, 27, 1);
+  drawText(String(eta >= 0 ? "ETA: " : "Tid: ") + timeBuf, 0, 27, 1);
   display.setFont(); // Standardfonten (typisk 5x7)
   
   // Linje 2: Grydetemperatur
+  char tempBuf[12];
   drawText("Gryde:", 0, 38, 1);
-  drawText(String(tGryde, 1) + " C", 48, 38, 1);
+  formatTempRaw(tGryde, tempBuf, sizeof(tempBuf));
+  drawText(String(tempBuf) + " C", 48, 38, 1);
   
   // Linje 3: Ventiltemperatur (vises kun, hvis showVentil er true)
   drawText("Ventil: ", 0, 48, 1);
   if (showVentil) {
-    drawText(String(tVentil, 1) + " C", 48, 48, 1);
+    formatTempRaw(tVentil, tempBuf, sizeof(tempBuf));
+    drawText(String(tempBuf) + " C", 48, 48, 1);
   } else {
     drawText("     ", 48, 48, 1);
   }
+
+  // Linje 4: De øvrige kar på skift
+  uint8_t others = ProcessHandler::getVesselCount() - 1;
+  if (others > 0) {
+    uint8_t index = (now / VESSEL_ROTATE_MS) % others;
+    if (index >= KETTLE_VESSEL) {
+      index++;
+    }
+    const Vessel &vessel = ProcessHandler::getVessel(index);
+    char targetBuf[12];
+    formatTempRaw(vessel.getTemp(), tempBuf, sizeof(tempBuf));
+    formatTempRaw(vessel.getTarget(), targetBuf, sizeof(targetBuf));
+    char line[32];
+    snprintf(line, sizeof(line), "%s:", vessel.getName());
+    drawText(line, 0, 57, 1);
+    if (vessel.isActive()) {
+      snprintf(line, sizeof(line), "%s/%s C%s", tempBuf, targetBuf, vessel.isHeating() ? " *" : "");
+    } else {
+      snprintf(line, sizeof(line), "%s C (fra)", tempBuf);
+    }
+    drawText(line, 48, 57, 1);
+  }
   
   display.display();
 }
@@ -1,20 +1,466 @@
 #include "EEPROMHandler.h"
-#include <EEPROM.h>
+#include "Hal.h"
+#include "OneWireBus.h"  // crc8
+#include "ProcessJournal.h"
 #include <Arduino.h>
 
-#define EEPROM_SIZE 512
+#define EEPROM_SIZE 2048
 #define EEPROM_CONFIG_START 0
+// Efter Config (0) og grydens proces state (256). Fra 640 ligger grydens
+// fremdriftsjournal (ProcessJournal.h), fra 1024 de øvrige kar (Vessel.h) og
+// fra 1280 deres fremdriftsjournaler.
+#define EEPROM_SCHEDULE_START 320
+#define EEPROM_ADDITIONS_START 384
+#define EEPROM_RELAYS_START 960
+#define EEPROM_VESSELS_START 1024
 
 Config EEPROMHandler::config;
+MashSchedule EEPROMHandler::schedule;
+BoilAdditions EEPROMHandler::additions;
+RelayActuator::Counters EEPROMHandler::gasCounters = {0, 0};
+RelayActuator::Counters EEPROMHandler::pumpCounters = {0, 0};
+EEPROMHandler::VesselRecord EEPROMHandler::vessels[VESSEL_COUNT];
+
+namespace {
+    constexpr float DEFAULT_PID_KP = 40.0f;
+    constexpr float DEFAULT_PID_KI = 0.05f;
+    constexpr float DEFAULT_PID_KD = 1200.0f;
+    constexpr unsigned long DEFAULT_PID_WINDOW = 60;
+    constexpr unsigned long MAX_PID_WINDOW = 600;
+
+    bool isValidPid(float kp, float ki, float kd, unsigned long window) {
+        return kp > 0.0f && ki >= 0.0f && kd >= 0.0f && isfinite(kp) && isfinite(ki) && isfinite(kd) &&
+               window > 0 && window <= MAX_PID_WINDOW;
+    }
+
+    // PID-felterne kom til efter de første firmwareversioner, så en gemt
+    // config kan have 0 eller tilfældige bytes her. Ugyldige gains erstattes.
+    bool sanitizePid(Config &cfg) {
+        bool valid = isValidPid(cfg.pidKp, cfg.pidKi, cfg.pidKd, cfg.pidWindow);
+        if (!valid) {
+            cfg.pidKp = DEFAULT_PID_KP;
+            cfg.pidKi = DEFAULT_PID_KI;
+            cfg.pidKd = DEFAULT_PID_KD;
+            cfg.pidWindow = DEFAULT_PID_WINDOW;
+        }
+        return valid;
+    }
+
+    constexpr float DEFAULT_BOIL_ALTITUDE = 0.0f;
+    constexpr float DEFAULT_BOIL_THRESHOLD = 3.0f;
+    constexpr float MIN_BOIL_ALTITUDE = -500.0f;
+    constexpr float MAX_BOIL_ALTITUDE = 5000.0f;
+    constexpr float MAX_BOIL_THRESHOLD = 10.0f;
+
+    // Kogepunktsfelterne kom til efter tidszonen; ugyldige værdier erstattes hver for sig.
+    bool sanitizeBoil(Config &cfg) {
+        bool valid = true;
+        if (!(cfg.boilAltitude >= MIN_BOIL_ALTITUDE && cfg.boilAltitude <= MAX_BOIL_ALTITUDE)) {
+            cfg.boilAltitude = DEFAULT_BOIL_ALTITUDE;
+            valid = false;
+        }
+        if (!(cfg.boilThreshold > 0.0f && cfg.boilThreshold <= MAX_BOIL_THRESHOLD)) {
+            cfg.boilThreshold = DEFAULT_BOIL_THRESHOLD;
+            valid = false;
+        }
+        return valid;
+    }
+
+    constexpr uint8_t SCHEDULE_MAGIC = 0xA5;
+
+    // 5 bytes pr. trin; CRC'en fanger både en tom EEPROM og halvt skrevne planer.
+    struct StoredSchedule {
+        uint8_t magic;
+        uint8_t count;
+        uint8_t steps[MashSchedule::MAX_STEPS][MashSchedule::STORED_STEP_SIZE];
+        uint8_t crc;  // OneWire-CRC8 over de foregående bytes
+    };
+    static_assert(EEPROM_SCHEDULE_START + sizeof(StoredSchedule) <= EEPROM_SIZE, "Mæskeplanen er for stor til EEPROM");
+
+    static_assert(EEPROM_SCHEDULE_START + sizeof(StoredSchedule) <= EEPROM_ADDITIONS_START, "Mæskeplanen overlapper tilsætningerne");
+
+    uint8_t storedCrc(const StoredSchedule &stored) {
+        return OneWireBus::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(StoredSchedule, crc));
+    }
+
+    constexpr uint8_t ADDITIONS_MAGIC = 0xB7;
+
+    struct StoredAdditions {
+        uint8_t magic;
+        uint8_t count;
+        uint8_t items[BoilAdditions::MAX_ADDITIONS][BoilAdditions::STORED_ADDITION_SIZE];
+        uint8_t crc;
+    };
+    static_assert(EEPROM_ADDITIONS_START + sizeof(StoredAdditions) <= EEPROM_SIZE, "Tilsætningerne er for store til EEPROM");
+    static_assert(offsetof(StoredAdditions, crc) <= 255, "crc8() tager højst 255 bytes");
+    static_assert(EEPROM_ADDITIONS_START + sizeof(StoredAdditions) <= ProcessJournal::STORAGE_START,
+                  "Tilsætningerne overlapper fremdriftsjournalen");
+
+    uint8_t storedCrc(const StoredAdditions &stored) {
+        return OneWireBus::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(StoredAdditions, crc));
+    }
+
+    constexpr uint8_t RELAYS_MAGIC = 0xD2;
+
+    // Magic efter tællerne, så der ikke er fyld inden for CRC'en.
+    struct StoredRelays {
+        RelayActuator::Counters gas;
+        RelayActuator::Counters pump;
+        uint8_t magic;
+        uint8_t crc;
+    };
+    static_assert(ProcessJournal::STORAGE_END <= EEPROM_RELAYS_START, "Relætællerne overlapper fremdriftsjournalen");
+    static_assert(EEPROM_RELAYS_START + sizeof(StoredRelays) <= EEPROM_SIZE, "Relætællerne er for store til EEPROM");
+
+    uint8_t storedCrc(const StoredRelays &stored) {
+        return OneWireBus::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(StoredRelays, crc));
+    }
+
+    // De øvrige kar (alle undtagen gryden) ligger efter hinanden fra
+    // EEPROM_VESSELS_START. Version 1 (0xE1) var en termostat med ét mål og
+    // relætællere; den læses som en plan, der holder målet.
+    constexpr uint8_t VESSEL_MAGIC = 0xE2;
+    constexpr uint8_t LEGACY_VESSEL_MAGIC = 0xE1;
+    constexpr float DEFAULT_VESSEL_TARGET = 78.0f;  // Skyllevand
+    // Den faste mæskeplan for et kar ud over gryden: ét trin, der varmer op og
+    // holdes uden pumpe og uden bekræftelser.
+    constexpr const char *DEFAULT_VESSEL_SCHEDULE = "78,0,G";
+    constexpr float DEFAULT_VESSEL_HYSTERESIS = 0.5f;
+
+    struct StoredVessel {
+        RelayActuator::Counters heat;
+        RelayActuator::Counters pump;
+        float pidKp;
+        float pidKi;
+        float pidKd;
+        uint32_t pidWindow;
+        uint8_t count;
+        uint8_t steps[MashSchedule::MAX_STEPS][MashSchedule::STORED_STEP_SIZE];
+        uint8_t magic;
+        uint8_t crc;
+    };
+    static_assert(offsetof(StoredVessel, crc) <= 255, "crc8() tager højst 255 bytes");
+
+    struct LegacyStoredVessel {
+        RelayActuator::Counters counters;
+        TempRaw target;
+        uint8_t enabled;
+        uint8_t magic;
+        uint8_t crc;
+    };
+
+    static_assert(KETTLE_VESSEL == 0, "Karrenes pladser i EEPROM regner med, at gryden er kar 0");
+    static_assert(EEPROM_RELAYS_START + sizeof(StoredRelays) <= EEPROM_VESSELS_START, "Relætællerne overlapper karrene");
+    static_assert(EEPROM_VESSELS_START + (VESSEL_COUNT - 1) * sizeof(StoredVessel) <=
+                      ProcessJournal::EXTRA_STORAGE_START,
+                  "Karrene overlapper deres fremdriftsjournaler");
+    static_assert(ProcessJournal::storageStart(VESSEL_COUNT - 1) + ProcessJournal::STORAGE_SIZE <= EEPROM_SIZE,
+                  "Karrenes fremdriftsjournaler er for store til EEPROM");
+
+    uint8_t storedCrc(const StoredVessel &stored) {
+        return OneWireBus::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(StoredVessel, crc));
+    }
+
+    uint8_t storedCrc(const LegacyStoredVessel &stored) {
+        return OneWireBus::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(LegacyStoredVessel, crc));
+    }
+
+    int vesselAddress(uint8_t index) {
+        return EEPROM_VESSELS_START + (index - 1) * sizeof(StoredVessel);
+    }
+
+    MashSchedule defaultVesselSchedule() {
+        MashSchedule schedule;
+        schedule.parse(DEFAULT_VESSEL_SCHEDULE);
+        return schedule;
+    }
+}
 
 void EEPROMHandler::begin() {
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.get(EEPROM_CONFIG_START, config);
+    Hal::storageBegin(EEPROM_SIZE);
+    Hal::storageGet(EEPROM_CONFIG_START, config);
     // Hvis ssid er tom, antages der, at config ikke er blevet initialiseret korrekt.
     if (config.ssid[0] == '\0') {
         resetToDefaults();
         save();
+    } else if (!sanitizePid(config)) {
+        Serial.println("[EEPROMHandler] PID-parametre mangler – bruger standardværdier.");
+        save();
+    }
+    // Tidszonen kom til senere end PID-felterne og kontrolleres for sig.
+    if (!Clock::isValidTimezone(config.timezone)) {
+        strncpy(config.timezone, Clock::DEFAULT_TIMEZONE, sizeof(config.timezone));
+        save();
+    }
+    if (!sanitizeBoil(config)) {
+        Serial.println("[EEPROMHandler] Kogepunktsindstillinger mangler – bruger standardværdier.");
+        save();
+    }
+    if (!loadSchedule()) {
+        // Første opstart med mæskeplaner: planen dannes ud fra de gamle felter.
+        MashSchedule legacy = MashSchedule::makeDefault(config.mashSetpoint, config.mashTime, config.mashoutSetpoint,
+                                                        config.mashoutTime);
+        if (!legacy.isValid()) {
+            legacy = MashSchedule::makeDefault(64.0f, 90 * 60, 75.0f, 10 * 60);
+        }
+        Serial.println("[EEPROMHandler] Ingen gyldig mæskeplan – danner den ud fra indstillingerne.");
+        saveSchedule(legacy);
+    }
+    // Ingen gemte tilsætninger (fx en tom EEPROM) er blot en tom liste.
+    loadAdditions();
+    // Det samme gælder relætællerne, der så starter fra 0, og de øvrige kar,
+    // der får standardplanen og standard-PID.
+    loadRelayCounters();
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+        if (i != KETTLE_VESSEL && !loadVessel(i)) {
+            vessels[i] = {{0, 0}, {0, 0}, DEFAULT_PID_KP, DEFAULT_PID_KI, DEFAULT_PID_KD, DEFAULT_PID_WINDOW,
+                          defaultVesselSchedule()};
+        }
+    }
+}
+
+bool EEPROMHandler::loadSchedule() {
+    StoredSchedule stored;
+    Hal::storageGet(EEPROM_SCHEDULE_START, stored);
+    if (stored.magic != SCHEDULE_MAGIC || stored.crc != storedCrc(stored) || stored.count > MashSchedule::MAX_STEPS) {
+        return false;
+    }
+    MashSchedule loaded;
+    loaded.count = stored.count;
+    for (uint8_t i = 0; i < stored.count; i++) {
+        if (!loaded.unpackStep(i, stored.steps[i])) {
+            return false;
+        }
     }
+    if (!loaded.isValid()) {
+        return false;
+    }
+    schedule = loaded;
+    return true;
+}
+
+MashSchedule EEPROMHandler::getSchedule() {
+    return schedule;
+}
+
+void EEPROMHandler::saveSchedule(const MashSchedule &newSchedule) {
+    if (!newSchedule.isValid()) {
+        return;
+    }
+    schedule = newSchedule;
+    StoredSchedule stored = {};
+    stored.magic = SCHEDULE_MAGIC;
+    stored.count = schedule.count;
+    for (uint8_t i = 0; i < schedule.count; i++) {
+        schedule.packStep(i, stored.steps[i]);
+    }
+    stored.crc = storedCrc(stored);
+    Hal::storagePut(EEPROM_SCHEDULE_START, stored);
+    Hal::storageCommit();
+}
+
+bool EEPROMHandler::loadAdditions() {
+    StoredAdditions stored;
+    Hal::storageGet(EEPROM_ADDITIONS_START, stored);
+    if (stored.magic != ADDITIONS_MAGIC || stored.crc != storedCrc(stored) || stored.count > BoilAdditions::MAX_ADDITIONS) {
+        return false;
+    }
+    BoilAdditions loaded;
+    loaded.count = stored.count;
+    for (uint8_t i = 0; i < stored.count; i++) {
+        loaded.unpack(i, stored.items[i]);
+    }
+    if (!loaded.isValid()) {
+        return false;
+    }
+    additions = loaded;
+    return true;
+}
+
+BoilAdditions EEPROMHandler::getAdditions() {
+    return additions;
+}
+
+void EEPROMHandler::saveAdditions(const BoilAdditions &newAdditions) {
+    if (!newAdditions.isValid()) {
+        return;
+    }
+    additions = newAdditions;
+    StoredAdditions stored = {};
+    stored.magic = ADDITIONS_MAGIC;
+    stored.count = additions.count;
+    for (uint8_t i = 0; i < additions.count; i++) {
+        additions.pack(i, stored.items[i]);
+    }
+    stored.crc = storedCrc(stored);
+    Hal::storagePut(EEPROM_ADDITIONS_START, stored);
+    Hal::storageCommit();
+}
+
+bool EEPROMHandler::loadRelayCounters() {
+    StoredRelays stored;
+    Hal::storageGet(EEPROM_RELAYS_START, stored);
+    if (stored.magic != RELAYS_MAGIC || stored.crc != storedCrc(stored)) {
+        return false;
+    }
+    gasCounters = stored.gas;
+    pumpCounters = stored.pump;
+    return true;
+}
+
+void EEPROMHandler::getRelayCounters(uint8_t index, RelayActuator::Counters &heat, RelayActuator::Counters &pump) {
+    if (index == KETTLE_VESSEL || index >= VESSEL_COUNT) {
+        heat = gasCounters;
+        pump = pumpCounters;
+        return;
+    }
+    heat = vessels[index].heat;
+    pump = vessels[index].pump;
+}
+
+void EEPROMHandler::saveRelayCounters(uint8_t index, const RelayActuator::Counters &heat,
+                                      const RelayActuator::Counters &pump) {
+    if (index >= VESSEL_COUNT) {
+        return;
+    }
+    if (index != KETTLE_VESSEL) {
+        vessels[index].heat = heat;
+        vessels[index].pump = pump;
+        saveVessel(index);
+        return;
+    }
+    gasCounters = heat;
+    pumpCounters = pump;
+    StoredRelays stored = {};
+    stored.gas = heat;
+    stored.pump = pump;
+    stored.magic = RELAYS_MAGIC;
+    stored.crc = storedCrc(stored);
+    Hal::storagePut(EEPROM_RELAYS_START, stored);
+    Hal::storageCommit();
+}
+
+bool EEPROMHandler::loadVessel(uint8_t index) {
+    StoredVessel stored;
+    Hal::storageGet(vesselAddress(index), stored);
+    if (stored.magic == VESSEL_MAGIC && stored.crc == storedCrc(stored) && stored.count <= MashSchedule::MAX_STEPS) {
+        VesselRecord loaded = {stored.heat, stored.pump, stored.pidKp, stored.pidKi, stored.pidKd, stored.pidWindow,
+                               MashSchedule()};
+        loaded.schedule.count = stored.count;
+        for (uint8_t i = 0; i < stored.count; i++) {
+            if (!loaded.schedule.unpackStep(i, stored.steps[i])) {
+                return false;
+            }
+        }
+        if (!loaded.schedule.isValid()) {
+            return false;
+        }
+        if (!isValidPid(loaded.pidKp, loaded.pidKi, loaded.pidKd, loaded.pidWindow)) {
+            loaded.pidKp = DEFAULT_PID_KP;
+            loaded.pidKi = DEFAULT_PID_KI;
+            loaded.pidKd = DEFAULT_PID_KD;
+            loaded.pidWindow = DEFAULT_PID_WINDOW;
+        }
+        vessels[index] = loaded;
+        return true;
+    }
+
+    // Termostaten fra før: målet bliver planens trin, og tællerne bevares.
+    LegacyStoredVessel legacy;
+    Hal::storageGet(vesselAddress(index), legacy);
+    if (legacy.magic != LEGACY_VESSEL_MAGIC || legacy.crc != storedCrc(legacy)) {
+        return false;
+    }
+    MashSchedule schedule = defaultVesselSchedule();
+    schedule.first().target = legacy.target;
+    if (!schedule.isValid()) {
+        schedule = defaultVesselSchedule();
+    }
+    vessels[index] = {legacy.counters, {0, 0}, DEFAULT_PID_KP, DEFAULT_PID_KI, DEFAULT_PID_KD, DEFAULT_PID_WINDOW,
+                      schedule};
+    Serial.printf("[EEPROMHandler] %s: termostatens mål %s °C overtaget som mæskeplan.\n", VESSEL_PINS[index].name,
+                  tempRawToString(legacy.target).c_str());
+    saveVessel(index);
+    return true;
+}
+
+void EEPROMHandler::saveVessel(uint8_t index) {
+    const VesselRecord &vessel = vessels[index];
+    StoredVessel stored = {};
+    stored.heat = vessel.heat;
+    stored.pump = vessel.pump;
+    stored.pidKp = vessel.pidKp;
+    stored.pidKi = vessel.pidKi;
+    stored.pidKd = vessel.pidKd;
+    stored.pidWindow = vessel.pidWindow;
+    stored.count = vessel.schedule.count;
+    for (uint8_t i = 0; i < vessel.schedule.count; i++) {
+        vessel.schedule.packStep(i, stored.steps[i]);
+    }
+    stored.magic = VESSEL_MAGIC;
+    stored.crc = storedCrc(stored);
+    Hal::storagePut(vesselAddress(index), stored);
+    Hal::storageCommit();
+}
+
+Vessel::Settings EEPROMHandler::getVesselSettings(uint8_t index) {
+    Vessel::Settings settings;
+    if (index == KETTLE_VESSEL || index >= VESSEL_COUNT) {
+        settings.schedule = schedule;
+        settings.additions = additions;
+        settings.boilTime = config.boilTime;
+        settings.hysteresis = config.hysteresis;
+        settings.valveOffset = config.tempOffset;
+        settings.pidKp = config.pidKp;
+        settings.pidKi = config.pidKi;
+        settings.pidKd = config.pidKd;
+        settings.pidWindow = config.pidWindow;
+        settings.boilAltitude = config.boilAltitude;
+        settings.boilThreshold = config.boilThreshold;
+        return settings;
+    }
+    const VesselRecord &vessel = vessels[index];
+    settings.schedule = vessel.schedule;
+    settings.boilTime = 60 * 60;
+    settings.hysteresis = DEFAULT_VESSEL_HYSTERESIS;
+    settings.valveOffset = 0.0f;
+    settings.pidKp = vessel.pidKp;
+    settings.pidKi = vessel.pidKi;
+    settings.pidKd = vessel.pidKd;
+    settings.pidWindow = vessel.pidWindow;
+    settings.boilAltitude = DEFAULT_BOIL_ALTITUDE;
+    settings.boilThreshold = DEFAULT_BOIL_THRESHOLD;
+    return settings;
+}
+
+void EEPROMHandler::saveVesselSchedule(uint8_t index, const MashSchedule &newSchedule) {
+    if (index == KETTLE_VESSEL) {
+        saveSchedule(newSchedule);
+        return;
+    }
+    if (index >= VESSEL_COUNT || !newSchedule.isValid()) {
+        return;
+    }
+    vessels[index].schedule = newSchedule;
+    saveVessel(index);
+}
+
+void EEPROMHandler::saveVesselGains(uint8_t index, float kp, float ki, float kd) {
+    if (index == KETTLE_VESSEL) {
+        Config cfg = config;
+        cfg.pidKp = kp;
+        cfg.pidKi = ki;
+        cfg.pidKd = kd;
+        saveConfig(cfg);
+        return;
+    }
+    if (index >= VESSEL_COUNT || !isValidPid(kp, ki, kd, vessels[index].pidWindow)) {
+        return;
+    }
+    vessels[index].pidKp = kp;
+    vessels[index].pidKi = ki;
+    vessels[index].pidKd = kd;
+    saveVessel(index);
 }
 
 Config EEPROMHandler::getConfig() {
@@ -31,17 +477,42 @@ String EEPROMHandler::getConfigAsString() {
     s += "Subnet: "; s += config.sn; s += "\n";
     s += "TempOffset: "; s += String(config.tempOffset); s += "\n";
     s += "Hysteresis: "; s += String(config.hysteresis); s += "\n";
-    s += "MashTime: "; s += String(config.mashTime); s += "\n";
-    s += "MashoutTime: "; s += String(config.mashoutTime); s += "\n";
+    s += "MashSchedule: "; s += schedule.toString(); s += "\n";
     s += "BoilTime: "; s += String(config.boilTime); s += "\n";
-    s += "MashSetpoint: "; s += String(config.mashSetpoint); s += "\n";
-    s += "MashoutSetpoint: "; s += String(config.mashoutSetpoint); s += "\n";
+    s += "BoilAdditions: "; s += additions.toString(); s += "\n";
+    s += "PID Kp: "; s += String(config.pidKp, 3); s += "\n";
+    s += "PID Ki: "; s += String(config.pidKi, 4); s += "\n";
+    s += "PID Kd: "; s += String(config.pidKd, 1); s += "\n";
+    s += "PID Window: "; s += String(config.pidWindow); s += "\n";
+    s += "Timezone: "; s += config.timezone; s += "\n";
+    s += "Boil altitude: "; s += String(config.boilAltitude, 0); s += " m, threshold ";
+    s += String(config.boilThreshold, 1); s += " °C\n";
+    s += "Gas relay (saved): "; s += String(gasCounters.cycles); s += " cycles, ";
+    s += String(gasCounters.onSeconds); s += " s on\n";
+    s += "Pump relay (saved): "; s += String(pumpCounters.cycles); s += " cycles, ";
+    s += String(pumpCounters.onSeconds); s += " s on\n";
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+        if (i == KETTLE_VESSEL) {
+            continue;
+        }
+        const VesselRecord &vessel = vessels[i];
+        s += VESSEL_PINS[i].name; s += ": "; s += vessel.schedule.toString();
+        s += ", PID "; s += String(vessel.pidKp, 3); s += "/"; s += String(vessel.pidKi, 4); s += "/";
+        s += String(vessel.pidKd, 1); s += ", window "; s += String(vessel.pidWindow); s += " s, ";
+        s += String(vessel.heat.cycles); s += " cycles, ";
+        s += String(vessel.heat.onSeconds); s += " s on\n";
+    }
     return s;
 }
   
 
 void EEPROMHandler::saveConfig(const Config &cfg) {
     config = cfg;
+    sanitizePid(config);
+    if (!Clock::isValidTimezone(config.timezone)) {
+        strncpy(config.timezone, Clock::DEFAULT_TIMEZONE, sizeof(config.timezone));
+    }
+    sanitizeBoil(config);
     save();
 }
 
@@ -50,7 +521,9 @@ void EEPROMHandler::resetToDefaults() {
     // ssid, password, ip, gw, sn,
     // tempOffset, hysteresis,
     // mashTime, mashoutTime, boilTime,
-    // mashSetpoint, mashoutSetpoint
+    // mashSetpoint, mashoutSetpoint,
+    // pidKp, pidKi, pidKd, pidWindow, timezone,
+    // boilAltitude, boilThreshold
     Config cfg = {
         "",                 // ssid
         "",                 // password
@@ -63,12 +536,22 @@ void EEPROMHandler::resetToDefaults() {
         10 * 60,            // mashoutTime (10 minutter)
         60 * 60,            // boilTime (60 minutter)
         64.0,               // mashSetpoint (°C)
-        75.0                // mashoutSetpoint (°C)
+        75.0,               // mashoutSetpoint (°C)
+        DEFAULT_PID_KP,     // pidKp
+        DEFAULT_PID_KI,     // pidKi
+        DEFAULT_PID_KD,     // pidKd
+        DEFAULT_PID_WINDOW, // pidWindow (sekunder)
+        "",                 // timezone (sættes nedenfor)
+        DEFAULT_BOIL_ALTITUDE,  // boilAltitude (m)
+        DEFAULT_BOIL_THRESHOLD  // boilThreshold (°C)
     };
+    strncpy(cfg.timezone, Clock::DEFAULT_TIMEZONE, sizeof(cfg.timezone));
     saveConfig(cfg);
+    saveSchedule(MashSchedule::makeDefault(cfg.mashSetpoint, cfg.mashTime, cfg.mashoutSetpoint, cfg.mashoutTime));
+    saveAdditions(BoilAdditions());
 }
 
 void EEPROMHandler::save() {
-    EEPROM.put(EEPROM_CONFIG_START, config);
-    EEPROM.commit();
+    Hal::storagePut(EEPROM_CONFIG_START, config);
+    Hal::storageCommit();
 }
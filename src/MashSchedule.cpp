@@ -0,0 +1,146 @@
+#include "MashSchedule.h"
+#include <Arduino.h>
+#include <stdlib.h>
+
+namespace {
+  // Samme grænser som autotuningens setpoint.
+  constexpr TempRaw MIN_TARGET = tempRawFromC(20.0f);
+  constexpr TempRaw MAX_TARGET = tempRawFromC(90.0f);
+
+  constexpr uint8_t FLAG_PUMP = 0x01;
+  constexpr uint8_t FLAG_GAS = 0x02;
+  constexpr uint8_t FLAG_CONFIRM_START = 0x04;
+  constexpr uint8_t FLAG_CONFIRM_END = 0x08;
+  constexpr uint8_t FLAG_ALL = FLAG_PUMP | FLAG_GAS | FLAG_CONFIRM_START | FLAG_CONFIRM_END;
+
+  uint8_t stepFlags(const MashStep &step) {
+    return (step.pump == PumpMode::ON ? FLAG_PUMP : 0) | (step.gas == GasPolicy::REGULATE ? FLAG_GAS : 0) |
+           (step.confirmStart ? FLAG_CONFIRM_START : 0) | (step.confirmEnd ? FLAG_CONFIRM_END : 0);
+  }
+
+  void applyFlags(MashStep &step, uint8_t flags) {
+    step.pump = flags & FLAG_PUMP ? PumpMode::ON : PumpMode::OFF;
+    step.gas = flags & FLAG_GAS ? GasPolicy::REGULATE : GasPolicy::OFF;
+    step.confirmStart = flags & FLAG_CONFIRM_START;
+    step.confirmEnd = flags & FLAG_CONFIRM_END;
+  }
+
+  MashStep makeStep(float targetC, unsigned long seconds) {
+    MashStep step = {tempRawFromC(targetC), static_cast<uint16_t>(seconds / 60), PumpMode::ON, GasPolicy::REGULATE,
+                     true, true};
+    return step;
+  }
+}
+
+MashSchedule MashSchedule::makeDefault(float mashC, unsigned long mashS, float mashoutC, unsigned long mashoutS) {
+  MashSchedule schedule;
+  schedule.steps[schedule.count++] = makeStep(mashC, mashS);
+  schedule.steps[schedule.count++] = makeStep(mashoutC, mashoutS);
+  return schedule;
+}
+
+bool MashSchedule::isValid() const {
+  if (count == 0 || count > MAX_STEPS) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    const MashStep &step = steps[i];
+    if (step.target < MIN_TARGET || step.target > MAX_TARGET || step.minutes > MAX_MINUTES) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MashSchedule::parse(const char *text) {
+  MashSchedule parsed;
+  const char *p = text;
+  while (*p) {
+    if (parsed.count >= MAX_STEPS) {
+      return false;
+    }
+    char *end;
+    float targetC = strtof(p, &end);
+    if (end == p || *end != ',' || !(targetC >= tempRawToC(MIN_TARGET) && targetC <= tempRawToC(MAX_TARGET))) {
+      return false;
+    }
+    p = end + 1;
+    long minutes = strtol(p, &end, 10);
+    if (end == p || minutes < 0 || minutes > MAX_MINUTES) {
+      return false;
+    }
+    p = end;
+
+    MashStep step = makeStep(targetC, minutes * 60);
+    if (*p == ',') {
+      uint8_t flags = 0;
+      for (p++; *p && *p != ';'; p++) {
+        switch (*p) {
+          case 'P': case 'p': flags |= FLAG_PUMP; break;
+          case 'G': case 'g': flags |= FLAG_GAS; break;
+          case 'S': case 's': flags |= FLAG_CONFIRM_START; break;
+          case 'E': case 'e': flags |= FLAG_CONFIRM_END; break;
+          case '-': case ' ': break;
+          default: return false;
+        }
+      }
+      applyFlags(step, flags);
+    }
+    while (*p == ' ') {
+      p++;
+    }
+    if (*p == ';') {
+      p++;
+    } else if (*p) {
+      return false;
+    }
+    parsed.steps[parsed.count++] = step;
+  }
+  if (!parsed.isValid()) {
+    return false;
+  }
+  *this = parsed;
+  return true;
+}
+
+String MashSchedule::toString() const {
+  String text;
+  for (uint8_t i = 0; i < count; i++) {
+    const MashStep &step = steps[i];
+    if (i > 0) {
+      text += ";";
+    }
+    text += tempRawToString(step.target) + "," + String(step.minutes);
+    uint8_t flags = stepFlags(step);
+    if (flags != FLAG_ALL) {
+      text += ",";
+      if (flags == 0) text += "-";
+      if (flags & FLAG_PUMP) text += "P";
+      if (flags & FLAG_GAS) text += "G";
+      if (flags & FLAG_CONFIRM_START) text += "S";
+      if (flags & FLAG_CONFIRM_END) text += "E";
+    }
+  }
+  return text;
+}
+
+void MashSchedule::packStep(uint8_t index, uint8_t out[STORED_STEP_SIZE]) const {
+  const MashStep &step = steps[index];
+  uint16_t target = static_cast<uint16_t>(step.target);
+  out[0] = target & 0xFF;
+  out[1] = target >> 8;
+  out[2] = step.minutes & 0xFF;
+  out[3] = step.minutes >> 8;
+  out[4] = stepFlags(step);
+}
+
+bool MashSchedule::unpackStep(uint8_t index, const uint8_t in[STORED_STEP_SIZE]) {
+  if (in[4] & ~FLAG_ALL) {
+    return false;
+  }
+  MashStep &step = steps[index];
+  step.target = static_cast<TempRaw>(in[0] | (in[1] << 8));
+  step.minutes = in[2] | (in[3] << 8);
+  applyFlags(step, in[4]);
+  return true;
+}
@@ -0,0 +1,118 @@
+#include "PidController.h"
+#include <Arduino.h>
+
+namespace {
+  // Tidskonstant for lavpasfilteret på D-leddets hældning. Målingerne er
+  // allerede Kalman-filtrerede, så filteret skal kun tage toppen af
+  // kvantiseringen (1/16 °C) ved hurtig sampling.
+  constexpr float SLOPE_FILTER_TAU_S = 10.0f;
+  // Uden for dette bånd om setpoint integreres ikke. Under en lang opvarmning
+  // holder D-leddet ellers udgangen lige under mætning, så integralet når at
+  // vokse sig stort og giver oversving ved ankomst.
+  constexpr float INTEGRAL_BAND = 2.0f;
+}
+
+void PidController::setGains(float newKp, float newKi, float newKd) {
+  kp = newKp;
+  ki = newKi;
+  kd = newKd;
+}
+
+void PidController::setOutputLimits(float minOut, float maxOut) {
+  outMin = minOut;
+  outMax = maxOut;
+  integral = constrain(integral, outMin, outMax);
+}
+
+void PidController::reset() {
+  integral = 0.0f;
+  slope = 0.0f;
+  output = 0.0f;
+  initialized = false;
+}
+
+void PidController::trackMeasurement(float measurement, float dtS) {
+  if (!initialized) {
+    lastMeasurement = measurement;
+    slope = 0.0f;
+    initialized = true;
+    return;
+  }
+  if (dtS > 0.0f) {
+    float rawSlope = (measurement - lastMeasurement) / dtS;
+    slope += (rawSlope - slope) * dtS / (SLOPE_FILTER_TAU_S + dtS);
+  }
+  lastMeasurement = measurement;
+}
+
+float PidController::update(float setpoint, float measurement, float dtS) {
+  trackMeasurement(measurement, dtS);
+
+  float error = setpoint - measurement;
+  float p = kp * error;
+  float d = -kd * slope;
+
+  // Betinget integration: integrér kun tæt på setpoint, og kun hvis det ikke
+  // skubber en udgang, der allerede er i mætning, længere ud.
+  float candidate = integral + ki * error * dtS;
+  float unclamped = p + candidate + d;
+  bool saturatedHigh = unclamped > outMax && error > 0.0f;
+  bool saturatedLow = unclamped < outMin && error < 0.0f;
+  if (fabsf(error) <= INTEGRAL_BAND && !saturatedHigh && !saturatedLow) {
+    integral = constrain(candidate, outMin, outMax);
+  }
+
+  output = constrain(p + integral + d, outMin, outMax);
+  return output;
+}
+
+void PidController::hold(float measurement, float dtS) {
+  trackMeasurement(measurement, dtS);
+  output = outMin;
+}
+
+// ---------------------------------------------------------------------------
+// TimeProportioningOutput
+// ---------------------------------------------------------------------------
+void TimeProportioningOutput::configure(unsigned long newWindowMs, unsigned long newMinPulseMs) {
+  windowMs = newWindowMs;
+  minPulseMs = newMinPulseMs;
+}
+
+void TimeProportioningOutput::reset() {
+  started = false;
+  onTimeMs = 0;
+}
+
+unsigned long TimeProportioningOutput::pulseLength(float dutyPercent) const {
+  if (!(dutyPercent > 0.0f)) {
+    return 0;
+  }
+  if (dutyPercent >= 100.0f) {
+    return windowMs;
+  }
+  unsigned long onMs = static_cast<unsigned long>(dutyPercent * windowMs / 100.0f);
+  if (onMs < minPulseMs) {
+    return 0;
+  }
+  if (windowMs - onMs < minPulseMs) {
+    return windowMs;
+  }
+  return onMs;
+}
+
+bool TimeProportioningOutput::update(float dutyPercent, unsigned long nowMs) {
+  unsigned long target = pulseLength(dutyPercent);
+
+  if (!started || nowMs - windowStart >= windowMs) {
+    windowStart = nowMs;
+    onTimeMs = target;
+    started = true;
+  } else if (target < onTimeMs) {
+    // Afkort pulsen, men sluk ikke før minimumspulsen er gået.
+    unsigned long elapsed = nowMs - windowStart;
+    onTimeMs = max(target, min(onTimeMs, max(elapsed, minPulseMs)));
+  }
+
+  return nowMs - windowStart < onTimeMs;
+}
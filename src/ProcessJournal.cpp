@@ -0,0 +1,86 @@
+#include "ProcessJournal.h"
+#include "Hal.h"
+#include "OneWireBus.h"  // crc8
+
+namespace {
+  constexpr uint8_t JOURNAL_MAGIC = 0xC3;
+  constexpr uint8_t FLAG_TIMER_STARTED = 0x01;
+  constexpr uint8_t FLAG_BOILING_COMPLETE = 0x02;
+
+  // Lagerformatet: løbenummer, forløbet tid og epoch (little endian), derefter
+  // tilstandsbytes, magic og CRC8 over alt det foregående.
+  enum : uint8_t {
+    OFF_SEQUENCE = 0, OFF_ELAPSED = 4, OFF_EPOCH = 8, OFF_STATE = 12, OFF_PREVIOUS = 13, OFF_STEP = 14,
+    OFF_ADDITIONS = 15, OFF_FLAGS = 16, OFF_MAGIC = 17, OFF_CRC = 19
+  };
+  static_assert(OFF_CRC + 1 == ProcessJournal::SLOT_SIZE, "Journalpostens format passer ikke til SLOT_SIZE");
+
+  void put32(uint8_t *out, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+      out[i] = value >> (8 * i);
+    }
+  }
+
+  uint32_t get32(const uint8_t *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+  }
+}
+
+int ProcessJournal::slotAddress(uint32_t sequence) const {
+  return start + (sequence % SLOTS) * SLOT_SIZE;
+}
+
+void ProcessJournal::begin(int storageStart) {
+  start = storageStart;
+  hasEntry = false;
+  sequence = 0;
+  for (uint8_t i = 0; i < SLOTS; i++) {
+    uint8_t slot[SLOT_SIZE];
+    Hal::storageRead(start + i * SLOT_SIZE, slot, SLOT_SIZE);
+    if (slot[OFF_MAGIC] != JOURNAL_MAGIC || OneWireBus::crc8(slot, OFF_CRC) != slot[OFF_CRC]) {
+      continue;
+    }
+    uint32_t seq = get32(slot + OFF_SEQUENCE);
+    if (hasEntry && seq <= sequence) {
+      continue;
+    }
+    hasEntry = true;
+    sequence = seq;
+    last.state = slot[OFF_STATE];
+    last.previousState = slot[OFF_PREVIOUS];
+    last.stepIndex = slot[OFF_STEP];
+    last.additionsDone = slot[OFF_ADDITIONS];
+    last.timerStarted = slot[OFF_FLAGS] & FLAG_TIMER_STARTED;
+    last.boilingComplete = slot[OFF_FLAGS] & FLAG_BOILING_COMPLETE;
+    last.elapsedMs = get32(slot + OFF_ELAPSED);
+    last.epoch = get32(slot + OFF_EPOCH);
+  }
+}
+
+bool ProcessJournal::latest(JournalEntry &entry) const {
+  if (hasEntry) {
+    entry = last;
+  }
+  return hasEntry;
+}
+
+void ProcessJournal::append(const JournalEntry &entry) {
+  uint32_t next = hasEntry ? sequence + 1 : 0;
+  uint8_t slot[SLOT_SIZE] = {};
+  put32(slot + OFF_SEQUENCE, next);
+  put32(slot + OFF_ELAPSED, entry.elapsedMs);
+  put32(slot + OFF_EPOCH, entry.epoch);
+  slot[OFF_STATE] = entry.state;
+  slot[OFF_PREVIOUS] = entry.previousState;
+  slot[OFF_STEP] = entry.stepIndex;
+  slot[OFF_ADDITIONS] = entry.additionsDone;
+  slot[OFF_FLAGS] = (entry.timerStarted ? FLAG_TIMER_STARTED : 0) | (entry.boilingComplete ? FLAG_BOILING_COMPLETE : 0);
+  slot[OFF_MAGIC] = JOURNAL_MAGIC;
+  slot[OFF_CRC] = OneWireBus::crc8(slot, OFF_CRC);
+  Hal::storageWrite(slotAddress(next), slot, SLOT_SIZE);
+  Hal::storageCommit();
+  hasEntry = true;
+  sequence = next;
+  last = entry;
+  writes++;
+}
@@ -0,0 +1,802 @@
+#include "RecipeParser.h"
+#include <Arduino.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+  // FNV-1a over navne foldet til små bogstaver, så BeerXML's BOIL_TIME og
+  // BeerJSON's boil_time giver samme hash.
+  constexpr uint32_t FNV_OFFSET = 2166136261u;
+  constexpr uint32_t FNV_PRIME = 16777619u;
+
+  constexpr char lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+  constexpr uint32_t hashStep(uint32_t h, char c) {
+    return (h ^ static_cast<uint8_t>(lower(c))) * FNV_PRIME;
+  }
+  constexpr uint32_t keyHash(const char *s, uint32_t h = FNV_OFFSET) {
+    return *s ? keyHash(s + 1, hashStep(h, *s)) : h;
+  }
+
+  constexpr uint32_t H_RECIPES = keyHash("recipes");
+  constexpr uint32_t H_RECIPE = keyHash("recipe");
+  constexpr uint32_t H_BEERJSON = keyHash("beerjson");
+  constexpr uint32_t H_NAME = keyHash("name");
+  constexpr uint32_t H_BOIL = keyHash("boil");
+  constexpr uint32_t H_BOIL_TIME = keyHash("boil_time");
+  constexpr uint32_t H_MASH = keyHash("mash");
+  constexpr uint32_t H_MASH_STEPS = keyHash("mash_steps");
+  constexpr uint32_t H_MASH_STEP = keyHash("mash_step");
+  constexpr uint32_t H_STEP_TEMP = keyHash("step_temp");
+  constexpr uint32_t H_STEP_TEMPERATURE = keyHash("step_temperature");
+  constexpr uint32_t H_STEP_TIME = keyHash("step_time");
+  constexpr uint32_t H_TYPE = keyHash("type");
+  constexpr uint32_t H_HOPS = keyHash("hops");
+  constexpr uint32_t H_HOP = keyHash("hop");
+  constexpr uint32_t H_INGREDIENTS = keyHash("ingredients");
+  constexpr uint32_t H_HOP_ADDITIONS = keyHash("hop_additions");
+  constexpr uint32_t H_AMOUNT = keyHash("amount");
+  constexpr uint32_t H_USE = keyHash("use");
+  constexpr uint32_t H_TIME = keyHash("time");
+  constexpr uint32_t H_TIMING = keyHash("timing");
+  constexpr uint32_t H_VALUE = keyHash("value");
+  constexpr uint32_t H_UNIT = keyHash("unit");
+
+  constexpr uint32_t H_INFUSION = keyHash("infusion");
+  constexpr uint32_t H_DECOCTION = keyHash("decoction");
+  constexpr uint32_t H_USE_BOIL = keyHash("boil");
+  constexpr uint32_t H_USE_FIRST_WORT = keyHash("first wort");
+  constexpr uint32_t H_USE_AROMA = keyHash("aroma");
+  constexpr uint32_t H_ADD_TO_BOIL = keyHash("add_to_boil");
+
+  constexpr uint32_t H_UNIT_F = keyHash("f");
+  constexpr uint32_t H_UNIT_SEC = keyHash("sec");
+  constexpr uint32_t H_UNIT_S = keyHash("s");
+  constexpr uint32_t H_UNIT_MIN = keyHash("min");
+  constexpr uint32_t H_UNIT_HR = keyHash("hr");
+  constexpr uint32_t H_UNIT_H = keyHash("h");
+  constexpr uint32_t H_UNIT_DAY = keyHash("day");
+  constexpr uint32_t H_UNIT_WEEK = keyHash("week");
+  constexpr uint32_t H_UNIT_MG = keyHash("mg");
+  constexpr uint32_t H_UNIT_G = keyHash("g");
+  constexpr uint32_t H_UNIT_KG = keyHash("kg");
+  constexpr uint32_t H_UNIT_OZ = keyHash("oz");
+  constexpr uint32_t H_UNIT_LB = keyHash("lb");
+
+  // Lexer-tilstande. DETECT venter på første tegn; resten er pr. format.
+  enum : uint8_t {
+    DETECT,
+    X_TEXT, X_ENTITY, X_TAG, X_OPEN_NAME, X_ATTRS, X_ATTR_QUOTE, X_SELF_CLOSE, X_CLOSE_NAME, X_CLOSE_TAIL,
+    X_BANG, X_COMMENT, X_CDATA_OPEN, X_CDATA, X_DOCTYPE, X_PI,
+    J_VALUE, J_KEY, J_COLON, J_AFTER, J_STRING, J_ESCAPE, J_UNICODE, J_NUMBER, J_LITERAL, J_DONE
+  };
+
+  bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  bool isNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' ||
+           c == '.' || c == ':' || (c & 0x80);
+  }
+
+  void copyName(char *dest, size_t size, const char *text) {
+    strncpy(dest, text, size - 1);
+    dest[size - 1] = '\0';
+  }
+}
+
+void RecipeParser::begin() {
+  recipe = Recipe();
+  format = Format::UNKNOWN;
+  error = nullptr;
+  bytes = 0;
+  recipeDone = false;
+  recipeSeen = false;
+  depth = 0;
+  arrays = 0;
+  state = DETECT;
+  match = 0;
+  leaf = false;
+  totalSteps = 0;
+  boilTime = {NAN, 0};
+  resetValue();
+  resetStep();
+  resetHop();
+}
+
+bool RecipeParser::fail(const char *message) {
+  if (!error) {
+    error = message;
+  }
+  return false;
+}
+
+bool RecipeParser::feed(const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len && !error; i++) {
+    consume(static_cast<char>(data[i]));
+  }
+  bytes += len;
+  return !error;
+}
+
+bool RecipeParser::finish() {
+  if (error) {
+    return false;
+  }
+  if (format == Format::UNKNOWN) {
+    return fail("Tomt dokument");
+  }
+  // Et tal som sidste token afsluttes først af det næste tegn.
+  if (state == J_NUMBER || state == J_LITERAL) {
+    consume(' ');
+  }
+  bool complete = format == Format::BEERXML ? depth == 0 && state == X_TEXT : state == J_DONE;
+  if (!complete) {
+    return fail("Ufuldstændigt dokument");
+  }
+  if (!recipeSeen) {
+    return fail("Ingen opskrift i dokumentet");
+  }
+  if (recipe.mash.count == 0) {
+    return fail("Ingen brugbare mæsketrin");
+  }
+  return true;
+}
+
+void RecipeParser::consume(char c) {
+  if (state == DETECT) {
+    // UTF-8 BOM og blanktegn før første tegn springes over.
+    if (isSpace(c) || static_cast<uint8_t>(c) == 0xEF || static_cast<uint8_t>(c) == 0xBB ||
+        static_cast<uint8_t>(c) == 0xBF) {
+      return;
+    }
+    if (c == '<') {
+      format = Format::BEERXML;
+      state = X_TEXT;
+    } else if (c == '{') {
+      format = Format::BEERJSON;
+      state = J_VALUE;
+    } else {
+      fail("Hverken BeerXML eller BeerJSON");
+      return;
+    }
+  }
+  if (format == Format::BEERXML) {
+    consumeXml(c);
+  } else {
+    consumeJson(c);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Fælles: sti, kontekster og opskriften
+// ---------------------------------------------------------------------------
+// name er 0 for et element i et JSON-array.
+RecipeParser::Context RecipeParser::childContext(Context parent, uint32_t name) const {
+  bool json = format == Format::BEERJSON;
+  switch (parent) {
+    case Context::ROOT:
+      if (name == H_RECIPES) return Context::RECIPES;
+      if (name == H_BEERJSON) return Context::BEERJSON;
+      if (name == H_RECIPE && !recipeSeen) return Context::RECIPE;
+      break;
+    case Context::BEERJSON:
+      if (name == H_RECIPES) return Context::RECIPES;
+      break;
+    case Context::RECIPES:
+      if ((name == H_RECIPE || name == 0) && !recipeSeen) return Context::RECIPE;
+      break;
+    case Context::RECIPE:
+      if (name == H_MASH) return Context::MASH;
+      if (name == H_HOPS) return Context::HOP_LIST;
+      if (name == H_BOIL) return Context::BOIL;
+      if (name == H_INGREDIENTS) return Context::INGREDIENTS;
+      break;
+    case Context::BOIL:
+      if (json && name == H_BOIL_TIME) return Context::BOIL_TIME;
+      break;
+    case Context::MASH:
+      if (name == H_MASH_STEPS) return Context::MASH_STEPS;
+      break;
+    case Context::MASH_STEPS:
+      if (name == H_MASH_STEP || name == 0) return Context::MASH_STEP;
+      break;
+    case Context::MASH_STEP:
+      if (json && name == H_STEP_TEMPERATURE) return Context::STEP_TEMP;
+      if (json && name == H_STEP_TIME) return Context::STEP_TIME;
+      break;
+    case Context::INGREDIENTS:
+      if (name == H_HOP_ADDITIONS) return Context::HOP_LIST;
+      break;
+    case Context::HOP_LIST:
+      if (name == H_HOP || name == 0) return Context::HOP;
+      break;
+    case Context::HOP:
+      if (json && name == H_AMOUNT) return Context::HOP_AMOUNT;
+      if (json && name == H_TIMING) return Context::HOP_TIMING;
+      break;
+    case Context::HOP_TIMING:
+      if (name == H_TIME) return Context::HOP_TIME;
+      break;
+    default:
+      break;
+  }
+  return Context::OTHER;
+}
+
+void RecipeParser::enter(Context context) {
+  switch (context) {
+    case Context::RECIPE:    recipeSeen = true; break;
+    case Context::MASH_STEP: resetStep(); break;
+    case Context::HOP:       resetHop(); break;
+    case Context::BOIL_TIME: boilTime = {NAN, 0}; break;
+    case Context::STEP_TEMP: stepTemp = {NAN, 0}; break;
+    case Context::STEP_TIME: stepTime = {NAN, 0}; break;
+    case Context::HOP_AMOUNT: hopAmount = {NAN, 0}; break;
+    case Context::HOP_TIME:  hopTime = {NAN, 0}; break;
+    default: break;
+  }
+}
+
+void RecipeParser::leave(Context context) {
+  switch (context) {
+    case Context::RECIPE:
+      recipeDone = true;
+      if (recipe.mash.count > 0) {
+        recipe.mash.last().confirmEnd = true;
+      }
+      break;
+    case Context::MASH_STEP: finishStep(); break;
+    case Context::HOP:       finishHop(); break;
+    case Context::BOIL_TIME: {
+      float minutes = convert(boilTime, Context::BOIL_TIME);
+      if (minutes >= 0.0f && minutes < 1000.0f) recipe.boilMinutes = lroundf(minutes);
+      break;
+    }
+    case Context::STEP_TEMP:  stepTempC = convert(stepTemp, Context::STEP_TEMP); break;
+    case Context::STEP_TIME:  stepMinutes = convert(stepTime, Context::STEP_TIME); break;
+    case Context::HOP_AMOUNT: hopGrams = convert(hopAmount, Context::HOP_AMOUNT); break;
+    case Context::HOP_TIME:   hopMinutes = convert(hopTime, Context::HOP_TIME); break;
+    default: break;
+  }
+}
+
+void RecipeParser::value(Context context, uint32_t name, const char *text, bool quoted) {
+  (void)quoted;
+  if (recipeDone) {
+    return;
+  }
+  float number = strtof(text, nullptr);
+  Quantity *quantity = nullptr;
+  switch (context) {
+    case Context::RECIPE:
+      if (name == H_NAME) copyName(recipe.name, sizeof(recipe.name), text);
+      else if (name == H_BOIL_TIME && number >= 0.0f && number < 1000.0f) recipe.boilMinutes = lroundf(number);
+      return;
+    case Context::MASH_STEP:
+      // BeerXML: °C og minutter direkte i elementet
+      if (name == H_STEP_TEMP) stepTempC = number;
+      else if (name == H_STEP_TIME) stepMinutes = number;
+      else if (name == H_TYPE) stepNeedsAction = keyHash(text) == H_INFUSION || keyHash(text) == H_DECOCTION;
+      return;
+    case Context::HOP:
+      if (name == H_NAME) {
+        copyName(hopName, sizeof(hopName), text);
+      } else if (name == H_AMOUNT) {
+        hopGrams = number * 1000.0f;  // BeerXML: kg
+      } else if (name == H_TIME) {
+        hopMinutes = number;
+      } else if (name == H_USE) {
+        uint32_t use = keyHash(text);
+        hopInBoil = use == H_USE_BOIL || use == H_USE_FIRST_WORT || use == H_USE_AROMA;
+      }
+      return;
+    case Context::HOP_TIMING:
+      if (name == H_USE) hopInBoil = keyHash(text) == H_ADD_TO_BOIL;
+      return;
+    case Context::BOIL_TIME:  quantity = &boilTime; break;
+    case Context::STEP_TEMP:  quantity = &stepTemp; break;
+    case Context::STEP_TIME:  quantity = &stepTime; break;
+    case Context::HOP_AMOUNT: quantity = &hopAmount; break;
+    case Context::HOP_TIME:   quantity = &hopTime; break;
+    default:
+      return;
+  }
+  if (name == H_VALUE) {
+    quantity->value = number;
+  } else if (name == H_UNIT) {
+    quantity->unit = keyHash(text);
+  }
+}
+
+float RecipeParser::convert(const Quantity &quantity, Context kind) const {
+  float v = quantity.value;
+  uint32_t unit = quantity.unit;
+  switch (kind) {
+    case Context::STEP_TEMP:
+      return unit == H_UNIT_F ? (v - 32.0f) / 1.8f : v;
+    case Context::STEP_TIME:
+    case Context::BOIL_TIME:
+    case Context::HOP_TIME:
+      if (unit == H_UNIT_SEC || unit == H_UNIT_S) return v / 60.0f;
+      if (unit == H_UNIT_HR || unit == H_UNIT_H) return v * 60.0f;
+      if (unit == H_UNIT_DAY) return v * 1440.0f;
+      if (unit == H_UNIT_WEEK) return v * 10080.0f;
+      return v;
+    case Context::HOP_AMOUNT:
+      // Volumenmængder (fx pellets i ml) kan ikke omregnes til gram.
+      if (unit == H_UNIT_G) return v;
+      if (unit == H_UNIT_KG) return v * 1000.0f;
+      if (unit == H_UNIT_MG) return v / 1000.0f;
+      if (unit == H_UNIT_OZ) return v * 28.3495f;
+      if (unit == H_UNIT_LB) return v * 453.592f;
+      return NAN;
+    default:
+      return NAN;
+  }
+}
+
+void RecipeParser::resetStep() {
+  stepTempC = NAN;
+  stepMinutes = NAN;
+  stepTemp = {NAN, 0};
+  stepTime = {NAN, 0};
+  stepNeedsAction = false;
+}
+
+void RecipeParser::resetHop() {
+  hopName[0] = '\0';
+  hopMinutes = NAN;
+  hopGrams = NAN;
+  hopAmount = {NAN, 0};
+  hopTime = {NAN, 0};
+  hopInBoil = false;
+}
+
+void RecipeParser::finishStep() {
+  totalSteps++;
+  MashSchedule &mash = recipe.mash;
+  if (isnan(stepTempC) || !(stepMinutes >= 0.0f) || mash.count >= MashSchedule::MAX_STEPS) {
+    recipe.skippedSteps++;
+    return;
+  }
+  // For lange trin afvises af isValid() nedenfor.
+  uint16_t minutes = stepMinutes <= MashSchedule::MAX_MINUTES ? lroundf(stepMinutes) : MashSchedule::MAX_MINUTES + 1;
+  MashStep step = {tempRawFromC(stepTempC), minutes, PumpMode::ON, GasPolicy::REGULATE,
+                   mash.count == 0 || stepNeedsAction, false};
+  mash.steps[mash.count++] = step;
+  // Uden for mæskeplanens grænser (fx en 95 °C-"sparge") springes trinnet over.
+  if (!mash.isValid()) {
+    mash.count--;
+    recipe.skippedSteps++;
+  }
+}
+
+void RecipeParser::finishHop() {
+  if (!hopInBoil || !(hopMinutes >= 0.0f) || hopMinutes > 65535.0f) {
+    return;
+  }
+  uint16_t minutes = hopMinutes < BoilAdditions::MAX_MINUTES ? lroundf(hopMinutes) : BoilAdditions::MAX_MINUTES;
+  uint16_t grams = hopGrams >= 0.0f && hopGrams < 65535.0f ? lroundf(hopGrams) : 0;
+  if (!recipe.additions.add(hopName[0] ? hopName : "Humle", minutes, grams)) {
+    recipe.skippedAdditions++;
+  }
+}
+
+void RecipeParser::resetValue() {
+  valueLen = 0;
+  valueBuf[0] = '\0';
+}
+
+// Længere værdier afkortes; tal og navne, der bruges, er altid korte.
+void RecipeParser::appendValue(char c) {
+  if (valueLen == 0 && isSpace(c)) {
+    return;
+  }
+  if (valueLen < VALUE_SIZE - 1) {
+    valueBuf[valueLen++] = c;
+    valueBuf[valueLen] = '\0';
+  }
+}
+
+// ---------------------------------------------------------------------------
+// BeerXML
+// ---------------------------------------------------------------------------
+void RecipeParser::consumeXml(char c) {
+  switch (state) {
+    case X_TEXT:
+      if (c == '<') {
+        state = X_TAG;
+      } else if (c == '&') {
+        entityLen = 0;
+        state = X_ENTITY;
+      } else {
+        xmlText(c);
+      }
+      break;
+    case X_ENTITY:
+      xmlEntity(c);
+      break;
+    case X_TAG:
+      if (c == '/') {
+        hash = FNV_OFFSET;
+        state = X_CLOSE_NAME;
+      } else if (c == '!') {
+        match = 0;
+        state = X_BANG;
+      } else if (c == '?') {
+        match = 0;
+        state = X_PI;
+      } else if (isNameChar(c)) {
+        hash = hashStep(FNV_OFFSET, c);
+        state = X_OPEN_NAME;
+      } else {
+        fail("Ugyldigt tag");
+      }
+      break;
+    case X_OPEN_NAME:
+      if (isNameChar(c)) {
+        hash = hashStep(hash, c);
+      } else if (isSpace(c)) {
+        state = X_ATTRS;
+      } else if (c == '>') {
+        xmlOpen(hash);
+        state = X_TEXT;
+      } else if (c == '/') {
+        state = X_SELF_CLOSE;
+      } else {
+        fail("Ugyldigt tag");
+      }
+      break;
+    case X_ATTRS:
+      if (c == '"' || c == '\'') {
+        quote = c;
+        state = X_ATTR_QUOTE;
+      } else if (c == '/') {
+        state = X_SELF_CLOSE;
+      } else if (c == '>') {
+        xmlOpen(hash);
+        state = X_TEXT;
+      }
+      break;
+    case X_ATTR_QUOTE:
+      if (c == quote) {
+        state = X_ATTRS;
+      }
+      break;
+    case X_SELF_CLOSE:
+      if (c != '>') {
+        fail("Ugyldigt tag");
+        break;
+      }
+      xmlOpen(hash);
+      xmlClose(hash);
+      state = X_TEXT;
+      break;
+    case X_CLOSE_NAME:
+      if (isNameChar(c)) {
+        hash = hashStep(hash, c);
+      } else if (isSpace(c)) {
+        state = X_CLOSE_TAIL;
+      } else if (c == '>') {
+        xmlClose(hash);
+        state = X_TEXT;
+      } else {
+        fail("Ugyldigt sluttag");
+      }
+      break;
+    case X_CLOSE_TAIL:
+      if (c == '>') {
+        xmlClose(hash);
+        state = X_TEXT;
+      } else if (!isSpace(c)) {
+        fail("Ugyldigt sluttag");
+      }
+      break;
+    case X_BANG:
+      // "<!--" kommentar, "<![CDATA[" eller "<!DOCTYPE …>"
+      if (match == 1) {
+        if (c == '-') {
+          match = 0;
+          state = X_COMMENT;
+        } else {
+          fail("Ugyldig kommentar");
+        }
+      } else if (c == '-') {
+        match = 1;
+      } else if (c == '[') {
+        match = 0;
+        state = X_CDATA_OPEN;
+      } else {
+        match = 0;
+        state = X_DOCTYPE;
+      }
+      break;
+    case X_COMMENT:
+      if (c == '-') {
+        match = match < 2 ? match + 1 : 2;
+      } else if (c == '>' && match == 2) {
+        state = X_TEXT;
+      } else {
+        match = 0;
+      }
+      break;
+    case X_CDATA_OPEN:
+      // "CDATA[" springes over
+      if (++match == 6) {
+        match = 0;
+        state = X_CDATA;
+      }
+      break;
+    case X_CDATA:
+      if (c == ']') {
+        if (match == 2) {
+          xmlText(']');
+        } else {
+          match++;
+        }
+      } else if (c == '>' && match == 2) {
+        match = 0;
+        state = X_TEXT;
+      } else {
+        for (; match > 0; match--) {
+          xmlText(']');
+        }
+        xmlText(c);
+      }
+      break;
+    case X_DOCTYPE:
+      if (c == '[') {
+        match++;
+      } else if (c == ']' && match > 0) {
+        match--;
+      } else if (c == '>' && match == 0) {
+        state = X_TEXT;
+      }
+      break;
+    case X_PI:
+      if (c == '>' && match == 1) {
+        state = X_TEXT;
+      } else {
+        match = c == '?';
+      }
+      break;
+    default:
+      fail("Intern fejl");
+      break;
+  }
+}
+
+void RecipeParser::xmlOpen(uint32_t name) {
+  if (depth >= MAX_DEPTH) {
+    fail("For dybt dokument");
+    return;
+  }
+  Context parent = depth > 0 ? contexts[depth - 1] : Context::ROOT;
+  Context context = childContext(parent, name);
+  contexts[depth] = context;
+  names[depth] = name;
+  depth++;
+  leaf = true;
+  resetValue();
+  enter(context);
+}
+
+void RecipeParser::xmlClose(uint32_t name) {
+  if (depth == 0 || names[depth - 1] != name) {
+    fail("Sluttag passer ikke");
+    return;
+  }
+  depth--;
+  Context context = contexts[depth];
+  if (leaf) {
+    while (valueLen > 0 && isSpace(valueBuf[valueLen - 1])) {
+      valueBuf[--valueLen] = '\0';
+    }
+    value(depth > 0 ? contexts[depth - 1] : Context::ROOT, name, valueBuf, false);
+  }
+  leaf = false;
+  leave(context);
+}
+
+void RecipeParser::xmlText(char c) {
+  if (leaf) {
+    appendValue(c);
+  }
+}
+
+void RecipeParser::xmlEntity(char c) {
+  if (c != ';') {
+    if (entityLen < sizeof(entity) - 1) {
+      entity[entityLen++] = c;
+    }
+    return;
+  }
+  entity[entityLen] = '\0';
+  state = X_TEXT;
+  if (strcmp(entity, "amp") == 0) xmlText('&');
+  else if (strcmp(entity, "lt") == 0) xmlText('<');
+  else if (strcmp(entity, "gt") == 0) xmlText('>');
+  else if (strcmp(entity, "quot") == 0) xmlText('"');
+  else if (strcmp(entity, "apos") == 0) xmlText('\'');
+  else if (entity[0] == '#') {
+    long code = entity[1] == 'x' ? strtol(entity + 2, nullptr, 16) : strtol(entity + 1, nullptr, 10);
+    xmlText(code > 0 && code < 128 ? static_cast<char>(code) : '?');
+  }
+}
+
+// ---------------------------------------------------------------------------
+// BeerJSON
+// ---------------------------------------------------------------------------
+void RecipeParser::consumeJson(char c) {
+  switch (state) {
+    case J_VALUE:
+      if (!isSpace(c) && !jsonBeginValue(c)) {
+        fail("Ugyldig JSON-værdi");
+      }
+      break;
+    case J_KEY:
+      if (c == '"') {
+        hash = FNV_OFFSET;
+        quote = 'k';
+        state = J_STRING;
+      } else if (c == '}') {
+        jsonClose(false);
+      } else if (!isSpace(c)) {
+        fail("Forventede en nøgle");
+      }
+      break;
+    case J_COLON:
+      if (c == ':') {
+        names[depth - 1] = key;
+        state = J_VALUE;
+      } else if (!isSpace(c)) {
+        fail("Forventede ':'");
+      }
+      break;
+    case J_AFTER:
+      if (c == ',') {
+        state = arrays & (1UL << (depth - 1)) ? J_VALUE : J_KEY;
+      } else if (c == '}' || c == ']') {
+        jsonClose(c == ']');
+      } else if (!isSpace(c)) {
+        fail("Forventede ',' eller afslutning");
+      }
+      break;
+    case J_STRING:
+      if (c == '"') {
+        if (quote == 'k') {
+          key = hash;
+          state = J_COLON;
+        } else {
+          jsonEndScalar(true);
+        }
+      } else if (c == '\\') {
+        state = J_ESCAPE;
+      } else if (quote == 'k') {
+        hash = hashStep(hash, c);
+      } else {
+        appendValue(c);
+      }
+      break;
+    case J_ESCAPE:
+      if (c == 'u') {
+        unicode = 0;
+        match = 0;
+        state = J_UNICODE;
+        break;
+      }
+      c = c == 'n' || c == 't' || c == 'r' || c == 'b' || c == 'f' ? ' ' : c;
+      if (quote == 'k') hash = hashStep(hash, c);
+      else appendValue(c);
+      state = J_STRING;
+      break;
+    case J_UNICODE: {
+      uint8_t digit = c >= '0' && c <= '9' ? c - '0' : (lower(c) >= 'a' && lower(c) <= 'f') ? lower(c) - 'a' + 10 : 16;
+      if (digit > 15) {
+        fail("Ugyldig \\u-escape");
+        break;
+      }
+      unicode = (unicode << 4) | digit;
+      if (++match == 4) {
+        char decoded = unicode < 128 ? static_cast<char>(unicode) : '?';
+        if (quote == 'k') hash = hashStep(hash, decoded);
+        else appendValue(decoded);
+        state = J_STRING;
+      }
+      break;
+    }
+    case J_NUMBER:
+    case J_LITERAL:
+      if ((state == J_NUMBER && ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) ||
+          (state == J_LITERAL && c >= 'a' && c <= 'z')) {
+        appendValue(c);
+      } else {
+        jsonEndScalar(false);
+        consumeJson(c);
+      }
+      break;
+    case J_DONE:
+      if (!isSpace(c)) {
+        fail("Data efter dokumentets afslutning");
+      }
+      break;
+    default:
+      fail("Intern fejl");
+      break;
+  }
+}
+
+bool RecipeParser::jsonBeginValue(char c) {
+  if (c == '{' || c == '[') {
+    jsonOpen(c == '[');
+    return true;
+  }
+  if (depth == 0) {
+    return false;  // Dokumentet skal være et objekt
+  }
+  if (c == ']') {
+    return jsonClose(true);  // Tomt array
+  }
+  resetValue();
+  if (c == '"') {
+    quote = 'v';
+    state = J_STRING;
+  } else if (c == '-' || (c >= '0' && c <= '9')) {
+    appendValue(c);
+    state = J_NUMBER;
+  } else if (c == 't' || c == 'f' || c == 'n') {
+    appendValue(c);
+    state = J_LITERAL;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void RecipeParser::jsonOpen(bool array) {
+  if (depth >= MAX_DEPTH) {
+    fail("For dybt dokument");
+    return;
+  }
+  Context context = Context::ROOT;
+  if (depth > 0) {
+    uint8_t parent = depth - 1;
+    bool inArray = arrays & (1UL << parent);
+    context = childContext(contexts[parent], inArray ? 0 : names[parent]);
+  }
+  contexts[depth] = context;
+  names[depth] = 0;
+  if (array) {
+    arrays |= 1UL << depth;
+  } else {
+    arrays &= ~(1UL << depth);
+  }
+  depth++;
+  state = array ? J_VALUE : J_KEY;
+  enter(context);
+}
+
+bool RecipeParser::jsonClose(bool array) {
+  if (depth == 0 || static_cast<bool>(arrays & (1UL << (depth - 1))) != array) {
+    return fail(array ? "Uventet ']'" : "Uventet '}'");
+  }
+  depth--;
+  leave(contexts[depth]);
+  jsonAfterValue();
+  return true;
+}
+
+void RecipeParser::jsonEndScalar(bool quoted) {
+  uint8_t top = depth - 1;
+  bool inArray = arrays & (1UL << top);
+  value(contexts[top], inArray ? 0 : names[top], valueBuf, quoted);
+  jsonAfterValue();
+}
+
+void RecipeParser::jsonAfterValue() {
+  state = depth == 0 ? J_DONE : J_AFTER;
+}
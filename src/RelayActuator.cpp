@@ -0,0 +1,135 @@
+#include "RelayActuator.h"
+#include "Hal.h"
+
+namespace {
+  constexpr float MS_PER_HOUR = 3600000.0f;
+  // Så mange tændinger kan spares op: et kvarters kvote.
+  constexpr uint16_t BURST_DIVISOR = 4;
+}
+
+void RelayActuator::begin(uint8_t relayPin, const Limits &relayLimits, const Counters &stored, uint64_t nowMs) {
+  pin = relayPin;
+  limits = relayLimits;
+  on = false;
+  desired = false;
+  waiting = false;
+  switched = false;
+  changedAt = nowMs;
+  sessionStart = nowMs;
+  cycles = stored.cycles;
+  onMs = static_cast<uint64_t>(stored.onSeconds) * 1000;
+  sessionStartCycles = cycles;
+  sessionStartOnMs = onMs;
+  savedCycles = cycles;
+  savedOnMs = onMs;
+  deferred = 0;
+  tokens = max<uint16_t>(1, limits.maxCyclesPerHour / BURST_DIVISOR);
+  refilledAt = nowMs;
+  Hal::digitalWrite(pin, false);
+}
+
+void RelayActuator::request(bool target, uint64_t nowMs) {
+  desired = target;
+  if (desired == on) {
+    waiting = false;
+    return;
+  }
+  if (target && isBlocked()) {
+    return;
+  }
+  if (allowed(target, nowMs)) {
+    write(target, nowMs);
+  } else if (!waiting) {
+    waiting = true;
+    deferred++;
+  }
+}
+
+void RelayActuator::forceOff(uint64_t nowMs) {
+  desired = false;
+  waiting = false;
+  if (on) {
+    write(false, nowMs);
+  }
+}
+
+void RelayActuator::update(uint64_t nowMs) {
+  if (isBlocked()) {
+    // Spærren slukker uden om minimumstiden, men glemmer ikke ønsket.
+    if (on) {
+      write(false, nowMs);
+    }
+    return;
+  }
+  if (desired != on && allowed(desired, nowMs)) {
+    write(desired, nowMs);
+  }
+}
+
+bool RelayActuator::allowed(bool target, uint64_t nowMs) {
+  if (!switched) {
+    return true;
+  }
+  if (!target) {
+    return nowMs - changedAt >= limits.minOnMs;
+  }
+  if (nowMs - changedAt < limits.minOffMs) {
+    return false;
+  }
+  refill(nowMs);
+  return limits.maxCyclesPerHour == 0 || tokens >= 1.0f;
+}
+
+void RelayActuator::refill(uint64_t nowMs) {
+  if (limits.maxCyclesPerHour == 0) {
+    return;
+  }
+  float burst = max<uint16_t>(1, limits.maxCyclesPerHour / BURST_DIVISOR);
+  tokens = min(burst, tokens + (nowMs - refilledAt) * limits.maxCyclesPerHour / MS_PER_HOUR);
+  refilledAt = nowMs;
+}
+
+void RelayActuator::write(bool target, uint64_t nowMs) {
+  if (target) {
+    refill(nowMs);
+    tokens = max(0.0f, tokens - 1.0f);
+    cycles++;
+  } else {
+    onMs += nowMs - changedAt;
+  }
+  on = target;
+  waiting = false;
+  switched = true;
+  changedAt = nowMs;
+  Hal::digitalWrite(pin, target);
+}
+
+uint64_t RelayActuator::currentOnMs(uint64_t nowMs) const {
+  return on ? nowMs - changedAt : 0;
+}
+
+RelayActuator::Counters RelayActuator::getCounters(uint64_t nowMs) const {
+  Counters counters = {cycles, static_cast<uint32_t>((onMs + currentOnMs(nowMs)) / 1000)};
+  return counters;
+}
+
+RelayActuator::Stats RelayActuator::getStats(uint64_t nowMs) const {
+  Stats stats;
+  stats.lifetime = getCounters(nowMs);
+  stats.sessionCycles = cycles - sessionStartCycles;
+  uint64_t sessionMs = nowMs - sessionStart;
+  uint64_t sessionOnMs = onMs + currentOnMs(nowMs) - sessionStartOnMs;
+  stats.sessionDuty = sessionMs > 0 ? 100.0f * sessionOnMs / sessionMs : 0.0f;
+  stats.averageOnSeconds = cycles > 0 ? static_cast<float>(stats.lifetime.onSeconds) / cycles : 0.0f;
+  stats.deferred = deferred;
+  return stats;
+}
+
+uint64_t RelayActuator::getUnsavedOnMs(uint64_t nowMs) const {
+  return onMs + currentOnMs(nowMs) - savedOnMs;
+}
+
+void RelayActuator::markSaved(uint64_t nowMs) {
+  savedCycles = cycles;
+  savedOnMs = onMs + currentOnMs(nowMs);
+}
@@ -0,0 +1,164 @@
+#include "RelayAutoTuner.h"
+#include <Arduino.h>
+
+namespace {
+  // Relæet skifter mellem 0 og 100 % gas: d er det halve udsving.
+  constexpr float RELAY_AMPLITUDE = 50.0f;
+  // Hysterese om setpoint (°C). Skal ligge over støjen på den filtrerede
+  // temperatur, så relæet ikke klaprer ved krydsningen.
+  constexpr float NOISE_BAND = 0.2f;
+  constexpr uint8_t MIN_CYCLES = 3;
+  constexpr uint8_t MAX_CYCLES = 8;
+  // To på hinanden følgende svingninger må højst afvige så meget (relativt).
+  constexpr float CONVERGENCE_TOLERANCE = 0.15f;
+  constexpr float MIN_AMPLITUDE = 0.05f;
+  constexpr unsigned long MAX_DURATION_MS = 4UL * 60 * 60 * 1000;
+  constexpr unsigned long TRACE_INTERVAL_MS = 5000;
+}
+
+void RelayAutoTuner::start(float setpointC, unsigned long nowMs) {
+  status = Status::RUNNING;
+  result = {};
+  failReason = "";
+  setpoint = setpointC;
+  relayOn = false;
+  startMs = nowMs;
+  primed = false;
+  haveOnEdge = false;
+  haveMin = false;
+  cycleCount = 0;
+  traceHead = 0;
+  traceCount = 0;
+  lastTraceMs = nowMs - TRACE_INTERVAL_MS;
+}
+
+void RelayAutoTuner::abort() {
+  if (status == Status::RUNNING) {
+    fail("Afbrudt");
+  }
+}
+
+void RelayAutoTuner::fail(const char *reason) {
+  status = Status::FAILED;
+  failReason = reason;
+  relayOn = false;
+}
+
+bool RelayAutoTuner::update(float temperatureC, unsigned long nowMs) {
+  if (status != Status::RUNNING) {
+    return false;
+  }
+  if (nowMs - startMs > MAX_DURATION_MS) {
+    fail("Tidsgrænse overskredet");
+    return false;
+  }
+
+  if (!primed) {
+    relayOn = temperatureC < setpoint;
+    phaseMax = phaseMin = temperatureC;
+    primed = true;
+  }
+  phaseMax = max(phaseMax, temperatureC);
+  phaseMin = min(phaseMin, temperatureC);
+
+  if (relayOn && temperatureC >= setpoint + NOISE_BAND) {
+    // Slut på en on-fase: bunden ligger lige efter skiftet til "on" pga. lag.
+    relayOn = false;
+    if (haveOnEdge) {
+      lastMin = phaseMin;
+      haveMin = true;
+    }
+    phaseMax = phaseMin = temperatureC;
+  } else if (!relayOn && temperatureC <= setpoint - NOISE_BAND) {
+    // Slut på en off-fase (med toppen) – og dermed på en hel svingning.
+    relayOn = true;
+    if (haveOnEdge && haveMin) {
+      finishCycle(nowMs);
+    }
+    lastOnMs = nowMs;
+    haveOnEdge = true;
+    phaseMax = phaseMin = temperatureC;
+  }
+
+  addTrace(temperatureC, nowMs);
+  return status == Status::RUNNING && relayOn;
+}
+
+void RelayAutoTuner::finishCycle(unsigned long nowMs) {
+  for (uint8_t i = 1; i < HISTORY; i++) {
+    periods[i - 1] = periods[i];
+    amplitudes[i - 1] = amplitudes[i];
+  }
+  periods[HISTORY - 1] = (nowMs - lastOnMs) / 1000.0f;
+  amplitudes[HISTORY - 1] = (phaseMax - lastMin) / 2.0f;
+  cycleCount++;
+
+  Serial.printf("[AutoTune] Svingning %u: periode %.0f s, amplitude %.2f °C\n", cycleCount,
+                periods[HISTORY - 1], amplitudes[HISTORY - 1]);
+
+  if (cycleCount >= MIN_CYCLES && converged()) {
+    computeResult();
+  } else if (cycleCount >= MAX_CYCLES) {
+    fail("Svingningen stabiliserede sig ikke");
+  }
+}
+
+bool RelayAutoTuner::converged() const {
+  float p1 = periods[HISTORY - 2];
+  float p2 = periods[HISTORY - 1];
+  float a1 = amplitudes[HISTORY - 2];
+  float a2 = amplitudes[HISTORY - 1];
+  return fabsf(p2 - p1) <= CONVERGENCE_TOLERANCE * p2 && fabsf(a2 - a1) <= CONVERGENCE_TOLERANCE * a2;
+}
+
+void RelayAutoTuner::computeResult() {
+  float tu = (periods[HISTORY - 2] + periods[HISTORY - 1]) / 2.0f;
+  float a = (amplitudes[HISTORY - 2] + amplitudes[HISTORY - 1]) / 2.0f;
+  if (a < MIN_AMPLITUDE || tu <= 0.0f) {
+    fail("For lille svingning til at måle");
+    return;
+  }
+  // Korrektion for relæets hysterese; uden mening, hvis båndet fylder det hele.
+  float effective = a > NOISE_BAND ? sqrtf(a * a - NOISE_BAND * NOISE_BAND) : a;
+  float ku = 4.0f * RELAY_AMPLITUDE / (PI * effective);
+
+  result.ku = ku;
+  result.tuS = tu;
+  result.amplitude = a;
+  result.kp = 0.45f * ku;
+  result.ki = result.kp / (2.2f * tu);
+  result.kd = result.kp * (tu / 6.3f);
+  status = Status::DONE;
+  relayOn = false;
+
+  Serial.printf("[AutoTune] Færdig: Ku %.1f %%/°C, Tu %.0f s -> Kp %.2f, Ki %.4f, Kd %.0f\n", ku, tu, result.kp,
+                result.ki, result.kd);
+}
+
+void RelayAutoTuner::addTrace(float temperatureC, unsigned long nowMs) {
+  if (nowMs - lastTraceMs < TRACE_INTERVAL_MS) {
+    return;
+  }
+  lastTraceMs = nowMs;
+  TracePoint &point = trace[traceHead];
+  point.seq = ++traceSeq;
+  point.timeS = (nowMs - startMs) / 1000;
+  point.temp = tempRawFromC(temperatureC);
+  point.gasOn = relayOn;
+  traceHead = (traceHead + 1) % TRACE_SIZE;
+  if (traceCount < TRACE_SIZE) {
+    traceCount++;
+  }
+}
+
+size_t RelayAutoTuner::getTrace(uint32_t since, TracePoint *out, size_t maxPoints) const {
+  size_t copied = 0;
+  uint8_t oldest = (traceHead + TRACE_SIZE - traceCount) % TRACE_SIZE;
+  for (uint8_t i = 0; i < traceCount && copied < maxPoints; i++) {
+    const TracePoint &point = trace[(oldest + i) % TRACE_SIZE];
+    if (point.seq > since) {
+      out[copied++] = point;
+    }
+  }
+  return copied;
+}
@@ -0,0 +1,206 @@
+#include "RmtOneWireBus.h"
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <esp_rom_gpio.h>
+#include <freertos/ringbuf.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/soc_caps.h>
+
+namespace {
+  // Standardhastighed (Maxim AN126), alle tider i µs. RMT tæller i 1 µs-ticks.
+  constexpr uint16_t RESET_LOW_US = 480;
+  constexpr uint16_t RESET_RELEASE_US = 480;
+  constexpr uint16_t WRITE1_LOW_US = 6;
+  constexpr uint16_t WRITE1_RELEASE_US = 64;
+  constexpr uint16_t WRITE0_LOW_US = 60;
+  constexpr uint16_t WRITE0_RELEASE_US = 10;
+  constexpr uint16_t READ_LOW_US = 6;
+  constexpr uint16_t READ_RELEASE_US = 64;
+  // En læst lav-puls, der er kortere end dette, er en 1'er (A + E i AN126).
+  constexpr uint16_t READ_SAMPLE_US = 15;
+
+  constexpr uint8_t RMT_CLOCK_DIV = 80;          // 80 MHz APB -> 1 µs
+  constexpr uint16_t RX_IDLE_THRESHOLD_US = 100; // Længere høj periode end noget tidsvindue
+  constexpr uint8_t RX_FILTER_TICKS = 30;        // APB-ticks (~0,4 µs) – fjerner glitches
+  constexpr size_t RX_BUFFER_SIZE = 512;
+  constexpr TickType_t RX_TIMEOUT = pdMS_TO_TICKS(20);
+  // RX-hukommelsen er 48 items pr. kanal, så læsninger deles op i bidder.
+  constexpr uint8_t MAX_READ_BYTES_PER_TRANSACTION = 4;
+  constexpr uint8_t MAX_WRITE_BYTES = 9;
+
+  rmt_item32_t slot(uint16_t lowUs, uint16_t releaseUs) {
+    rmt_item32_t item;
+    item.level0 = 0;
+    item.duration0 = lowUs;
+    item.level1 = 1;
+    item.duration1 = releaseUs;
+    return item;
+  }
+
+  rmt_item32_t writeSlot(bool bit) {
+    return bit ? slot(WRITE1_LOW_US, WRITE1_RELEASE_US) : slot(WRITE0_LOW_US, WRITE0_RELEASE_US);
+  }
+
+  // RX-kanalernes indeks i GPIO-matricen. På ESP32-S3 er RX kanal 4-7 (= RX-signal 0-3).
+  uint32_t rxSignalIndex(uint8_t rxChannel) {
+    return RMT_SIG_IN0_IDX + rxChannel - (SOC_RMT_CHANNELS_PER_GROUP - SOC_RMT_RX_CANDIDATES_PER_GROUP);
+  }
+}
+
+RmtOneWireBus::RmtOneWireBus(uint8_t pin, uint8_t txChannel, uint8_t rxChannel)
+  : pin(pin), txChannel(txChannel), rxChannel(rxChannel) {}
+
+bool RmtOneWireBus::begin() {
+  if (ready) {
+    return true;
+  }
+  gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+  rmt_channel_t tx = static_cast<rmt_channel_t>(txChannel);
+  rmt_channel_t rx = static_cast<rmt_channel_t>(rxChannel);
+
+  rmt_config_t txConfig = RMT_DEFAULT_CONFIG_TX(gpio, tx);
+  txConfig.clk_div = RMT_CLOCK_DIV;
+  txConfig.tx_config.idle_output_en = true;
+  txConfig.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;
+  if (rmt_config(&txConfig) != ESP_OK || rmt_driver_install(tx, 0, 0) != ESP_OK) {
+    return false;
+  }
+
+  rmt_config_t rxConfig = RMT_DEFAULT_CONFIG_RX(gpio, rx);
+  rxConfig.clk_div = RMT_CLOCK_DIV;
+  rxConfig.rx_config.idle_threshold = RX_IDLE_THRESHOLD_US;
+  rxConfig.rx_config.filter_en = true;
+  rxConfig.rx_config.filter_ticks_thresh = RX_FILTER_TICKS;
+  if (rmt_config(&rxConfig) != ESP_OK || rmt_driver_install(rx, RX_BUFFER_SIZE, 0) != ESP_OK) {
+    rmt_driver_uninstall(tx);
+    return false;
+  }
+  RingbufHandle_t ringbuf = nullptr;
+  rmt_get_ringbuf_handle(rx, &ringbuf);
+  rxBuffer = ringbuf;
+
+  // TX og RX deler pin'en: open drain med pull-up, og begge signaler føres
+  // gennem GPIO-matricen, så RX ser både vores egne og sensorens pulser.
+  gpio_set_direction(gpio, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_set_pull_mode(gpio, GPIO_PULLUP_ONLY);
+  esp_rom_gpio_connect_out_signal(pin, RMT_SIG_OUT0_IDX + txChannel, false, false);
+  esp_rom_gpio_connect_in_signal(pin, rxSignalIndex(rxChannel), false);
+
+  ready = true;
+  return true;
+}
+
+bool RmtOneWireBus::writeSlots(const void *items, uint8_t count) {
+  // wait_tx_done venter på driverens TX-done-semafor – tasken sover imens.
+  return rmt_write_items(static_cast<rmt_channel_t>(txChannel), static_cast<const rmt_item32_t*>(items),
+                         count, true) == ESP_OK;
+}
+
+int RmtOneWireBus::readSlots(const void *items, uint8_t count, uint16_t *lowDurations, uint8_t maxPulses) {
+  rmt_channel_t rx = static_cast<rmt_channel_t>(rxChannel);
+  RingbufHandle_t ringbuf = static_cast<RingbufHandle_t>(rxBuffer);
+
+  rmt_rx_start(rx, true);
+  if (!writeSlots(items, count)) {
+    rmt_rx_stop(rx);
+    return -1;
+  }
+  // RX-optagelsen afsluttes af hardwaren, når linjen har været høj i
+  // RX_IDLE_THRESHOLD_US; driveren lægger den i ringbufferen fra sin ISR.
+  size_t size = 0;
+  rmt_item32_t *received = static_cast<rmt_item32_t*>(xRingbufferReceive(ringbuf, &size, RX_TIMEOUT));
+  rmt_rx_stop(rx);
+  if (!received) {
+    return -1;
+  }
+
+  int pulses = 0;
+  size_t itemCount = size / sizeof(rmt_item32_t);
+  for (size_t i = 0; i < itemCount && pulses < maxPulses; i++) {
+    if (received[i].level0 == 0 && received[i].duration0 > 0) {
+      lowDurations[pulses++] = received[i].duration0;
+    }
+    if (pulses < maxPulses && received[i].level1 == 0 && received[i].duration1 > 0) {
+      lowDurations[pulses++] = received[i].duration1;
+    }
+  }
+  vRingbufferReturnItem(ringbuf, received);
+  return pulses;
+}
+
+bool RmtOneWireBus::reset() {
+  if (!ready) {
+    return false;
+  }
+  // Første lav-puls er vores egen reset; en efterfølgende er sensorens presence.
+  rmt_item32_t item = slot(RESET_LOW_US, RESET_RELEASE_US);
+  uint16_t lows[2];
+  return readSlots(&item, 1, lows, 2) == 2;
+}
+
+void RmtOneWireBus::writeBytes(const uint8_t *data, uint8_t len) {
+  if (!ready) {
+    return;
+  }
+  rmt_item32_t items[MAX_WRITE_BYTES * 8];
+  while (len > 0) {
+    uint8_t chunk = len < MAX_WRITE_BYTES ? len : MAX_WRITE_BYTES;
+    for (uint8_t b = 0; b < chunk; b++) {
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        items[b * 8 + bit] = writeSlot((data[b] >> bit) & 0x01);
+      }
+    }
+    writeSlots(items, chunk * 8);
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+void RmtOneWireBus::readBytes(uint8_t *data, uint8_t len) {
+  rmt_item32_t items[MAX_READ_BYTES_PER_TRANSACTION * 8];
+  uint16_t lows[MAX_READ_BYTES_PER_TRANSACTION * 8];
+  for (uint8_t i = 0; i < MAX_READ_BYTES_PER_TRANSACTION * 8; i++) {
+    items[i] = slot(READ_LOW_US, READ_RELEASE_US);
+  }
+
+  while (len > 0) {
+    uint8_t chunk = len < MAX_READ_BYTES_PER_TRANSACTION ? len : MAX_READ_BYTES_PER_TRANSACTION;
+    uint8_t slots = chunk * 8;
+    int pulses = ready ? readSlots(items, slots, lows, slots) : -1;
+    for (uint8_t b = 0; b < chunk; b++) {
+      uint8_t value = 0xFF;  // Ingen svar = linjen høj = 1-bits
+      if (pulses == slots) {
+        value = 0;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+          if (lows[b * 8 + bit] < READ_SAMPLE_US) {
+            value |= 1 << bit;
+          }
+        }
+      }
+      data[b] = value;
+    }
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+bool RmtOneWireBus::readBit() {
+  if (!ready) {
+    return true;
+  }
+  rmt_item32_t item = slot(READ_LOW_US, READ_RELEASE_US);
+  uint16_t low = 0;
+  if (readSlots(&item, 1, &low, 1) != 1) {
+    return true;
+  }
+  return low < READ_SAMPLE_US;
+}
+
+void RmtOneWireBus::writeBit(bool bit) {
+  if (!ready) {
+    return;
+  }
+  rmt_item32_t item = writeSlot(bit);
+  writeSlots(&item, 1);
+}
@@ -0,0 +1,284 @@
+#include "SafetySupervisor.h"
+#include "BuzzerHandler.h"
+#include "Hal.h"
+#include "PinConfig.h"
+#include "TemperatureHandler.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace {
+  using Trip = SafetySupervisor::Trip;
+
+  // Over loop() (1) og måletasken (2) på loop()'s kerne, så en loop(), der
+  // spinner, ikke kan holde vagten ude.
+  constexpr uint32_t TASK_STACK_SIZE = 3072;
+  constexpr UBaseType_t TASK_PRIORITY = 5;
+  constexpr BaseType_t TASK_CORE = 1;
+
+  constexpr TempRaw MAX_KETTLE_RAW = tempRawFromC(SafetySupervisor::MAX_KETTLE_C);
+  constexpr TempRaw MAX_VALVE_RAW = tempRawFromC(SafetySupervisor::MAX_VALVE_C);
+
+  uint8_t gasPin = 0;
+  uint8_t pumpPin = 0;
+  bool started = false;
+  bool stallReported = false;  // Kun vagtens egen tråd
+
+  std::atomic<uint8_t> tripReason{static_cast<uint8_t>(Trip::NONE)};
+  std::atomic<unsigned long> trippedAt{0};
+  std::atomic<bool> heartbeatSeen{false};
+  std::atomic<unsigned long> lastHeartbeat{0};
+  std::atomic<bool> checkSeen{false};
+  std::atomic<unsigned long> lastCheck{0};
+  std::atomic<unsigned long> lastGasOff{0};  // Seneste kontrol, hvor gassen var slukket
+  std::atomic<uint32_t> maxGasOnMs{SafetySupervisor::DEFAULT_MAX_GAS_ON_S * 1000};
+
+  // Sensorindeks pr. kar fra watchVessel(); -1 = ikke overvåget.
+  struct WatchedVessel {
+    std::atomic<int8_t> sensor{-1};
+    std::atomic<int8_t> limit{-1};
+  };
+  WatchedVessel watchedVessels[VESSEL_COUNT];
+
+  bool isOvertemp(const TemperatureSnapshot &sample, int8_t index, TempRaw max) {
+    return index >= 0 && index < sample.sensorCount && sample.estimates[index].valid &&
+           sample.estimates[index].temp > max;
+  }
+
+  bool heatOn() {
+    if (Hal::digitalRead(gasPin)) {
+      return true;
+    }
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+      if (Hal::digitalRead(VESSEL_PINS[i].heatPin)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool outputsOn() {
+    if (heatOn() || Hal::digitalRead(pumpPin)) {
+      return true;
+    }
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+      if (VESSEL_PINS[i].pumpPin >= 0 && Hal::digitalRead(VESSEL_PINS[i].pumpPin)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void forceOutputsOff() {
+    Hal::digitalWrite(gasPin, false);
+    Hal::digitalWrite(pumpPin, false);
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+      Hal::digitalWrite(VESSEL_PINS[i].heatPin, false);
+      if (VESSEL_PINS[i].pumpPin >= 0) {
+        Hal::digitalWrite(VESSEL_PINS[i].pumpPin, false);
+      }
+    }
+  }
+
+  // Første fejl i prioriteret rækkefølge; læser kun udgange og atomics, så
+  // den kan kaldes fra både vagten og reset(). vessel er karret bag en
+  // temperaturfejl.
+  Trip evaluate(unsigned long now, uint8_t &vessel) {
+    if (heartbeatSeen.load(std::memory_order_acquire) &&
+        now - lastHeartbeat.load(std::memory_order_relaxed) > SafetySupervisor::HEARTBEAT_TIMEOUT_MS) {
+      return Trip::LOOP_STALLED;
+    }
+    TemperatureSnapshot sample = TemperatureHandler::getSnapshot();
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+      vessel = i;
+      if (isOvertemp(sample, watchedVessels[i].sensor.load(std::memory_order_relaxed), MAX_KETTLE_RAW)) {
+        return i == KETTLE_VESSEL ? Trip::KETTLE_OVERTEMP : Trip::VESSEL_OVERTEMP;
+      }
+      if (isOvertemp(sample, watchedVessels[i].limit.load(std::memory_order_relaxed), MAX_VALVE_RAW)) {
+        return Trip::VALVE_OVERTEMP;
+      }
+    }
+    // Med fortegn: startGasPhase() kan have flyttet starten en smule forbi now.
+    long gasOnMs = static_cast<long>(now - lastGasOff.load(std::memory_order_relaxed));
+    if (Hal::digitalRead(gasPin) && gasOnMs > static_cast<long>(maxGasOnMs.load(std::memory_order_relaxed))) {
+      return Trip::GAS_ON_TOO_LONG;
+    }
+    unsigned long staleAfter = SafetySupervisor::STALE_FACTOR * TemperatureHandler::getStaleThreshold();
+    if (heatOn() && now - sample.timestamp > staleAfter) {
+      return Trip::SENSORS_STALE;
+    }
+    return Trip::NONE;
+  }
+
+  bool isOvertempTrip(Trip reason) {
+    return reason == Trip::KETTLE_OVERTEMP || reason == Trip::VALVE_OVERTEMP || reason == Trip::VESSEL_OVERTEMP;
+  }
+
+  void trip(Trip reason, unsigned long now, uint8_t vessel = KETTLE_VESSEL) {
+    uint8_t expected = static_cast<uint8_t>(Trip::NONE);
+    if (!tripReason.compare_exchange_strong(expected, static_cast<uint8_t>(reason), std::memory_order_acq_rel)) {
+      return;
+    }
+    trippedAt.store(now, std::memory_order_release);
+    forceOutputsOff();
+    BuzzerHandler::start(BuzzerHandler::Pattern::FAULT);
+    if (isOvertempTrip(reason)) {
+      Serial.printf("[SafetySupervisor] %s (%s) – gas, pumpe og varme er slukket, og alarmen er låst\n",
+                    SafetySupervisor::tripName(reason), VESSEL_PINS[vessel].name);
+    } else {
+      Serial.printf("[SafetySupervisor] %s – gas, pumpe og varme er slukket, og alarmen er låst\n",
+                    SafetySupervisor::tripName(reason));
+    }
+  }
+
+  void check() {
+    unsigned long now = Hal::millis();
+    lastCheck.store(now, std::memory_order_relaxed);
+    checkSeen.store(true, std::memory_order_release);
+    if (!Hal::digitalRead(gasPin)) {
+      lastGasOff.store(now, std::memory_order_relaxed);
+    }
+    if (SafetySupervisor::isTripped()) {
+      // Udgangene holdes nede, også hvis noget uden om relæernes spærre
+      // skriver til dem, og alarmen bliver ved med at lyde, selvom andre
+      // (BuzzerHandler::begin, en ophørt sensoralarm) har stoppet mønstret.
+      forceOutputsOff();
+      BuzzerHandler::start(BuzzerHandler::Pattern::FAULT);
+      return;
+    }
+    uint8_t vessel = KETTLE_VESSEL;
+    Trip reason = evaluate(now, vessel);
+    if (reason == Trip::LOOP_STALLED && !outputsOn()) {
+      // Intet tændt at passe på (fx en WiFi-forbindelse eller OTA i IDLE):
+      // udgangene holdes nede, mens loop() hænger, men alarmen låses ikke og
+      // kræver ingen brygger, når loop() kører igen.
+      forceOutputsOff();
+      if (!stallReported) {
+        stallReported = true;
+        Serial.println("[SafetySupervisor] loop() hænger, men intet er tændt – holder udgangene nede uden alarm");
+      }
+      return;
+    }
+    stallReported = false;
+    if (reason != Trip::NONE) {
+      trip(reason, now, vessel);
+    }
+  }
+
+  void supervisorTask(void *) {
+    bool watched = Hal::watchdogBegin(SafetySupervisor::WATCHDOG_TIMEOUT_S);
+    if (!watched) {
+      Serial.println("[SafetySupervisor] Kunne ikke melde vagten til watchdoggen");
+    }
+    for (;;) {
+      check();
+      if (watched) {
+        Hal::watchdogFeed();
+      }
+      vTaskDelay(pdMS_TO_TICKS(SafetySupervisor::CHECK_MS));
+    }
+  }
+}
+
+void SafetySupervisor::begin(uint8_t gas, uint8_t pump) {
+  gasPin = gas;
+  pumpPin = pump;
+  unsigned long now = Hal::millis();
+  // Som efter en kold opstart, også hvis begin() kaldes igen.
+  tripReason.store(static_cast<uint8_t>(Trip::NONE), std::memory_order_release);
+  heartbeatSeen.store(false, std::memory_order_release);
+  checkSeen.store(false, std::memory_order_release);
+  lastGasOff.store(now, std::memory_order_relaxed);
+
+  if (Hal::wasWatchdogReset()) {
+    trip(Trip::WATCHDOG_RESET, now);
+  }
+
+  if (started) {
+    return;
+  }
+  started = true;
+  TaskHandle_t handle = nullptr;
+  if (xTaskCreatePinnedToCore(supervisorTask, "safety", TASK_STACK_SIZE, nullptr, TASK_PRIORITY, &handle,
+                              TASK_CORE) == pdPASS) {
+    Serial.printf("[SafetySupervisor] Vagten kører på kerne %d\n", static_cast<int>(TASK_CORE));
+  } else if (Hal::startPeriodic(check, CHECK_MS)) {
+    Serial.println("[SafetySupervisor] Ingen task – vagten kører på timeren");
+  } else {
+    Serial.println("[SafetySupervisor] Kunne ikke starte vagten – gassen er uden opsyn!");
+  }
+}
+
+void SafetySupervisor::watchVessel(uint8_t vessel, int8_t sensorIndex, int8_t limitIndex) {
+  if (vessel < VESSEL_COUNT) {
+    watchedVessels[vessel].sensor.store(sensorIndex, std::memory_order_relaxed);
+    watchedVessels[vessel].limit.store(limitIndex, std::memory_order_relaxed);
+  }
+}
+
+void SafetySupervisor::heartbeat() {
+  unsigned long now = Hal::millis();
+  lastHeartbeat.store(now, std::memory_order_relaxed);
+  heartbeatSeen.store(true, std::memory_order_release);
+  // Kernens task-watchdog er normalt sat op til blot at melde, så loop()
+  // holder til gengæld øje med vagten: står den stille, slukkes udgangene, og
+  // enheden genstartes, som watchdoggen ville have gjort.
+  if (checkSeen.load(std::memory_order_acquire) &&
+      static_cast<long>(now - lastCheck.load(std::memory_order_relaxed)) > static_cast<long>(WATCHDOG_TIMEOUT_S * 1000)) {
+    forceOutputsOff();
+    Serial.println("[SafetySupervisor] Vagten svarer ikke – genstarter");
+    Hal::restart();
+  }
+}
+
+void SafetySupervisor::startGasPhase(unsigned long maxSeconds) {
+  maxGasOnMs.store(maxSeconds * 1000UL, std::memory_order_relaxed);
+  lastGasOff.store(Hal::millis(), std::memory_order_relaxed);
+}
+
+unsigned long SafetySupervisor::getMaxGasOnTime() {
+  return maxGasOnMs.load(std::memory_order_relaxed) / 1000;
+}
+
+bool SafetySupervisor::isTripped() {
+  return tripReason.load(std::memory_order_acquire) != static_cast<uint8_t>(Trip::NONE);
+}
+
+SafetySupervisor::Trip SafetySupervisor::getTrip() {
+  return static_cast<Trip>(tripReason.load(std::memory_order_acquire));
+}
+
+unsigned long SafetySupervisor::getTrippedAt() {
+  return trippedAt.load(std::memory_order_acquire);
+}
+
+bool SafetySupervisor::reset() {
+  if (!isTripped()) {
+    return true;
+  }
+  uint8_t vessel = KETTLE_VESSEL;
+  Trip cause = evaluate(Hal::millis(), vessel);
+  if (cause != Trip::NONE) {
+    Serial.printf("[SafetySupervisor] Alarmen kan ikke nulstilles: %s\n", tripName(cause));
+    return false;
+  }
+  Trip was = getTrip();
+  tripReason.store(static_cast<uint8_t>(Trip::NONE), std::memory_order_release);
+  BuzzerHandler::stop(BuzzerHandler::Pattern::FAULT);
+  Serial.printf("[SafetySupervisor] Alarmen (%s) er nulstillet\n", tripName(was));
+  return true;
+}
+
+const char *SafetySupervisor::tripName(Trip trip) {
+  switch (trip) {
+    case Trip::NONE:            return "NONE";
+    case Trip::LOOP_STALLED:    return "LOOP_STALLED";
+    case Trip::SENSORS_STALE:   return "SENSORS_STALE";
+    case Trip::KETTLE_OVERTEMP: return "KETTLE_OVERTEMP";
+    case Trip::VALVE_OVERTEMP:  return "VALVE_OVERTEMP";
+    case Trip::GAS_ON_TOO_LONG: return "GAS_ON_TOO_LONG";
+    case Trip::WATCHDOG_RESET:  return "WATCHDOG_RESET";
+    case Trip::VESSEL_OVERTEMP: return "VESSEL_OVERTEMP";
+  }
+  return "?";
+}
@@ -0,0 +1,231 @@
+#include "SimOneWireBus.h"
+
+namespace {
+  constexpr uint8_t CMD_MATCH_ROM = 0x55;
+  constexpr uint8_t CMD_SKIP_ROM = 0xCC;
+  constexpr uint8_t CMD_SEARCH_ROM = 0xF0;
+  constexpr uint8_t CMD_CONVERT_T = 0x44;
+  constexpr uint8_t CMD_READ_SCRATCHPAD = 0xBE;
+  constexpr uint8_t CMD_WRITE_SCRATCHPAD = 0x4E;
+
+  // DS18B20's scratchpad efter power-on: 85 °C, TH/TL fra EEPROM, 12 bit.
+  const uint8_t POWER_ON_SCRATCHPAD[8] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};
+
+  bool romBit(const OneWireRom rom, uint8_t bit) {
+    return (rom[bit / 8] >> (bit % 8)) & 0x01;
+  }
+}
+
+int8_t SimOneWireBus::addDevice(const OneWireRom rom, float celsius) {
+  if (deviceCount >= MAX_DEVICES) {
+    return -1;
+  }
+  Device &device = devices[deviceCount];
+  memcpy(device.rom, rom, sizeof(OneWireRom));
+  device.temperature = tempRawFromC(celsius);
+  device.present = true;
+  device.selected = false;
+  device.corruptNextRead = false;
+  memcpy(device.scratchpad, POWER_ON_SCRATCHPAD, sizeof(POWER_ON_SCRATCHPAD));
+  updateCrc(device);
+  return deviceCount++;
+}
+
+void SimOneWireBus::setTemperature(uint8_t index, float celsius) {
+  if (index < deviceCount) {
+    devices[index].temperature = tempRawFromC(celsius);
+  }
+}
+
+void SimOneWireBus::setPresent(uint8_t index, bool present) {
+  if (index < deviceCount) {
+    devices[index].present = present;
+  }
+}
+
+void SimOneWireBus::injectCrcError(uint8_t index) {
+  if (index < deviceCount) {
+    devices[index].corruptNextRead = true;
+  }
+}
+
+void SimOneWireBus::injectPowerOnReset(uint8_t index) {
+  if (index < deviceCount) {
+    memcpy(devices[index].scratchpad, POWER_ON_SCRATCHPAD, sizeof(POWER_ON_SCRATCHPAD));
+    updateCrc(devices[index]);
+  }
+}
+
+uint8_t SimOneWireBus::getResolution(uint8_t index) const {
+  return index < deviceCount ? 9 + ((devices[index].scratchpad[4] >> 5) & 0x03) : 0;
+}
+
+bool SimOneWireBus::begin() {
+  state = State::Idle;
+  return true;
+}
+
+bool SimOneWireBus::reset() {
+  transactions++;
+  bool presence = false;
+  for (uint8_t i = 0; i < deviceCount; i++) {
+    devices[i].selected = false;
+    presence = presence || devices[i].present;
+  }
+  state = presence ? State::RomCommand : State::Idle;
+  position = 0;
+  return presence;
+}
+
+void SimOneWireBus::writeBytes(const uint8_t *data, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    handleByte(data[i]);
+  }
+}
+
+void SimOneWireBus::readBytes(uint8_t *data, uint8_t len) {
+  Device *device = singleSelected();
+  for (uint8_t i = 0; i < len; i++) {
+    if (state == State::ReadScratchpad && device && position < sizeof(device->scratchpad)) {
+      uint8_t value = device->scratchpad[position++];
+      if (position == sizeof(device->scratchpad) && device->corruptNextRead) {
+        value ^= 0x01;
+        device->corruptNextRead = false;
+      }
+      data[i] = value;
+    } else {
+      data[i] = 0xFF;  // Ingen driver linjen lav
+    }
+  }
+}
+
+// Under Search ROM svarer alle deltagende sensorer samtidig (wired-AND):
+// først deres bit, derefter komplementet.
+bool SimOneWireBus::readBit() {
+  if (state != State::Search || searchBit >= 64) {
+    return true;
+  }
+  bool level = true;
+  for (uint8_t i = 0; i < deviceCount; i++) {
+    if (devices[i].selected) {
+      bool bit = romBit(devices[i].rom, searchBit);
+      level = level && (searchReadComplement ? !bit : bit);
+    }
+  }
+  searchReadComplement = !searchReadComplement;
+  return level;
+}
+
+void SimOneWireBus::writeBit(bool bit) {
+  if (state != State::Search || searchBit >= 64) {
+    return;
+  }
+  for (uint8_t i = 0; i < deviceCount; i++) {
+    if (devices[i].selected && romBit(devices[i].rom, searchBit) != bit) {
+      devices[i].selected = false;
+    }
+  }
+  searchBit++;
+  searchReadComplement = false;
+}
+
+void SimOneWireBus::handleByte(uint8_t value) {
+  switch (state) {
+    case State::Idle:
+    case State::ReadScratchpad:
+      break;
+
+    case State::RomCommand:
+      if (value == CMD_SKIP_ROM) {
+        for (uint8_t i = 0; i < deviceCount; i++) {
+          devices[i].selected = devices[i].present;
+        }
+        state = State::Function;
+      } else if (value == CMD_MATCH_ROM) {
+        position = 0;
+        state = State::MatchRom;
+      } else if (value == CMD_SEARCH_ROM) {
+        for (uint8_t i = 0; i < deviceCount; i++) {
+          devices[i].selected = devices[i].present;
+        }
+        searchBit = 0;
+        searchReadComplement = false;
+        state = State::Search;
+      } else {
+        state = State::Idle;
+      }
+      break;
+
+    case State::MatchRom:
+      matchRom[position++] = value;
+      if (position == sizeof(OneWireRom)) {
+        for (uint8_t i = 0; i < deviceCount; i++) {
+          devices[i].selected = devices[i].present && memcmp(devices[i].rom, matchRom, sizeof(OneWireRom)) == 0;
+        }
+        position = 0;
+        state = State::Function;
+      }
+      break;
+
+    case State::Search:
+      break;
+
+    case State::Function:
+      if (value == CMD_CONVERT_T) {
+        for (uint8_t i = 0; i < deviceCount; i++) {
+          if (devices[i].selected) {
+            convert(devices[i]);
+          }
+        }
+        state = State::Idle;
+      } else if (value == CMD_READ_SCRATCHPAD) {
+        position = 0;
+        state = State::ReadScratchpad;
+      } else if (value == CMD_WRITE_SCRATCHPAD) {
+        position = 0;
+        state = State::WriteScratchpad;
+      } else {
+        state = State::Idle;
+      }
+      break;
+
+    case State::WriteScratchpad: {
+      Device *device = singleSelected();
+      if (device) {
+        // TH, TL og konfigurationsregister; bit 0-4 i konfigurationen er altid 1.
+        device->scratchpad[2 + position] = (position == 2) ? ((value & 0x60) | 0x1F) : value;
+        updateCrc(*device);
+      }
+      if (++position == 3) {
+        state = State::Idle;
+      }
+      break;
+    }
+  }
+}
+
+void SimOneWireBus::convert(Device &device) {
+  uint8_t unusedBits = 3 - ((device.scratchpad[4] >> 5) & 0x03);
+  int16_t raw = device.temperature & ~((1 << unusedBits) - 1);
+  device.scratchpad[0] = raw & 0xFF;
+  device.scratchpad[1] = (raw >> 8) & 0xFF;
+  device.scratchpad[6] = 0x10 - (raw & 0x0F);
+  updateCrc(device);
+}
+
+void SimOneWireBus::updateCrc(Device &device) {
+  device.scratchpad[8] = crc8(device.scratchpad, 8);
+}
+
+SimOneWireBus::Device *SimOneWireBus::singleSelected() {
+  Device *found = nullptr;
+  for (uint8_t i = 0; i < deviceCount; i++) {
+    if (devices[i].selected) {
+      if (found) {
+        return nullptr;
+      }
+      found = &devices[i];
+    }
+  }
+  return found;
+}
@@ -1,6 +1,6 @@
 #include "StatusLED.h"
+#include "Hal.h"
 #include <Arduino.h>
-#include <esp32-hal-rgb-led.h>
 #include <math.h>
 #include "PinConfig.h"
 
@@ -29,7 +29,7 @@ namespace {
     currentR = r;
     currentG = g;
     currentB = b;
-    neopixelWrite(PIN_RGB_LED, r, g, b);
+    Hal::rgbWrite(PIN_RGB_LED, r, g, b);
   }
 
   void showScaledColor(uint8_t baseR, uint8_t baseG, uint8_t baseB, uint8_t brightness) {
@@ -50,9 +50,9 @@ void StatusLED::begin(uint8_t pin, uint8_t brightness) {
   maxBrightness = brightness;
 
   if (PIN_RGB_LED_PWR >= 0) {
-    pinMode(PIN_RGB_LED_PWR, OUTPUT);
-    digitalWrite(PIN_RGB_LED_PWR, HIGH);
-    delay(10);
+    Hal::pinMode(PIN_RGB_LED_PWR, OUTPUT);
+    Hal::digitalWrite(PIN_RGB_LED_PWR, true);
+    Hal::delay(10);
   }
 
   ledReady = true;
@@ -87,7 +87,7 @@ void StatusLED::update() {
     return;
   }
 
-  unsigned long now = millis();
+  unsigned long now = Hal::millis();
 
   if (awaitingConfirmation) {
     if (now - lastBlinkToggle >= 250) {
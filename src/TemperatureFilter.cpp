@@ -0,0 +1,122 @@
+#include "TemperatureFilter.h"
+#include <Arduino.h>
+
+namespace {
+  // Målestøj (°C²): DS18B20-støj på ca. 0,1 °C inkl. kvantisering ved 10 bit.
+  constexpr float MEASUREMENT_VARIANCE = 0.01f;
+  // Processtøj for hældningen (°C²/s³). Lav værdi = glat dT/dt, men langsommere
+  // reaktion på at gassen slår til/fra.
+  constexpr float RATE_PROCESS_NOISE = 2e-6f;
+  // Startusikkerhed på hældningen (°C/s)²
+  constexpr float INITIAL_RATE_VARIANCE = 0.01f;
+  // En måling, der ligger mere end 1,5 °C fra medianen, betragtes som spike.
+  constexpr TempRaw SPIKE_LIMIT = tempRawFromC(1.5f);
+  constexpr uint8_t SPIKE_MIN_SAMPLES = 3;
+  // Længere pauser end dette begrænses, så P ikke eksploderer efter fx IDLE.
+  constexpr float MAX_DT_SECONDS = 60.0f;
+}
+
+void TemperatureFilter::reset() {
+  windowCount = 0;
+  windowHead = 0;
+  x = 0.0f;
+  v = 0.0f;
+  p00 = p01 = p11 = 0.0f;
+  lastTimestamp = 0;
+  initialized = false;
+}
+
+bool TemperatureFilter::update(TempRaw raw, unsigned long timestampMs) {
+  window[windowHead] = raw;
+  windowHead = (windowHead + 1) % MEDIAN_WINDOW;
+  if (windowCount < MEDIAN_WINDOW) {
+    windowCount++;
+  }
+
+  TempRaw measurement = raw;
+  bool accepted = true;
+  if (windowCount >= SPIKE_MIN_SAMPLES) {
+    TempRaw med = median();
+    int32_t deviation = static_cast<int32_t>(raw) - med;
+    if (deviation > SPIKE_LIMIT || deviation < -SPIKE_LIMIT) {
+      measurement = med;
+      accepted = false;
+    }
+  }
+
+  float z = tempRawToC(measurement);
+  if (!initialized) {
+    x = z;
+    v = 0.0f;
+    p00 = MEASUREMENT_VARIANCE;
+    p01 = 0.0f;
+    p11 = INITIAL_RATE_VARIANCE;
+    lastTimestamp = timestampMs;
+    initialized = true;
+    return accepted;
+  }
+
+  float dt = (timestampMs - lastTimestamp) / 1000.0f;
+  lastTimestamp = timestampMs;
+  if (dt > MAX_DT_SECONDS) {
+    dt = MAX_DT_SECONDS;
+  }
+  if (dt > 0.0f) {
+    predict(dt);
+  }
+  correct(z);
+  return accepted;
+}
+
+SensorEstimate TemperatureFilter::getEstimate() const {
+  SensorEstimate e;
+  e.valid = initialized;
+  e.temp = initialized ? tempRawFromC(x) : TEMP_RAW_INVALID;
+  e.rate = initialized ? v * 60.0f : NAN;
+  e.variance = initialized ? p00 : NAN;
+  return e;
+}
+
+TempRaw TemperatureFilter::median() const {
+  // Maks. fem elementer – indsættelsessortering på en lokal kopi er billigst.
+  TempRaw sorted[MEDIAN_WINDOW];
+  for (uint8_t i = 0; i < windowCount; i++) {
+    TempRaw value = window[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > value) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = value;
+  }
+  return sorted[windowCount / 2];
+}
+
+// Konstant-hældningsmodel: x += v*dt, med hvid støj på accelerationen.
+void TemperatureFilter::predict(float dt) {
+  x += v * dt;
+
+  float dt2 = dt * dt;
+  float n00 = p00 + dt * (2.0f * p01 + dt * p11);
+  float n01 = p01 + dt * p11;
+  p00 = n00 + RATE_PROCESS_NOISE * dt2 * dt2 / 4.0f;
+  p01 = n01 + RATE_PROCESS_NOISE * dt2 * dt / 2.0f;
+  p11 = p11 + RATE_PROCESS_NOISE * dt2;
+}
+
+void TemperatureFilter::correct(float measurement) {
+  float innovation = measurement - x;
+  float s = p00 + MEASUREMENT_VARIANCE;
+  float k0 = p00 / s;
+  float k1 = p01 / s;
+
+  x += k0 * innovation;
+  v += k1 * innovation;
+
+  float n00 = (1.0f - k0) * p00;
+  float n01 = (1.0f - k0) * p01;
+  float n11 = p11 - k1 * p01;
+  p00 = n00;
+  p01 = n01;
+  p11 = n11;
+}
@@ -1,90 +1,563 @@
 #include "TemperatureHandler.h"
-#include <OneWire.h>
+#include "Hal.h"
 #include <Arduino.h>
-#include <DallasTemperature.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 namespace {
-  DallasTemperature* grydeSensor = nullptr;
-  DallasTemperature* ventilSensor = nullptr;
+  constexpr uint8_t SENSOR_RESOLUTION_BITS = 12;  // Standard indtil ProcessHandler vælger andet
+  constexpr uint8_t DS18B20_CONVERT_T = 0x44;
+  constexpr uint8_t DS18B20_READ_SCRATCHPAD = 0xBE;
+  constexpr uint8_t DS18B20_WRITE_SCRATCHPAD = 0x4E;
+  constexpr uint8_t DS18B20_FAMILY = 0x28;
+  constexpr uint8_t SCRATCHPAD_SIZE = 9;
 
-  float grydeTemp = NAN;
-  float ventilTemp = NAN;
-  bool grydeTempValid = false;
-  bool ventilTempValid = false;
+  // Sundhed: efter RETRY_AFTER_ERRORS fejl i træk springes sensoren over med
+  // eksponentielt voksende pause; efter FAIL_AFTER_ERRORS er den FAILED.
+  constexpr uint8_t RETRY_AFTER_ERRORS = 2;
+  constexpr uint8_t FAIL_AFTER_ERRORS = 5;
+  constexpr unsigned long MAX_RETRY_BACKOFF_MS = 30000;
+  constexpr unsigned long STALE_MIN_MS = 5000;
+  constexpr uint8_t STALE_SAMPLE_PERIODS = 3;
+  constexpr uint32_t TASK_STACK_SIZE = 4096;
+  constexpr TempRaw TEMP_RAW_MIN = tempRawFromC(-50.0f);
+  constexpr TempRaw TEMP_RAW_MAX = tempRawFromC(150.0f);
 
-  bool isValidTemperature(float temp) {
-    return temp != DEVICE_DISCONNECTED_C && temp > -50.0f && temp < 150.0f;
-  }
-}
+  // Seqlock med én skriver (måletasken/loop) og vilkårligt mange læsere.
+  // Skriveren gør sekvensnummeret ulige under skrivning; læseren prøver igen,
+  // hvis nummeret var ulige eller ændrede sig undervejs. Efter SEQLOCK_SPINS
+  // forsøg venter læseren en tick mellem forsøgene: en læser med højere
+  // prioritet (sikkerhedsvagten) på skriverens kerne ville ellers spinne,
+  // uden at skriveren nogensinde fik lov at gøre skrivningen færdig.
+  constexpr uint8_t SEQLOCK_SPINS = 8;
 
-void TemperatureHandler::begin(uint8_t grydePin, uint8_t ventilPin) {
-  pinMode(grydePin, INPUT_PULLUP);
-  pinMode(ventilPin, INPUT_PULLUP);
+  template <typename T>
+  class SeqLock {
+  public:
+    void write(const T &value) {
+      uint32_t seq = sequence.load(std::memory_order_relaxed);
+      sequence.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      data = value;
+      std::atomic_thread_fence(std::memory_order_release);
+      sequence.store(seq + 2, std::memory_order_release);
+    }
 
-  static OneWire grydeWire(grydePin);
-  static OneWire ventilWire(ventilPin);
-  static DallasTemperature grydeDallas(&grydeWire);
-  static DallasTemperature ventilDallas(&ventilWire);
+    T read() const {
+      T copy;
+      for (uint8_t attempt = 0;; attempt++) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        copy = data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = sequence.load(std::memory_order_relaxed);
+        if (!(before & 1u) && before == after) {
+          return copy;
+        }
+        if (attempt >= SEQLOCK_SPINS) {
+          vTaskDelay(1);
+        }
+      }
+    }
 
-  grydeSensor = &grydeDallas;
-  ventilSensor = &ventilDallas;
+  private:
+    std::atomic<uint32_t> sequence{0};
+    T data{};
+  };
 
-  grydeSensor->begin();
-  ventilSensor->begin();
+  // Konverteringen kører som en to-faset tilstandsmaskine:
+  // Idle -> (requestTemperatures på begge busser) -> Converting -> (deadline) -> læs scratchpads -> Idle
+  enum class Phase { Idle, Converting };
 
-  grydeSensor->setWaitForConversion(true);
-  ventilSensor->setWaitForConversion(true);
-  grydeSensor->setResolution(12);
-  ventilSensor->setResolution(12);
-}
+  enum class ReadResult { Ok, NoResponse, CrcError, ResetValue, OutOfRange };
 
-void TemperatureHandler::readTemperatures() {
-  grydeTempValid = false;
-  ventilTempValid = false;
+  // En fundet sensor: hvilken bus den sidder på, dens 64-bit ROM-kode og navn.
+  struct SensorSlot {
+    OneWireBus* bus;
+    OneWireRom address;
+    char name[SENSOR_NAME_LENGTH];
+    TempRaw lastTemp;
+    SensorHealth health;
+    uint8_t errorCount;        // Fejl i træk
+    unsigned long lastGoodTime;
+    unsigned long nextRetryTime;
+    unsigned long backoff;
+  };
 
-  if (grydeSensor) {
-    auto request = grydeSensor->requestTemperatures();
-    if (!request) {
-      Serial.println("Fejl: Gryde-sensor svarede ikke på request");
-    } else {
-      float temp = grydeSensor->getTempCByIndex(0);
-      if (isValidTemperature(temp)) {
-        grydeTemp = temp;
-        grydeTempValid = true;
-      } else {
-        Serial.println("Fejl: Ugyldig gryde-temperatur");
+  OneWireBus* grydeBus = nullptr;
+  OneWireBus* ventilBus = nullptr;
+
+  SensorSlot sensors[MAX_TEMP_SENSORS];
+  TemperatureFilter filters[MAX_TEMP_SENSORS];
+  uint8_t sensorCount = 0;
+  int8_t grydeIndex = -1;   // Første sensor på grydebussen
+  int8_t ventilIndex = -1;  // Første sensor på ventilbussen
+
+  Phase phase = Phase::Idle;
+  std::atomic<unsigned long> sampleInterval{1000};
+  std::atomic<uint8_t> requestedResolution{SENSOR_RESOLUTION_BITS};
+  uint8_t resolution = SENSOR_RESOLUTION_BITS;
+  unsigned long conversionTime = 750;
+  unsigned long lastRequestTime = 0;
+  unsigned long conversionStart = 0;
+  bool firstRequest = true;
+  uint32_t sampleSequence = 0;
+
+  SeqLock<TemperatureSnapshot> snapshot;
+  SeqLock<AcquisitionStats> stats;
+  AcquisitionStats taskStats = {0, 0, 0, 0, 0.0f};
+  TaskHandle_t taskHandle = nullptr;
+
+  bool isValidTemperature(TempRaw raw) {
+    return raw > TEMP_RAW_MIN && raw < TEMP_RAW_MAX;
+  }
+
+  // DS18B20: 93,75 ms ved 9 bit, fordoblet for hver ekstra bit.
+  unsigned long conversionTimeFor(uint8_t bits) {
+    return 750UL >> (12 - bits);
+  }
+
+  // MATCH ROM + Read Scratchpad (9 bytes inkl. CRC).
+  bool readScratchpad(SensorSlot &slot, uint8_t *sp) {
+    if (!slot.bus->reset()) {
+      return false;
+    }
+    slot.bus->select(slot.address);
+    slot.bus->write(DS18B20_READ_SCRATCHPAD);
+    slot.bus->readBytes(sp, SCRATCHPAD_SIZE);
+    return true;
+  }
+
+  // Skriver kun konfigurationsregisteret i scratchpad'en (TH/TL bevares). Der
+  // sendes ikke Copy Scratchpad, så sensorens EEPROM slides ikke ved hvert skift,
+  // og der er ingen 20 ms ventetid som ved en EEPROM-skrivning.
+  bool programResolution(SensorSlot &slot, uint8_t bits) {
+    uint8_t sp[SCRATCHPAD_SIZE];
+    if (!readScratchpad(slot, sp) || OneWireBus::crc8(sp, SCRATCHPAD_SIZE) != 0) {
+      return false;
+    }
+    uint8_t config = static_cast<uint8_t>(((bits - 9) << 5) | 0x1F);
+    if (sp[4] == config) {
+      return true;
+    }
+    if (!slot.bus->reset()) {
+      return false;
+    }
+    slot.bus->select(slot.address);
+    uint8_t frame[4] = {DS18B20_WRITE_SCRATCHPAD, sp[2], sp[3], config};
+    slot.bus->writeBytes(frame, sizeof(frame));
+    return slot.bus->reset();
+  }
+
+  // Anvendes kun mellem to konverteringer, så en igangværende måling aldrig
+  // læses med en anden opløsning end den blev startet med.
+  void applyResolution() {
+    uint8_t bits = requestedResolution.load(std::memory_order_relaxed);
+    if (bits == resolution) {
+      return;
+    }
+    for (uint8_t i = 0; i < sensorCount; i++) {
+      if (!programResolution(sensors[i], bits)) {
+        Serial.printf("Fejl: Kunne ikke sætte opløsning på %s\n", sensors[i].name);
       }
     }
+    resolution = bits;
+    conversionTime = conversionTimeFor(bits);
+    Serial.printf("[TemperatureHandler] Opløsning %u bit (%lu ms)\n", bits, conversionTime);
+  }
+
+  // Sender Convert T til alle sensorer på bussen (SKIP ROM) uden at vente på resultatet.
+  bool requestConversion(OneWireBus* bus, const char* label) {
+    if (!bus) {
+      return false;
+    }
+    if (!bus->reset()) {
+      Serial.printf("Fejl: %s-sensor svarede ikke på request\n", label);
+      return false;
+    }
+    bus->skip();
+    bus->write(DS18B20_CONVERT_T);
+    return true;
   }
 
-  if (ventilSensor) {
-    auto request = ventilSensor->requestTemperatures();
-    if (!request) {
-      Serial.println("Fejl: Ventil-sensor svarede ikke på request");
-    } else {
-      float temp = ventilSensor->getTempCByIndex(0);
-      if (isValidTemperature(temp)) {
-        ventilTemp = temp;
-        ventilTempValid = true;
+  // Søger bussen igennem én gang og gemmer ROM-koderne, så efterfølgende
+  // læsninger kan bruge MATCH ROM i stedet for en fuld OneWire-søgning.
+  int8_t discoverSensors(OneWireBus* bus, const char* label) {
+    int8_t first = -1;
+    uint8_t found = 0;
+    if (!bus) {
+      Serial.printf("Fejl: Ingen 1-Wire-bus til %s\n", label);
+      return first;
+    }
+    bus->resetSearch();
+    while (sensorCount < MAX_TEMP_SENSORS) {
+      SensorSlot &slot = sensors[sensorCount];
+      if (!bus->search(slot.address)) {
+        break;
+      }
+      if (slot.address[0] != DS18B20_FAMILY) {
+        continue;
+      }
+      slot.bus = bus;
+      slot.lastTemp = TEMP_RAW_INVALID;
+      slot.health = SensorHealth::OK;
+      slot.errorCount = 0;
+      slot.lastGoodTime = Hal::millis();
+      slot.nextRetryTime = 0;
+      slot.backoff = 0;
+      filters[sensorCount].reset();
+      if (found == 0) {
+        snprintf(slot.name, sizeof(slot.name), "%s", label);
       } else {
-        Serial.println("Fejl: Ugyldig ventil-temperatur");
+        snprintf(slot.name, sizeof(slot.name), "%s %u", label, found + 1);
       }
+      programResolution(slot, resolution);
+      Serial.printf("[TemperatureHandler] %s: %02X%02X%02X%02X%02X%02X%02X%02X\n", slot.name,
+                    slot.address[0], slot.address[1], slot.address[2], slot.address[3],
+                    slot.address[4], slot.address[5], slot.address[6], slot.address[7]);
+      if (first < 0) {
+        first = sensorCount;
+      }
+      sensorCount++;
+      found++;
+    }
+    if (found == 0) {
+      Serial.printf("Fejl: Ingen sensorer fundet på %s-bussen\n", label);
     }
+    return first;
   }
+
+  unsigned long staleThreshold() {
+    unsigned long byPeriod = STALE_SAMPLE_PERIODS * sampleInterval.load(std::memory_order_relaxed);
+    return byPeriod > STALE_MIN_MS ? byPeriod : STALE_MIN_MS;
+  }
+
+  ReadResult collectTemperature(SensorSlot &slot, TempRaw &out) {
+    // Adresseret læsning: MATCH ROM + én scratchpad-læsning (9 bytes inkl. CRC)
+    uint8_t sp[SCRATCHPAD_SIZE];
+    if (!readScratchpad(slot, sp)) {
+      Serial.printf("Fejl: %s svarede ikke\n", slot.name);
+      return ReadResult::NoResponse;
+    }
+    // CRC over alle 9 bytes giver 0 for en korrekt scratchpad. En bus uden
+    // svar læses som lutter nuller, som også har CRC 0 – den afvises separat.
+    if (OneWireBus::crc8(sp, SCRATCHPAD_SIZE) != 0 || (sp[4] == 0 && sp[0] == 0 && sp[1] == 0)) {
+      Serial.printf("Fejl: CRC-fejl fra %s\n", slot.name);
+      return ReadResult::CrcError;
+    }
+    // Power-on-værdien 85 °C kendes på byte 6 = 0x0C (en ægte 85,0 °C giver 0x10).
+    // Sensoren har været spændingsløs, så opløsningen skal programmeres igen.
+    if (sp[0] == 0x50 && sp[1] == 0x05 && sp[6] == 0x0C) {
+      Serial.printf("Fejl: %s har nulstillet (85 °C)\n", slot.name);
+      programResolution(slot, resolution);
+      return ReadResult::ResetValue;
+    }
+    // Har sensoren været nulstillet mellem to målinger, står den igen på
+    // EEPROM-opløsningen – den aktuelle måling er gyldig, men næste skal følge politikken.
+    if (((sp[4] >> 5) & 0x03) != resolution - 9) {
+      programResolution(slot, resolution);
+    }
+    TempRaw temp = tempRawFromScratchpad(sp);
+    if (!isValidTemperature(temp)) {
+      Serial.printf("Fejl: Ugyldig temperatur fra %s\n", slot.name);
+      return ReadResult::OutOfRange;
+    }
+    out = temp;
+    return ReadResult::Ok;
+  }
+
+  bool isRetryDue(const SensorSlot &slot, unsigned long now) {
+    return slot.errorCount < RETRY_AFTER_ERRORS || static_cast<long>(now - slot.nextRetryTime) >= 0;
+  }
+
+  void updateHealth(SensorSlot &slot, bool attempted, bool good, bool suspect, unsigned long now) {
+    SensorHealth previous = slot.health;
+    if (good) {
+      slot.errorCount = 0;
+      slot.backoff = 0;
+      slot.lastGoodTime = now;
+      slot.health = suspect ? SensorHealth::SUSPECT : SensorHealth::OK;
+    } else if (attempted) {
+      if (slot.errorCount < UINT8_MAX) {
+        slot.errorCount++;
+      }
+      slot.health = (slot.errorCount >= FAIL_AFTER_ERRORS) ? SensorHealth::FAILED : SensorHealth::SUSPECT;
+      if (slot.errorCount >= RETRY_AFTER_ERRORS) {
+        unsigned long interval = sampleInterval.load(std::memory_order_relaxed);
+        slot.backoff = slot.backoff ? slot.backoff * 2 : interval;
+        if (slot.backoff > MAX_RETRY_BACKOFF_MS) {
+          slot.backoff = MAX_RETRY_BACKOFF_MS;
+        }
+        slot.nextRetryTime = now + slot.backoff;
+      }
+    }
+    if (slot.health != SensorHealth::FAILED && now - slot.lastGoodTime > staleThreshold()) {
+      slot.health = SensorHealth::STALE;
+    }
+    if (slot.health != previous) {
+      Serial.printf("[TemperatureHandler] %s: %s -> %s\n", slot.name, sensorHealthName(previous),
+                    sensorHealthName(slot.health));
+    }
+  }
+
+  void startConversion() {
+    applyResolution();
+    // Begge busser startes lige efter hinanden, så målingerne stammer fra samme tidspunkt.
+    requestConversion(grydeBus, "Gryde");
+    requestConversion(ventilBus, "Ventil");
+    conversionStart = Hal::millis();
+    phase = Phase::Converting;
+  }
+
+  void collectAndPublish() {
+    TemperatureSnapshot s = {};
+    s.sensorCount = sensorCount;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+      SensorSlot &slot = sensors[i];
+      // En sensor i backoff læses ikke – den springes blot over i denne runde.
+      bool attempted = isRetryDue(slot, conversionStart);
+      s.valid[i] = attempted && collectTemperature(slot, slot.lastTemp) == ReadResult::Ok;
+      s.temps[i] = s.valid[i] ? slot.lastTemp : TEMP_RAW_INVALID;
+      bool spike = false;
+      // Efter et udfald starter filteret forfra, så gamle værdier i median-
+      // vinduet ikke får den første friske måling til at ligne en spike.
+      if (s.valid[i] && !isSensorUsable(slot.health)) {
+        filters[i].reset();
+      }
+      if (s.valid[i] && !filters[i].update(s.temps[i], conversionStart)) {
+        Serial.printf("[TemperatureHandler] Spike afvist fra %s\n", slot.name);
+        spike = true;
+      }
+      updateHealth(slot, attempted, s.valid[i], spike, conversionStart);
+      s.health[i] = slot.health;
+      s.estimates[i] = filters[i].getEstimate();
+      // Et estimat uden en frisk måling bag sig må ikke bruges til styring.
+      s.estimates[i].valid = s.estimates[i].valid && s.valid[i];
+    }
+    s.grydeValid = (grydeIndex >= 0) && s.valid[grydeIndex];
+    s.ventilValid = (ventilIndex >= 0) && s.valid[ventilIndex];
+    s.grydeTemp = s.grydeValid ? s.temps[grydeIndex] : TEMP_RAW_INVALID;
+    s.ventilTemp = s.ventilValid ? s.temps[ventilIndex] : TEMP_RAW_INVALID;
+    s.grydeHealth = (grydeIndex >= 0) ? s.health[grydeIndex] : SensorHealth::FAILED;
+    s.ventilHealth = (ventilIndex >= 0) ? s.health[ventilIndex] : SensorHealth::FAILED;
+    s.grydeEstimate = (grydeIndex >= 0) ? s.estimates[grydeIndex] : SensorEstimate{TEMP_RAW_INVALID, NAN, NAN, false};
+    s.ventilEstimate = (ventilIndex >= 0) ? s.estimates[ventilIndex] : SensorEstimate{TEMP_RAW_INVALID, NAN, NAN, false};
+    s.timestamp = conversionStart;
+    s.sequence = ++sampleSequence;
+    snapshot.write(s);
+    phase = Phase::Idle;
+  }
+
+  void recordPeriod(unsigned long cycleStart) {
+    static unsigned long previousStart = 0;
+    unsigned long interval = sampleInterval.load(std::memory_order_relaxed);
+    if (taskStats.samples > 0) {
+      unsigned long period = cycleStart - previousStart;
+      unsigned long jitter = (period > interval) ? (period - interval) : (interval - period);
+      taskStats.period = period;
+      taskStats.lastJitter = jitter;
+      if (jitter > taskStats.maxJitter) {
+        taskStats.maxJitter = jitter;
+      }
+      // Glidende gennemsnit over ca. 16 perioder
+      taskStats.avgJitter += (jitter - taskStats.avgJitter) / 16.0f;
+    }
+    previousStart = cycleStart;
+    taskStats.samples++;
+    stats.write(taskStats);
+  }
+
+  void acquisitionTask(void*) {
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+      recordPeriod(Hal::millis());
+      startConversion();
+      vTaskDelay(pdMS_TO_TICKS(conversionTime));
+      collectAndPublish();
+      // Som vTaskDelayUntil(), men setSampleInterval() kan vække tasken, så et
+      // skift fra langsom til hurtig måling slår igennem med det samme.
+      TickType_t next = lastWake + pdMS_TO_TICKS(sampleInterval.load(std::memory_order_relaxed));
+      TickType_t now = xTaskGetTickCount();
+      if (static_cast<int32_t>(next - now) > 0 && ulTaskNotifyTake(pdTRUE, next - now) > 0) {
+        next = xTaskGetTickCount();
+      }
+      lastWake = next;
+    }
+  }
+}
+
+void TemperatureHandler::begin(uint8_t grydePin, uint8_t ventilPin, unsigned long sampleIntervalMs) {
+  // Hal vælger transporten (RMT på ESP32-S3, simuleret bus i env:native).
+  begin(Hal::oneWireBus(grydePin), Hal::oneWireBus(ventilPin), sampleIntervalMs);
+}
+
+void TemperatureHandler::begin(OneWireBus* gryde, OneWireBus* ventil, unsigned long sampleIntervalMs) {
+  grydeBus = gryde;
+  ventilBus = ventil;
+
+  sensorCount = 0;
+  resolution = requestedResolution.load(std::memory_order_relaxed);
+  grydeIndex = discoverSensors(grydeBus, "Gryde");
+  ventilIndex = discoverSensors(ventilBus, "Ventil");
+  conversionTime = conversionTimeFor(resolution);
+
+  sampleInterval = sampleIntervalMs;
+  phase = Phase::Idle;
+  firstRequest = true;
+}
+
+bool TemperatureHandler::startTask(uint8_t core, uint8_t priority) {
+  if (taskHandle) {
+    return true;
+  }
+  BaseType_t result = xTaskCreatePinnedToCore(acquisitionTask, "tempAcq", TASK_STACK_SIZE,
+                                              nullptr, priority, &taskHandle, core);
+  if (result != pdPASS) {
+    taskHandle = nullptr;
+    Serial.println("[TemperatureHandler] Kunne ikke starte måletask – falder tilbage til loop()");
+    return false;
+  }
+  Serial.printf("[TemperatureHandler] Måletask startet på kerne %u\n", core);
+  return true;
+}
+
+bool TemperatureHandler::update() {
+  if (taskHandle) {
+    return false;
+  }
+  unsigned long now = Hal::millis();
+
+  switch (phase) {
+    case Phase::Idle:
+      if (!firstRequest && (now - lastRequestTime < sampleInterval)) {
+        return false;
+      }
+      firstRequest = false;
+      lastRequestTime = now;
+      startConversion();
+      return false;
+
+    case Phase::Converting:
+      if (now - conversionStart < conversionTime) {
+        return false;
+      }
+      collectAndPublish();
+      return true;
+  }
+  return false;
+}
+
+void TemperatureHandler::setSampleInterval(unsigned long intervalMs) {
+  unsigned long previous = sampleInterval.exchange(intervalMs);
+  if (taskHandle && intervalMs < previous) {
+    xTaskNotifyGive(taskHandle);
+  }
+}
+
+void TemperatureHandler::setResolution(uint8_t bits) {
+  requestedResolution = constrain(bits, static_cast<uint8_t>(9), static_cast<uint8_t>(12));
+}
+
+uint8_t TemperatureHandler::getResolution() {
+  return resolution;
+}
+
+bool TemperatureHandler::isConversionPending() {
+  return phase == Phase::Converting;
+}
+
+TemperatureSnapshot TemperatureHandler::getSnapshot() {
+  return snapshot.read();
+}
+
+AcquisitionStats TemperatureHandler::getStats() {
+  return stats.read();
 }
 
-float TemperatureHandler::getGrydeTemp() {
-  return grydeTempValid ? grydeTemp : NAN;
+uint8_t TemperatureHandler::getSensorCount() {
+  return sensorCount;
 }
 
-float TemperatureHandler::getVentilTemp() {
-  return ventilTempValid ? ventilTemp : NAN;
+const char* TemperatureHandler::getSensorName(uint8_t index) {
+  return index < sensorCount ? sensors[index].name : "";
+}
+
+void TemperatureHandler::setSensorName(uint8_t index, const char* name) {
+  if (index < sensorCount && name) {
+    snprintf(sensors[index].name, sizeof(sensors[index].name), "%s", name);
+  }
+}
+
+bool TemperatureHandler::getSensorAddress(uint8_t index, OneWireRom address) {
+  if (index >= sensorCount) {
+    return false;
+  }
+  memcpy(address, sensors[index].address, sizeof(OneWireRom));
+  return true;
+}
+
+int8_t TemperatureHandler::findSensor(const char* name) {
+  for (uint8_t i = 0; i < sensorCount; i++) {
+    if (strcmp(sensors[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+unsigned long TemperatureHandler::getLastSampleTime() {
+  return getSnapshot().timestamp;
+}
+
+TempRaw TemperatureHandler::getGrydeTemp() {
+  return getSnapshot().grydeTemp;
+}
+
+TempRaw TemperatureHandler::getVentilTemp() {
+  return getSnapshot().ventilTemp;
 }
 
 bool TemperatureHandler::isGrydeValid() {
-  return grydeTempValid;
+  return getSnapshot().grydeValid;
 }
 
 bool TemperatureHandler::isVentilValid() {
-  return ventilTempValid;
+  return getSnapshot().ventilValid;
+}
+
+SensorEstimate TemperatureHandler::getGrydeEstimate() {
+  return getSnapshot().grydeEstimate;
+}
+
+SensorEstimate TemperatureHandler::getVentilEstimate() {
+  return getSnapshot().ventilEstimate;
+}
+
+SensorEstimate TemperatureHandler::getEstimate(uint8_t index) {
+  TemperatureSnapshot s = getSnapshot();
+  if (index >= s.sensorCount) {
+    return SensorEstimate{TEMP_RAW_INVALID, NAN, NAN, false};
+  }
+  return s.estimates[index];
+}
+
+SensorHealth TemperatureHandler::checkStaleness(SensorHealth published, unsigned long timestamp) {
+  if (published == SensorHealth::FAILED) {
+    return published;
+  }
+  return (Hal::millis() - timestamp > staleThreshold()) ? SensorHealth::STALE : published;
+}
+
+unsigned long TemperatureHandler::getStaleThreshold() {
+  return staleThreshold();
+}
+
+SensorHealth TemperatureHandler::getGrydeHealth() {
+  TemperatureSnapshot s = getSnapshot();
+  return checkStaleness(s.grydeHealth, s.timestamp);
+}
+
+SensorHealth TemperatureHandler::getVentilHealth() {
+  TemperatureSnapshot s = getSnapshot();
+  return checkStaleness(s.ventilHealth, s.timestamp);
 }
@@ -0,0 +1,244 @@
+#include "ThermalModel.h"
+#include <Arduino.h>
+
+namespace {
+  // Regressoren centreres om en typisk mæsketemperatur, så kolonnerne i φ har
+  // sammenlignelig størrelse (bedre konditionering i float).
+  constexpr float T_REF = 60.0f;
+  // Glemselsfaktor: ca. 1/(1−λ) = 500 samples ≈ 80 min hukommelse.
+  constexpr float FORGETTING = 0.998f;
+  constexpr float INITIAL_COVARIANCE = 100.0f;
+  // Uden variation i gassen vokser P i den uexciterede retning; begrænses her.
+  constexpr float MAX_COVARIANCE_TRACE = 1.0e4f;
+  constexpr float ERROR_SMOOTHING = 0.05f;
+  constexpr uint16_t MIN_SAMPLES = 18;           // 3 min
+  constexpr uint16_t MIN_EXCITATION_SAMPLES = 6; // Hele samples med gas til hhv. fra
+  // θ2 = −Ts/τ: fra meget hurtigt tab (τ = 100 s) til et svagt positivt
+  // estimat, som støj kan give, når tabet er lille.
+  constexpr float THETA2_MIN = -0.1f;
+  constexpr float THETA2_MAX = 0.001f;
+  constexpr uint16_t ETA_HORIZON = 3 * 360;      // 3 timer
+}
+
+void ThermalModel::reset() {
+  for (Estimator &est : estimators) {
+    initEstimator(est);
+  }
+  inputCount = 0;
+  haveTemp = false;
+  sampling = false;
+  gasOnSamples = 0;
+  gasOffSamples = 0;
+}
+
+void ThermalModel::initEstimator(Estimator &est) {
+  for (uint8_t i = 0; i < 3; i++) {
+    est.theta[i] = 0.0f;
+    for (uint8_t j = 0; j < 3; j++) {
+      est.p[i][j] = i == j ? INITIAL_COVARIANCE : 0.0f;
+    }
+  }
+  est.errorVar = 0.0f;
+  est.samples = 0;
+}
+
+void ThermalModel::pause() {
+  sampling = false;
+  inputCount = 0;
+}
+
+void ThermalModel::update(float temperatureC, bool gasOn, unsigned long nowMs, bool adapt) {
+  if (!sampling) {
+    if (!haveTemp) {
+      reset();
+    }
+    sampling = true;
+    sampleStart = nowMs;
+    lastUpdateMs = nowMs;
+    gasOnMs = 0;
+    lastGas = gasOn;
+    lastTemp = temperatureC;
+    haveTemp = true;
+    return;
+  }
+
+  // Gassen har haft sin forrige tilstand siden sidste kald.
+  if (lastGas) {
+    gasOnMs += nowMs - lastUpdateMs;
+  }
+  lastUpdateMs = nowMs;
+  lastGas = gasOn;
+
+  unsigned long elapsed = nowMs - sampleStart;
+  if (elapsed < SAMPLE_MS) {
+    return;
+  }
+  for (uint8_t i = MAX_DELAY; i > 0; i--) {
+    inputs[i] = inputs[i - 1];
+  }
+  inputs[0] = constrain(static_cast<float>(gasOnMs) / elapsed, 0.0f, 1.0f);
+  if (inputCount <= MAX_DELAY) {
+    inputCount++;
+  }
+  sampleStart = nowMs;
+  gasOnMs = 0;
+  completeSample(temperatureC, adapt);
+}
+
+void ThermalModel::completeSample(float temperatureC, bool adapt) {
+  float y = temperatureC - lastTemp;
+  float x = lastTemp - T_REF;
+  for (uint8_t d = 0; adapt && d <= MAX_DELAY; d++) {
+    if (inputCount > d) {
+      const float phi[3] = {inputs[d], x, 1.0f};
+      updateEstimator(estimators[d], phi, y);
+    }
+  }
+  lastTemp = temperatureC;
+  if (!adapt) {
+    return;
+  }
+
+  if (inputs[0] > 0.9f && gasOnSamples < UINT16_MAX) {
+    gasOnSamples++;
+  } else if (inputs[0] < 0.1f && gasOffSamples < UINT16_MAX) {
+    gasOffSamples++;
+  }
+}
+
+void ThermalModel::updateEstimator(Estimator &est, const float phi[3], float y) {
+  float pPhi[3];
+  float denom = FORGETTING;
+  float prediction = 0.0f;
+  for (uint8_t i = 0; i < 3; i++) {
+    pPhi[i] = est.p[i][0] * phi[0] + est.p[i][1] * phi[1] + est.p[i][2] * phi[2];
+    denom += phi[i] * pPhi[i];
+    prediction += est.theta[i] * phi[i];
+  }
+  float error = y - prediction;
+
+  float trace = 0.0f;
+  for (uint8_t i = 0; i < 3; i++) {
+    float gain = pPhi[i] / denom;
+    est.theta[i] += gain * error;
+    for (uint8_t j = 0; j < 3; j++) {
+      est.p[i][j] = (est.p[i][j] - gain * pPhi[j]) / FORGETTING;
+    }
+    trace += est.p[i][i];
+  }
+  if (trace > MAX_COVARIANCE_TRACE) {
+    float scale = MAX_COVARIANCE_TRACE / trace;
+    for (uint8_t i = 0; i < 3; i++) {
+      for (uint8_t j = 0; j < 3; j++) {
+        est.p[i][j] *= scale;
+      }
+    }
+  }
+
+  est.errorVar = est.samples == 0 ? error * error : est.errorVar + (error * error - est.errorVar) * ERROR_SMOOTHING;
+  if (est.samples < UINT16_MAX) {
+    est.samples++;
+  }
+}
+
+const ThermalModel::Estimator *ThermalModel::best() const {
+  const Estimator *result = nullptr;
+  for (const Estimator &est : estimators) {
+    if (est.samples >= MIN_SAMPLES && (!result || est.errorVar < result->errorVar)) {
+      result = &est;
+    }
+  }
+  return result;
+}
+
+bool ThermalModel::isValid() const {
+  const Estimator *est = best();
+  return est && haveTemp && est->theta[1] >= THETA2_MIN && est->theta[1] <= THETA2_MAX;
+}
+
+bool ThermalModel::canPredictCutoff() const {
+  return isValid() && best()->theta[0] > 0.0f && gasOnSamples >= MIN_EXCITATION_SAMPLES &&
+         gasOffSamples >= MIN_EXCITATION_SAMPLES;
+}
+
+// Gassen i prædiktionsskridt i: historikken, så længe dødtiden rækker, og
+// derefter futureInput. Index −1 er det igangværende (ufuldstændige) sample.
+float ThermalModel::inputAt(int8_t index, float futureInput) const {
+  if (index >= 0 && index < inputCount) {
+    return inputs[index];
+  }
+  return futureInput;
+}
+
+float ThermalModel::step(const Estimator &est, float temp, float input) const {
+  return temp + est.theta[0] * input + est.theta[1] * (temp - T_REF) + est.theta[2];
+}
+
+bool ThermalModel::estimateSecondsTo(float targetC, unsigned long &seconds) const {
+  if (!isValid()) {
+    return false;
+  }
+  const Estimator &est = *best();
+  int8_t delay = &est - estimators;
+  unsigned long sinceSample = (lastUpdateMs - sampleStart) / 1000;
+  float temp = lastTemp;
+  if (temp >= targetC) {
+    seconds = 0;
+    return true;
+  }
+  for (uint16_t i = 0; i < ETA_HORIZON; i++) {
+    temp = step(est, temp, inputAt(delay - i - 1, 1.0f));
+    if (temp >= targetC) {
+      unsigned long ahead = (i + 1) * (SAMPLE_MS / 1000);
+      seconds = ahead > sinceSample ? ahead - sinceSample : 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThermalModel::predictPeakIfOff(float &peakC) const {
+  if (!canPredictCutoff()) {
+    return false;
+  }
+  const Estimator &est = *best();
+  int8_t delay = &est - estimators;
+  // Gassen, der allerede er givet i det igangværende sample, er også på vej.
+  float partial = sampling ? constrain(static_cast<float>(gasOnMs) / SAMPLE_MS, 0.0f, 1.0f) : 0.0f;
+  // Kun gassen, der allerede er på vej gennem dødtiden, kan løfte
+  // temperaturen; tabsleddet kan kun køle, da gryden er over omgivelserne.
+  // Under en lang opvarmning med konstant gas skelner RLS dårligt mellem θ1
+  // og θ3, og uden den begrænsning kan et for stort θ3 "varme" videre.
+  float temp = lastTemp;
+  float peak = temp;
+  for (int8_t index = delay - 1; index >= -1; index--) {
+    float input = index == -1 ? partial : inputAt(index, 0.0f);
+    float loss = min(0.0f, est.theta[1] * (temp - T_REF) + est.theta[2]);
+    temp += est.theta[0] * input + loss;
+    peak = max(peak, temp);
+  }
+  peakC = peak;
+  return true;
+}
+
+float ThermalModel::getTauS() const {
+  const Estimator *est = best();
+  if (!est || est->theta[1] >= 0.0f) {
+    return 0.0f;
+  }
+  return -(SAMPLE_MS / 1000.0f) / est->theta[1];
+}
+
+float ThermalModel::getDeadTimeS() const {
+  const Estimator *est = best();
+  return est ? (est - estimators) * (SAMPLE_MS / 1000.0f) : 0.0f;
+}
+
+float ThermalModel::getHeatRate() const {
+  const Estimator *est = best();
+  if (!est) {
+    return 0.0f;
+  }
+  float perSample = est->theta[0] + est->theta[1] * (lastTemp - T_REF) + est->theta[2];
+  return perSample * 60000.0f / SAMPLE_MS;
+}
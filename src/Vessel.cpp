@@ -0,0 +1,1583 @@
+#include "Vessel.h"
+#include "ProcessHandler.h"
+#include "EEPROMHandler.h"
+#include "Hal.h"
+#include "Clock.h"
+#include "BuzzerHandler.h"
+#include "SafetySupervisor.h"
+#include <Arduino.h>
+#include <stdio.h>
+// Proces state ligger efter Config (som starter på adresse 0) i samme EEPROM.
+#define EEPROM_PROCESS_STATE_START 256
+static_assert(sizeof(Config) <= EEPROM_PROCESS_STATE_START, "Config overlapper proces state i EEPROM");
+
+// Forventet opvarmningstid til kog (i sekunder). Kogepunktet findes af
+// BoilDetector; er det ikke fundet, når tiden er gået, beder LED'en om en
+// manuel bekræftelse, mens detektoren leder videre.
+static const unsigned long boilHeatupTime = 10 * 60;
+
+namespace {
+  // "Mæskning", "Mæskning 2/3" eller "Udmæskning": sidste trin i en plan med
+  // flere trin er udmæskningen, og rasterne nummereres kun, når der er flere.
+  String mashStepName(uint8_t index, uint8_t count, const char *mashing, const char *mashout) {
+    uint8_t rests = count > 1 ? count - 1 : count;
+    if (count > 1 && index == count - 1) {
+      return mashout;
+    }
+    if (rests == 1) {
+      return mashing;
+    }
+    return String(mashing) + " " + String(index + 1) + "/" + String(rests);
+  }
+
+  // Samme trin med samme tider og politik; kun temperaturerne må afvige.
+  bool sameTiming(const MashSchedule &a, const MashSchedule &b) {
+    if (a.count != b.count) {
+      return false;
+    }
+    for (uint8_t i = 0; i < a.count; i++) {
+      const MashStep &x = a.steps[i];
+      const MashStep &y = b.steps[i];
+      if (x.minutes != y.minutes || x.pump != y.pump || x.gas != y.gas || x.confirmStart != y.confirmStart ||
+          x.confirmEnd != y.confirmEnd) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Sensorens filtrerede måling og sundhed set fra læserens side. En sensor,
+  // der ikke blev fundet, er FAILED; før det første målesæt er den STALE.
+  void readSensor(const TemperatureSnapshot &sample, int8_t index, TempRaw &temp, SensorHealth &health) {
+    temp = TEMP_RAW_INVALID;
+    if (index < 0) {
+      health = SensorHealth::FAILED;
+      return;
+    }
+    if (index >= sample.sensorCount) {
+      health = SensorHealth::STALE;
+      return;
+    }
+    health = TemperatureHandler::checkStaleness(sample.health[index], sample.timestamp);
+    const SensorEstimate &estimate = sample.estimates[index];
+    if (estimate.valid && isSensorUsable(health)) {
+      temp = estimate.temp;
+    }
+  }
+}
+
+// ----------------------------
+// Transitionstabellen
+// ----------------------------
+namespace {
+  using BrewState = Vessel::BrewState;
+  using Event = Vessel::Event;
+
+  // Mål i transitionstabellen: en BrewState eller en af de særlige værdier.
+  constexpr int8_t STAY = -1;     // Intern transition: kun handlingen udføres
+  constexpr int8_t HISTORY = -2;  // Tilbage til tilstanden før pausen
+
+  constexpr int8_t target(BrewState state) {
+    return static_cast<int8_t>(state);
+  }
+  constexpr uint8_t stateBit(BrewState state) {
+    return 1u << static_cast<uint8_t>(state);
+  }
+
+  constexpr int8_t IDLE_STATE = target(BrewState::IDLE);
+  constexpr int8_t MASHING_STATE = target(BrewState::MASHING);
+  constexpr int8_t BOILHEATUP_STATE = target(BrewState::BOILHEATUP);
+  constexpr int8_t BOILING_STATE = target(BrewState::BOILING);
+  constexpr int8_t PAUSED_STATE = target(BrewState::PAUSED);
+  constexpr int8_t AUTOTUNE_STATE = target(BrewState::AUTOTUNE);
+
+  constexpr uint8_t IDLE_BIT = stateBit(BrewState::IDLE);
+  constexpr uint8_t MASHING_BIT = stateBit(BrewState::MASHING);
+  constexpr uint8_t BOILHEATUP_BIT = stateBit(BrewState::BOILHEATUP);
+  constexpr uint8_t BOILING_BIT = stateBit(BrewState::BOILING);
+  constexpr uint8_t PAUSED_BIT = stateBit(BrewState::PAUSED);
+  constexpr uint8_t AUTOTUNE_BIT = stateBit(BrewState::AUTOTUNE);
+  constexpr uint8_t BREWING_STATES = MASHING_BIT | BOILHEATUP_BIT | BOILING_BIT;
+  constexpr uint8_t ANY_STATE = 0xFF;
+
+  const char *stateName(BrewState state) {
+    switch (state) {
+      case BrewState::IDLE:       return "IDLE";
+      case BrewState::MASHING:    return "MASHING";
+      case BrewState::BOILHEATUP: return "BOILHEATUP";
+      case BrewState::BOILING:    return "BOILING";
+      case BrewState::PAUSED:     return "PAUSED";
+      case BrewState::AUTOTUNE:   return "AUTOTUNE";
+    }
+    return "?";
+  }
+
+  const char *eventName(const Event &event) {
+    switch (event.type) {
+      case Event::Type::SAMPLE:     return "SAMPLE";
+      case Event::Type::BUTTON:     return "BUTTON";
+      case Event::Type::LONG_PRESS: return "LONG_PRESS";
+      case Event::Type::DOUBLE_PRESS: return "DOUBLE_PRESS";
+      case Event::Type::TIMER:      return "TIMER";
+      case Event::Type::FAULT:      return "FAULT";
+      case Event::Type::DONE:       return "DONE";
+      case Event::Type::ADDITION:   return "ADDITION";
+      case Event::Type::COMMAND:    break;
+    }
+    switch (event.command) {
+      case Event::Command::START_MASHING:  return "startMashing";
+      case Event::Command::START_MASHOUT:  return "startMashout";
+      case Event::Command::START_BOILING:  return "startBoiling";
+      case Event::Command::STOP:           return "stopProcess";
+      case Event::Command::PAUSE:          return "pauseProcess";
+      case Event::Command::RESUME:         return "resumeProcess";
+      case Event::Command::START_AUTOTUNE: return "startAutotune";
+      case Event::Command::TOGGLE_PUMP:    return "togglePump";
+      case Event::Command::TOGGLE_GAS:     return "toggleGasValve";
+      case Event::Command::RESET:          return "resetProcessState";
+      case Event::Command::NONE:           break;
+    }
+    return "COMMAND";
+  }
+}
+
+// Samplingpolitik pr. fase. Under opvarmning og tæt på ventilgrænsen måles
+// hurtigt med lav opløsning; under et mæskehvil er præcision vigtigere end
+// reaktionstid, og i IDLE/PAUSE måles kun sjældent. Sensorerne deles af alle
+// kar, så ProcessHandler bruger det kar, der har brug for den hurtigste måling.
+static const Vessel::SamplingPolicy SAMPLING_POLICIES[] = {
+  {12, 10000},  // IDLE/PAUSED
+  {10, 250},    // RAMP: op mod setpoint eller tæt på ventilgrænsen
+  {12, 1000},   // HOLD: mæskehvil med nedtælling i gang
+  {11, 500},    // BOIL: opvarmning til og under kogning
+};
+
+// Ventilen regnes som "tæt på grænsen" inden for denne margin, med lidt ekstra
+// hysterese på vej ud, så profilen ikke skifter frem og tilbage.
+static const TempRaw VALVE_NEAR_MARGIN = tempRawFromC(2.0f);
+static const TempRaw VALVE_NEAR_RELEASE = tempRawFromC(3.0f);
+
+// PID-regulering af varmen under mæskning/udmæskning. PID'en regnes med fast
+// takt; relæet styres tidsproportionalt ud fra dens duty (0–100 %).
+static const unsigned long PID_SAMPLE_MS = 1000;
+// Har temperatureControl() ikke kørt i så lang tid (pause, trinskift), startes
+// reguleringen forfra i stedet for at genoptage et forældet integral.
+static const unsigned long PID_RESTART_MS = 5000;
+
+// Relæernes skifteplan (RelayActuator.h). Minimumstiderne er også PID-udgangens
+// mindste puls, så de kun slår til ved skift uden for PID'en: kortere
+// gaspulser/-pauser end 2 s skåner relæ og tænding; et varmelegeme bag en
+// kontaktor skifter ikke hurtigere end hvert 10. sekund og højst 60 gange i
+// timen. Levetidstællerne gemmes i portioner: efter RELAY_SAVE_CYCLES
+// tændinger, RELAY_SAVE_MS tid tændt eller når karret vender tilbage til IDLE.
+static const RelayActuator::Limits GAS_RELAY_LIMITS = {2000, 2000, 120};
+static const RelayActuator::Limits HEAT_RELAY_LIMITS = {10000, 10000, 60};
+static const RelayActuator::Limits PUMP_RELAY_LIMITS = {5000, 5000, 30};
+static const uint32_t RELAY_SAVE_CYCLES = 50;
+static const uint64_t RELAY_SAVE_MS = 30UL * 60 * 1000;
+// SafetySupervisor slukker en gas, der har brændt uafbrudt for længe. Grænsen
+// sættes pr. fase og regnes fra fasens start (armGasLimit): opvarmningen til
+// kog har ingen fast længde, da BoilDetector finder kogepunktet, og får sin
+// egen rummelige grænse; kogningen får den resterende kogetid plus en margin.
+// Resten (mæskning, autotuning, manuel gas) har vagtens standardgrænse.
+static const unsigned long MAX_GAS_ON_HEATUP_S = 2 * 60 * 60;
+static const unsigned long GAS_ON_MARGIN_S = 30 * 60;
+
+// Fremdriftsjournalen skrives ved hver transition og derudover højst hvert
+// CHECKPOINT_INTERVAL_MS, mens en nedtælling kører – et strømsvigt koster
+// altså højst så meget af nedtællingen, hvis klokken ikke kendes. Kendes
+// klokken både før og efter, lægges udfaldet til nedtællingen. Om processen
+// genoptages, afgøres alene af journalen, så det er det samme med og uden tid.
+static const unsigned long CHECKPOINT_INTERVAL_MS = 30000;
+
+// Proces state fra før fremdriftsjournalen (kun gryden); læses kun, hvis
+// journalen er tom.
+struct ProcessState {
+  unsigned long processStartEpoch;
+  uint8_t currentState; // gemt som uint8_t svarende til BrewState
+  bool timerStarted;
+  uint8_t stepIndex;    // Trin i mæskeplanen (kun under MASHING)
+  uint8_t additionsDone; // Bekræftede kogetilsætninger (kun under BOILING)
+};
+
+// Gemt af firmware fra før mæskeplanen: udmæskning, nu planens sidste trin.
+static const uint8_t LEGACY_MASHOUT_STATE = 2;
+
+String Vessel::getProcessStep() const {
+  switch (currentState) {
+    case BrewState::IDLE:
+      return "Idle";
+    case BrewState::MASHING:
+      // Brug CP437-koden for æ (0x91)
+      return mashStepName(stepIndex, schedule.count, "M\x91skning", "Udm\x91skning");
+    case BrewState::BOILHEATUP:
+      return "Opvarmning";
+    case BrewState::BOILING:
+      if (const BoilAddition *addition = getDueAddition()) {
+        return String("Tils\x91t ") + addition->name;
+      }
+      return timerStarted ? "Kogning" : "Venter p\x86 kogepunkt"; // Brug \x91 for æ
+    case BrewState::PAUSED:
+      return "PAUSE";
+    case BrewState::AUTOTUNE:
+      return "Autotuning";
+    default:
+      return "Ukendt";
+  }
+}
+
+// ============================
+// PUBLIC METODER
+// ============================
+void Vessel::begin(uint8_t vesselIndex, const VesselPins &vesselPins) {
+  index = vesselIndex;
+  pins = &vesselPins;
+  uint64_t now = Clock::nowMs();
+
+  const RelayActuator::Limits &heatLimits = pins->source == HeatSource::GAS ? GAS_RELAY_LIMITS : HEAT_RELAY_LIMITS;
+  minPulseMs = heatLimits.minOnMs;
+  RelayActuator::Counters heatCounters;
+  RelayActuator::Counters pumpCounters;
+  EEPROMHandler::getRelayCounters(index, heatCounters, pumpCounters);
+  Hal::pinMode(pins->heatPin, OUTPUT);
+  heatRelay.begin(pins->heatPin, heatLimits, heatCounters, now);
+  heatRelay.setInterlock(SafetySupervisor::isTripped);
+  if (hasPump()) {
+    Hal::pinMode(pins->pumpPin, OUTPUT);
+    pumpRelay.begin(pins->pumpPin, PUMP_RELAY_LIMITS, pumpCounters, now);
+    pumpRelay.setInterlock(SafetySupervisor::isTripped);
+  }
+
+  sensorIndex = TemperatureHandler::findSensor(pins->sensorName);
+  limitIndex = hasLimitSensor() ? TemperatureHandler::findSensor(pins->limitSensorName) : -1;
+  SafetySupervisor::watchVessel(index, sensorIndex, limitIndex);
+  if (sensorIndex < 0) {
+    Serial.printf("[%s] Sensoren \"%s\" blev ikke fundet – varmen holdes slukket.\n", getName(), pins->sensorName);
+  }
+  if (hasLimitSensor() && limitIndex < 0) {
+    Serial.printf("[%s] Grænsesensoren \"%s\" blev ikke fundet – varmen holdes slukket.\n", getName(),
+                  pins->limitSensorName);
+  }
+
+  // Som efter en kold opstart, også hvis begin() kaldes igen.
+  currentState = BrewState::IDLE;
+  previousState = BrewState::IDLE;
+  boilingComplete = false;
+  sensorAlarm = false;
+  postedSequence = 0;
+  postedHealth = SensorHealth::OK;
+  postedLimitHealth = SensorHealth::OK;
+  clearConfirmation();
+
+  // Hent de gemte indstillinger fra EEPROM
+  Settings settings = EEPROMHandler::getVesselSettings(index);
+  setSchedule(settings.schedule);
+  setAdditions(settings.additions);
+  setBoilTime(settings.boilTime);
+  setHysteresis(settings.hysteresis);
+  setValveOffset(settings.valveOffset);
+  setPidGains(settings.pidKp, settings.pidKi, settings.pidKd);
+  setPidWindow(settings.pidWindow);
+  setBoilDetection(settings.boilAltitude, settings.boilThreshold);
+
+  // Forsøg at genoptage en eventuel gemt proces state
+  journal.begin(ProcessJournal::storageStart(index));
+  if (!restoreProcessState()) {
+    currentState = BrewState::IDLE;
+    timerStarted = false;
+  }
+  // En tilstand, hvis nedtælling ikke var startet, begynder forfra som ved entry.
+  if (!timerStarted) {
+    const StateActions &actions = actionsFor(currentState);
+    if (actions.enter) (this->*actions.enter)();
+  }
+  gasPhase = GasPhase::NONE;
+  armGasLimit();
+
+  Serial.printf("[%s] begin() -> %s\n", getName(), getProcessStatus().c_str());
+}
+
+// ----------------------------
+// Tilstandsmaskinen
+// ----------------------------
+const Vessel::StateActions Vessel::STATE_ACTIONS[] = {
+  {&Vessel::enterIdle, nullptr, nullptr},                                  // IDLE
+  {&Vessel::enterMashing, &Vessel::exitMashing, &Vessel::sampleMashing},   // MASHING
+  {nullptr, nullptr, nullptr},                                             // 2: tidligere MASHOUT
+  {&Vessel::enterBoilHeatup, nullptr, &Vessel::sampleBoil},                // BOILHEATUP
+  {&Vessel::enterBoiling, nullptr, &Vessel::sampleBoil},                   // BOILING
+  {&Vessel::enterPaused, nullptr, nullptr},                                // PAUSED
+  {&Vessel::enterAutotune, &Vessel::exitAutotune, &Vessel::sampleAutotune}, // AUTOTUNE
+};
+
+const Vessel::Transition Vessel::TRANSITIONS[] = {
+  // Webkommandoer
+  {ANY_STATE, Event::Type::COMMAND, Event::Command::START_MASHING, nullptr, MASHING_STATE, &Vessel::selectFirstStep},
+  {ANY_STATE, Event::Type::COMMAND, Event::Command::START_MASHOUT, nullptr, MASHING_STATE, &Vessel::selectLastStep},
+  {ANY_STATE, Event::Type::COMMAND, Event::Command::START_BOILING, &Vessel::canBoil, BOILING_STATE,
+   &Vessel::startBoilCountdown},
+  {ANY_STATE, Event::Type::COMMAND, Event::Command::STOP, nullptr, IDLE_STATE, nullptr},
+  {ANY_STATE, Event::Type::COMMAND, Event::Command::RESET, nullptr, IDLE_STATE, &Vessel::clearStoredState},
+  {BREWING_STATES, Event::Type::COMMAND, Event::Command::PAUSE, nullptr, PAUSED_STATE, nullptr},
+  // En pause ville forvrænge svingningen, så autotuning afbrydes i stedet.
+  {AUTOTUNE_BIT, Event::Type::COMMAND, Event::Command::PAUSE, nullptr, IDLE_STATE, &Vessel::abortTuner},
+  {PAUSED_BIT, Event::Type::COMMAND, Event::Command::RESUME, nullptr, HISTORY, &Vessel::resumeCountdown},
+  {BREWING_STATES, Event::Type::DOUBLE_PRESS, Event::Command::NONE, nullptr, PAUSED_STATE, nullptr},
+  {PAUSED_BIT, Event::Type::DOUBLE_PRESS, Event::Command::NONE, nullptr, HISTORY, &Vessel::resumeCountdown},
+  {IDLE_BIT, Event::Type::COMMAND, Event::Command::START_AUTOTUNE, nullptr, AUTOTUNE_STATE, &Vessel::startTuner},
+  {IDLE_BIT | PAUSED_BIT, Event::Type::COMMAND, Event::Command::TOGGLE_PUMP, nullptr, STAY,
+   &Vessel::togglePumpOutput},
+  {IDLE_BIT | PAUSED_BIT, Event::Type::COMMAND, Event::Command::TOGGLE_GAS, nullptr, STAY, &Vessel::toggleGasOutput},
+  {IDLE_BIT, Event::Type::LONG_PRESS, Event::Command::NONE, nullptr, MASHING_STATE, &Vessel::selectFirstStep},
+
+  // Mæskeplanen: bekræft setpoint, nedtælling, evt. bekræft, næste trin. Efter
+  // sidste trin går et kar, der koger, videre til kog; de andre holder trinnet.
+  {MASHING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingStart, STAY, &Vessel::startStepCountdown},
+  {MASHING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingEndWithNextStep, MASHING_STATE,
+   &Vessel::advanceStep},
+  {MASHING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingEndBeforeBoil, BOILHEATUP_STATE, nullptr},
+  {MASHING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingEnd, IDLE_STATE, nullptr},
+  {MASHING_BIT, Event::Type::TIMER, Event::Command::NONE, &Vessel::confirmEndRequired, STAY,
+   &Vessel::awaitEndConfirmation},
+  {MASHING_BIT, Event::Type::TIMER, Event::Command::NONE, &Vessel::hasNextStep, MASHING_STATE, &Vessel::advanceStep},
+  {MASHING_BIT, Event::Type::TIMER, Event::Command::NONE, &Vessel::holdsLastStep, STAY, &Vessel::holdLastStep},
+  {MASHING_BIT, Event::Type::TIMER, Event::Command::NONE, nullptr, BOILHEATUP_STATE, nullptr},
+
+  // Opvarmning og kogning
+  // Kogepunktet findes automatisk (DONE); et tryk på knappen er den manuelle overstyring.
+  {BOILHEATUP_BIT, Event::Type::DONE, Event::Command::NONE, nullptr, BOILING_STATE, &Vessel::startBoilCountdown},
+  {BOILHEATUP_BIT, Event::Type::TIMER, Event::Command::NONE, nullptr, STAY, &Vessel::awaitHeatupConfirmation},
+  {BOILHEATUP_BIT, Event::Type::BUTTON, Event::Command::NONE, nullptr, BOILING_STATE, &Vessel::startBoilCountdown},
+  // Uden nedtælling venter kogningen altid på kogepunktet – også efter en
+  // pause eller en genoptagelse, hvor bekræftelsen ikke er sat.
+  {BOILING_BIT, Event::Type::DONE, Event::Command::NONE, &Vessel::boilCountdownPending, STAY,
+   &Vessel::startBoilCountdown},
+  {BOILING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::boilCountdownPending, STAY,
+   &Vessel::startBoilCountdown},
+  {BOILING_BIT, Event::Type::ADDITION, Event::Command::NONE, nullptr, STAY, &Vessel::announceAddition},
+  {BOILING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingAddition, STAY, &Vessel::confirmAddition},
+  {BOILING_BIT, Event::Type::TIMER, Event::Command::NONE, nullptr, STAY, &Vessel::finishBoil},
+  {BOILING_BIT, Event::Type::BUTTON, Event::Command::NONE, &Vessel::awaitingEnd, IDLE_STATE, nullptr},
+
+  // Autotuning færdig eller mislykket
+  {AUTOTUNE_BIT, Event::Type::DONE, Event::Command::NONE, nullptr, IDLE_STATE, nullptr},
+
+  {ANY_STATE, Event::Type::FAULT, Event::Command::NONE, nullptr, STAY, &Vessel::setSensorAlarm},
+};
+
+// Reguleringen, filtrene og modellen skal se hver måling én gang, i
+// sensorernes takt. Et skift i sundheden lægges dog altid i køen, så varmen
+// også slukkes, når målingerne helt udebliver (intet nyt målesæt).
+void Vessel::postSample(const TemperatureSnapshot &sample, uint64_t now) {
+  TempRaw sampleTemp;
+  SensorHealth sampleHealth;
+  readSensor(sample, sensorIndex, sampleTemp, sampleHealth);
+  TempRaw sampleLimitTemp = TEMP_RAW_INVALID;
+  SensorHealth sampleLimitHealth = SensorHealth::OK;
+  if (hasLimitSensor()) {
+    readSensor(sample, limitIndex, sampleLimitTemp, sampleLimitHealth);
+  }
+  if (sample.sequence == postedSequence && sampleHealth == postedHealth && sampleLimitHealth == postedLimitHealth) {
+    return;
+  }
+  Event event = {Event::Type::SAMPLE, Event::Command::NONE, index, now, sampleTemp, sampleLimitTemp, sampleHealth,
+                 sampleLimitHealth, 0.0f};
+  if (ProcessHandler::post(event)) {
+    postedSequence = sample.sequence;
+    postedHealth = sampleHealth;
+    postedLimitHealth = sampleLimitHealth;
+  }
+}
+
+void Vessel::poll(uint64_t now) {
+  pollAdditions(now);
+  pollTimer(now);
+}
+
+void Vessel::service(uint64_t now) {
+  checkpointProgress(now);
+  heatRelay.update(now);
+  if (hasPump()) {
+    pumpRelay.update(now);
+  }
+  saveRelayCounters(now, false);
+}
+
+bool Vessel::postSimple(Event::Type type, Event::Command command, float value) {
+  Event event = {type, command, index, Clock::nowMs(), TEMP_RAW_INVALID, TEMP_RAW_INVALID, SensorHealth::OK,
+                 SensorHealth::OK, value};
+  return ProcessHandler::post(event);
+}
+
+// Nedtællingen giver én TIMER, stemplet med det tidspunkt, den udløb.
+void Vessel::pollTimer(uint64_t now) {
+  bool counting = currentState == BrewState::MASHING || currentState == BrewState::BOILHEATUP ||
+                  currentState == BrewState::BOILING;
+  if (!counting || !timerStarted || timerFired || now - processStartMillis < countdownMs) {
+    return;
+  }
+  // Er køen fuld, prøves der igen ved næste poll.
+  Event event = {Event::Type::TIMER, Event::Command::NONE, index, processStartMillis + countdownMs, TEMP_RAW_INVALID,
+                 TEMP_RAW_INVALID, SensorHealth::OK, SensorHealth::OK, 0.0f};
+  if (ProcessHandler::post(event)) {
+    timerFired = true;
+  }
+}
+
+// Tilsætningerne kaldes op én ad gangen i heapens rækkefølge. Tiden regnes
+// fra kogestart som nedtællingen, så en pause skubber dem med.
+void Vessel::pollAdditions(uint64_t now) {
+  if (currentState != BrewState::BOILING || !timerStarted || additionPosted || awaiting == Awaiting::ADDITION ||
+      additionHeap.empty()) {
+    return;
+  }
+  const AdditionHeap::Entry &next = additionHeap.top();
+  if (now - processStartMillis < next.dueSec * 1000ULL) {
+    return;
+  }
+  Event event = {Event::Type::ADDITION, Event::Command::NONE, index, processStartMillis + next.dueSec * 1000ULL,
+                 TEMP_RAW_INVALID, TEMP_RAW_INVALID, SensorHealth::OK, SensorHealth::OK,
+                 static_cast<float>(next.index)};
+  if (ProcessHandler::post(event)) {
+    additionPosted = true;
+  }
+}
+
+// SAMPLE driver blot tilstandens aktivitet. Alle andre hændelser slås op i
+// transitionstabellen; første række, der passer (tilstand, hændelse,
+// kommando og guard), udføres. Passer ingen, ignoreres hændelsen.
+void Vessel::dispatch(const Event &event) {
+  if (event.type == Event::Type::SAMPLE) {
+    applySample(event);
+    return;
+  }
+  for (const Transition &transition : TRANSITIONS) {
+    if (!(transition.from & stateBit(currentState)) || transition.event != event.type ||
+        (event.type == Event::Type::COMMAND && transition.command != event.command) ||
+        (transition.guard && !(this->*transition.guard)())) {
+      continue;
+    }
+    fire(transition, event);
+    return;
+  }
+}
+
+// Transitionen logges med hændelsens tidsstempel. Rækkefølgen er exit
+// (gammel tilstand) -> entry (ny) -> transitionens handling, så handlingen
+// kan bygge videre på entry (fx springe bekræftelsen af kogepunktet over ved
+// /startBoiling).
+void Vessel::fire(const Transition &transition, const Event &event) {
+  BrewState from = currentState;
+  uint8_t fromStep = stepIndex;
+  bool fromTimer = timerStarted;
+  bool fromComplete = boilingComplete;
+  if (transition.to != STAY) {
+    BrewState to = transition.to == HISTORY ? previousState : static_cast<BrewState>(transition.to);
+    Serial.printf("[%s] %llu ms: %s -> %s (%s)\n", getName(), static_cast<unsigned long long>(event.timestampMs),
+                  stateName(from), stateName(to), eventName(event));
+  }
+  if (transition.to == HISTORY) {
+    currentState = previousState;
+    previousState = from;
+  } else if (transition.to != STAY) {
+    BrewState to = static_cast<BrewState>(transition.to);
+    const StateActions &leaving = actionsFor(from);
+    if (leaving.exit) (this->*leaving.exit)();
+    previousState = from;
+    currentState = to;
+    const StateActions &entering = actionsFor(to);
+    if (entering.enter) (this->*entering.enter)();
+  }
+  if (transition.action) {
+    (this->*transition.action)(event);
+  }
+  armGasLimit();
+
+  if (currentState != from || stepIndex != fromStep || timerStarted != fromTimer ||
+      boilingComplete != fromComplete) {
+    saveProcessState();
+  }
+}
+
+// Starter vagtens måling af uafbrudt gas forfra, når processen skifter fase.
+// Vagten overvåger kun gassen, ikke el-varme.
+void Vessel::armGasLimit() {
+  if (pins->source != HeatSource::GAS) {
+    return;
+  }
+  GasPhase phase = GasPhase::OTHER;
+  unsigned long limit = SafetySupervisor::DEFAULT_MAX_GAS_ON_S;
+  if (currentState == BrewState::BOILHEATUP || (currentState == BrewState::BOILING && !timerStarted)) {
+    phase = GasPhase::HEATUP;
+    limit = MAX_GAS_ON_HEATUP_S;
+  } else if (currentState == BrewState::BOILING) {
+    phase = GasPhase::BOIL;
+    limit = getRemainingTime() + GAS_ON_MARGIN_S;
+  }
+  if (phase != gasPhase) {
+    gasPhase = phase;
+    SafetySupervisor::startGasPhase(limit);
+  }
+}
+
+const Vessel::StateActions &Vessel::actionsFor(BrewState state) {
+  return STATE_ACTIONS[static_cast<uint8_t>(state)];
+}
+
+// Fælles for alle tilstande: sensoralarm, måleprofil og den termiske model.
+void Vessel::applySample(const Event &event) {
+  temp = event.temp;
+  health = event.health;
+  limitHealth = event.limitHealth;
+  // En fejlet sensor giver kun alarm, når temperaturen faktisk bruges til
+  // styring: begge under regulering, karrets sensor også under opvarmning og kog.
+  bool regulating = currentState == BrewState::MASHING || currentState == BrewState::AUTOTUNE;
+  bool boiling = currentState == BrewState::BOILHEATUP || currentState == BrewState::BOILING;
+  bool alarm = (regulating && (health == SensorHealth::FAILED || limitHealth == SensorHealth::FAILED)) ||
+               (boiling && health == SensorHealth::FAILED);
+  if (alarm != sensorAlarm) {
+    postSimple(Event::Type::FAULT, Event::Command::NONE, alarm ? 1.0f : 0.0f);
+  }
+
+  updateSamplingProfile(event.limitTemp);
+
+  if (regulating && isTempRawValid(event.temp) && isSensorUsable(health)) {
+    // Modellen lærer under opvarmning og autotuning, ikke under selve hvilet.
+    thermalModel.update(tempRawToC(event.temp), heatRelay.isOn(), static_cast<unsigned long>(event.timestampMs),
+                        !timerStarted);
+  } else {
+    thermalModel.pause();
+  }
+
+  const StateActions &actions = actionsFor(currentState);
+  if (actions.sample) {
+    (this->*actions.sample)(event);
+  }
+}
+
+bool Vessel::awaitingStart() const {
+  return awaiting == Awaiting::START;
+}
+
+bool Vessel::boilCountdownPending() const {
+  return !timerStarted;
+}
+
+bool Vessel::awaitingEnd() const {
+  return awaiting == Awaiting::END;
+}
+
+bool Vessel::awaitingAddition() const {
+  return awaiting == Awaiting::ADDITION;
+}
+
+bool Vessel::awaitingEndWithNextStep() const {
+  return awaitingEnd() && hasNextStep();
+}
+
+bool Vessel::awaitingEndBeforeBoil() const {
+  return awaitingEnd() && boils();
+}
+
+bool Vessel::confirmEndRequired() const {
+  return currentStep().confirmEnd;
+}
+
+bool Vessel::hasNextStep() const {
+  return stepIndex + 1 < schedule.count;
+}
+
+bool Vessel::holdsLastStep() const {
+  return !boils();
+}
+
+bool Vessel::canBoil() const {
+  return boils();
+}
+
+void Vessel::enterIdle() {
+  timerStarted = false;
+  additionHeap.clear();
+  additionsDone = 0;
+  additionPosted = false;
+  boilingComplete = false;
+  pidRunning = false;
+  gasControl(false);
+  pumpControl(false);
+  clearConfirmation();
+  saveRelayCounters(Clock::nowMs(), true);
+}
+
+void Vessel::enterMashing() {
+  timerStarted = false;
+  clearConfirmation();
+}
+
+// Outputs slukkes ved hvert trinskift; næste trins aktivitet tænder dem igen.
+void Vessel::exitMashing() {
+  pidRunning = false;
+  gasControl(false);
+  pumpControl(false);
+  clearConfirmation();
+}
+
+// Afvikler mæskeplanens aktuelle trin. Pumpe og varme følger trinnets politik;
+// nedtællingen starter, når target − hysterese er nået (straks for et passivt
+// hvil uden varme), evt. først efter bekræftelse på knappen. Når tiden er gået,
+// kommer en TIMER, og transitionstabellen går videre – evt. efter bekræftelse.
+void Vessel::sampleMashing(const Event &event) {
+  const MashStep &step = currentStep();
+  pumpControl(step.pump == PumpMode::ON);
+
+  bool reached;
+  if (step.gas == GasPolicy::REGULATE) {
+    temperatureControl(event.temp, step.target, event.limitTemp);
+    reached = event.temp >= step.target - hysteresis;
+  } else {
+    gasControl(false);
+    pidRunning = false;
+    reached = true;
+  }
+
+  if (timerStarted || !reached || awaiting != Awaiting::NONE) {
+    return;
+  }
+  if (step.confirmStart) {
+    awaitConfirmation(Awaiting::START, true);
+    Serial.printf("[%s] Trin %u/%u: %s °C nået. Tryk på knappen for at starte nedtælling.\n", getName(),
+                  stepIndex + 1, schedule.count, tempRawToString(step.target).c_str());
+  } else {
+    startStepCountdown(event);
+    saveProcessState();
+  }
+}
+
+// Varmen på og pumpen slukket i hele opvarmningen og kogningen – varmen dog
+// kun med en brugbar måling (se sampleBoil).
+void Vessel::enterBoilHeatup() {
+  gasControl(isSensorUsable(health));
+  pumpControl(false);
+  clearConfirmation();
+  boilDetector.reset();
+  startCountdown(boilHeatupTime);
+  BuzzerHandler::start(BuzzerHandler::Pattern::STEP_DONE);
+  Serial.printf("[%s] BOILHEATUP: varmer op til kog (kogepunkt %.1f °C, leder fra %.1f °C).\n", getName(),
+                boilDetector.getBoilingPoint(), boilDetector.getThreshold());
+}
+
+// Kommer vi hertil uden nedtælling (genoptaget fra journalen), startes
+// kogetiden af detektoren eller på knappen.
+void Vessel::enterBoiling() {
+  boilingComplete = false;
+  timerStarted = false;
+  additionHeap.clear();
+  additionsDone = 0;
+  additionPosted = false;
+  gasControl(isSensorUsable(health));
+  pumpControl(false);
+  awaitConfirmation(Awaiting::START, true);
+  Serial.printf("[%s] Kog: Kogetiden starter ved kogepunktet eller på knappen.\n", getName());
+}
+
+// Degraderet drift som under mæskning (se temperatureControl): uden en
+// brugbar måling kan hverken kogepunktet eller et løbsk kog ses, så varmen
+// holdes slukket, og nedtællingen kører videre. Grænsesensoren bruges ikke
+// under kog.
+void Vessel::sampleBoil(const Event &event) {
+  pumpControl(false);
+  // Efter kogetiden er varmen slukket af finishBoil().
+  if (!boilingComplete) {
+    if (isSensorUsable(event.health) && isTempRawValid(event.temp)) {
+      gasControl(true);
+    } else if (heatRelay.isRequested()) {
+      gasControl(false);
+      Serial.printf("[%s] Varmen slukket: mangler pålidelig måling.\n", getName());
+    }
+  }
+  // Detektoren følger karret, indtil kogetiden er startet.
+  bool searching = currentState == BrewState::BOILHEATUP || (currentState == BrewState::BOILING && !timerStarted);
+  if (searching && isTempRawValid(event.temp) && isSensorUsable(event.health) &&
+      boilDetector.update(tempRawToC(event.temp), static_cast<unsigned long>(event.timestampMs))) {
+    Serial.printf("[%s] Kogepunkt fundet: %s °C, %.2f °C/min over de sidste %lu s.\n", getName(),
+                  tempRawToString(event.temp).c_str(), boilDetector.getRate(),
+                  BoilDetector::WINDOW_SAMPLES * BoilDetector::SAMPLE_MS / 1000);
+    postSimple(Event::Type::DONE);
+  }
+}
+
+void Vessel::enterPaused() {
+  pauseOffset = Clock::nowMs() - processStartMillis;
+  pidRunning = false;
+  gasControl(false);
+  pumpControl(false);
+  clearConfirmation();
+}
+
+void Vessel::enterAutotune() {
+  timerStarted = false;
+  autotuneValveLimited = false;
+  gasControl(false);
+  clearConfirmation();
+}
+
+void Vessel::exitAutotune() {
+  autoTuner.abort();
+  gasControl(false);
+  pumpControl(false);
+}
+
+void Vessel::sampleAutotune(const Event &event) {
+  pumpControl(true);
+  autotuneControl(event.temp, event.limitTemp);
+}
+
+void Vessel::selectFirstStep(const Event &event) {
+  (void)event;
+  stepIndex = 0;
+  Serial.printf("[%s] MASHING (%u trin)\n", getName(), schedule.count);
+}
+
+void Vessel::selectLastStep(const Event &event) {
+  (void)event;
+  stepIndex = schedule.count - 1;
+  Serial.printf("[%s] MASHING trin %u/%u\n", getName(), stepIndex + 1, schedule.count);
+}
+
+void Vessel::advanceStep(const Event &event) {
+  stepIndex++;
+  // Uden bekræftelse får brygger et kort signal om, at næste trin er begyndt.
+  if (event.type == Event::Type::TIMER) {
+    BuzzerHandler::start(BuzzerHandler::Pattern::STEP_DONE);
+  }
+  Serial.printf("[%s] Skifter til trin %u/%u (%s °C, %u min)\n", getName(), stepIndex + 1, schedule.count,
+                tempRawToString(currentStep().target).c_str(), currentStep().minutes);
+}
+
+// Et kar, der ikke koger, bliver i sidste trin og regulerer videre, til det
+// stoppes. Nedtællingen er udløbet, så der er intet nyt at skrive i journalen.
+void Vessel::holdLastStep(const Event &event) {
+  (void)event;
+  Serial.printf("[%s] Sidste trin færdigt – holder %s °C, til karret stoppes.\n", getName(),
+                tempRawToString(currentStep().target).c_str());
+}
+
+void Vessel::startStepCountdown(const Event &event) {
+  (void)event;
+  const MashStep &step = currentStep();
+  startCountdown(step.minutes * 60UL);
+  clearConfirmation();
+  Serial.printf("[%s] Nedtælling for trin %u/%u startet (%u min).\n", getName(), stepIndex + 1, schedule.count,
+                step.minutes);
+}
+
+void Vessel::awaitEndConfirmation(const Event &event) {
+  (void)event;
+  awaitConfirmation(Awaiting::END, true);
+  Serial.printf("[%s] Tiden udløbet. Vent på bekræftelse for at skifte til næste trin.\n", getName());
+}
+
+// Er kogepunktet ikke fundet efter den forventede opvarmningstid, beder LED'en
+// (ingen buzzer) om en manuel bekræftelse; detektoren leder videre.
+void Vessel::awaitHeatupConfirmation(const Event &event) {
+  (void)event;
+  awaitConfirmation(Awaiting::END, false);
+}
+
+void Vessel::startBoilCountdown(const Event &event) {
+  startCountdown(boilTime);
+  clearConfirmation();
+  additionsDone = 0;
+  loadAdditionHeap();
+  switch (event.type) {
+    case Event::Type::COMMAND:
+      Serial.printf("[%s] Kogning startet (kogetid med det samme).\n", getName());
+      break;
+    case Event::Type::DONE:
+      Serial.printf("[%s] Kogetidsnedtælling startet automatisk ved kogepunktet.\n", getName());
+      break;
+    default:
+      Serial.printf("[%s] Kogetidsnedtælling startet på knappen.\n", getName());
+      break;
+  }
+}
+
+void Vessel::finishBoil(const Event &event) {
+  (void)event;
+  boilingComplete = true;
+  gasControl(false);
+  // En tilsætning ved kogningens slutning bekræftes først.
+  if (awaiting != Awaiting::ADDITION) {
+    awaitConfirmation(Awaiting::END, true);
+  }
+  Serial.printf("[%s] Kogetid udløbet. Buzzeren lyder indtil bruger bekræfter.\n", getName());
+}
+
+void Vessel::announceAddition(const Event &event) {
+  const BoilAddition &addition = additions.items[static_cast<uint8_t>(event.value)];
+  awaitConfirmation(Awaiting::ADDITION, true);
+  Serial.printf("[%s] Tilsæt nu: %s (%u g, %u min før slut). Bekræft med knappen.\n", getName(), addition.name,
+                addition.grams, addition.minutes);
+}
+
+void Vessel::confirmAddition(const Event &event) {
+  (void)event;
+  const BoilAddition &addition = additions.items[additionHeap.top().index];
+  Serial.printf("[%s] Tilsætning bekræftet: %s\n", getName(), addition.name);
+  additionHeap.pop();
+  additionsDone++;
+  additionPosted = false;
+  if (boilingComplete && additionHeap.empty()) {
+    awaitConfirmation(Awaiting::END, true);
+  } else {
+    clearConfirmation();
+  }
+  saveProcessState();
+}
+
+// Pausen har ryddet en ventende bekræftelse; er nedtællingen eller en
+// tilsætning allerede udløbet, kaldes den op igen. Ventede kogningen på
+// kogepunktet, bedes der om det igen.
+void Vessel::resumeCountdown(const Event &event) {
+  (void)event;
+  processStartMillis = Clock::nowMs() - pauseOffset;
+  timerFired = false;
+  additionPosted = false;
+  awaitBoilStart();
+}
+
+void Vessel::startTuner(const Event &event) {
+  autotuneSetpoint = tempRawFromC(event.value);
+  autoTuner.start(event.value, Hal::millis());
+  Serial.printf("[%s] Autotuning om %.1f °C\n", getName(), event.value);
+}
+
+void Vessel::abortTuner(const Event &event) {
+  (void)event;
+  Serial.printf("[%s] Autotuning afbrudt af pause.\n", getName());
+}
+
+void Vessel::togglePumpOutput(const Event &event) {
+  (void)event;
+  pumpControl(!pumpRelay.isRequested());
+}
+
+void Vessel::toggleGasOutput(const Event &event) {
+  (void)event;
+  gasControl(!heatRelay.isRequested());
+}
+
+void Vessel::clearStoredState(const Event &event) {
+  (void)event;
+  processStartEpoch = 0;
+  processStartMillis = 0;
+  saveProcessState();
+  Serial.printf("[%s] Process state reset.\n", getName());
+}
+
+void Vessel::setSensorAlarm(const Event &event) {
+  sensorAlarm = event.value != 0.0f;
+  Serial.printf("[%s] Sensoralarm %s (%s %s, grænse %s)\n", getName(), sensorAlarm ? "aktiv" : "ophørt",
+                pins->sensorName, sensorHealthName(health), sensorHealthName(limitHealth));
+}
+
+// ----------------------------
+// Kommandoer udefra
+// ----------------------------
+void Vessel::startMashing() {
+  postSimple(Event::Type::COMMAND, Event::Command::START_MASHING);
+}
+
+void Vessel::startMashout() {
+  postSimple(Event::Type::COMMAND, Event::Command::START_MASHOUT);
+}
+
+void Vessel::startBoiling() {
+  postSimple(Event::Type::COMMAND, Event::Command::START_BOILING);
+}
+
+void Vessel::stopProcess() {
+  postSimple(Event::Type::COMMAND, Event::Command::STOP);
+}
+
+void Vessel::pauseProcess() {
+  postSimple(Event::Type::COMMAND, Event::Command::PAUSE);
+}
+
+void Vessel::resumeProcess() {
+  postSimple(Event::Type::COMMAND, Event::Command::RESUME);
+}
+
+bool Vessel::startAutotune(float setpointC) {
+  if (currentState != BrewState::IDLE) {
+    Serial.printf("[%s] Autotuning kan kun startes fra IDLE.\n", getName());
+    return false;
+  }
+  return postSimple(Event::Type::COMMAND, Event::Command::START_AUTOTUNE, setpointC);
+}
+
+const MashStep &Vessel::currentStep() const {
+  return schedule.steps[stepIndex < schedule.count ? stepIndex : schedule.count - 1];
+}
+
+// Heapen for kogningen, uden de tilsætninger, der allerede er bekræftet.
+void Vessel::loadAdditionHeap() {
+  additionHeap.load(additions, boilTime);
+  if (additionsDone > additionHeap.count()) {
+    additionsDone = additionHeap.count();
+  }
+  for (uint8_t i = 0; i < additionsDone; i++) {
+    additionHeap.pop();
+  }
+  additionPosted = false;
+}
+
+void Vessel::startCountdown(unsigned long durationSec) {
+  processStartMillis = Clock::nowMs();
+  processStartEpoch  = Clock::epoch();
+  countdownMs = durationSec * 1000UL;
+  timerStarted = true;
+  timerFired = false;
+  startTimeStr = Clock::localTimeString();
+  endTimeStr = processStartEpoch != 0 ? Clock::formatLocal(processStartEpoch + durationSec) : startTimeStr;
+}
+
+void Vessel::saveProcessState() {
+  JournalEntry entry;
+  entry.state = static_cast<uint8_t>(currentState);
+  entry.previousState = static_cast<uint8_t>(previousState);
+  entry.stepIndex = stepIndex;
+  entry.additionsDone = additionsDone;
+  entry.timerStarted = timerStarted;
+  entry.boilingComplete = boilingComplete;
+  entry.elapsedMs = static_cast<uint32_t>(elapsedMs());
+  entry.epoch = Clock::epoch();
+  journal.append(entry);
+  lastCheckpoint = Clock::nowMs();
+}
+
+// Nedtællingens forløb; under PAUSED det, der var forløbet ved pausen.
+uint64_t Vessel::elapsedMs() const {
+  if (!timerStarted) {
+    return 0;
+  }
+  return currentState == BrewState::PAUSED ? pauseOffset : Clock::nowMs() - processStartMillis;
+}
+
+// En udløbet nedtælling (der venter på knappen, eller et kar, der holder
+// sidste trin) har intet nyt at gemme.
+void Vessel::checkpointProgress(uint64_t now) {
+  bool counting = currentState == BrewState::MASHING || currentState == BrewState::BOILHEATUP ||
+                  currentState == BrewState::BOILING;
+  if (counting && timerStarted && !timerFired && now - lastCheckpoint >= CHECKPOINT_INTERVAL_MS) {
+    saveProcessState();
+  }
+}
+
+// Genoptager ud fra journalens seneste post. Den forløbne tid er gemt i
+// selve posten, så det virker også uden klokken (AP-tilstand); kendes
+// klokken, lægges tiden uden strøm til. Udfaldets længde afgør ikke, om der
+// genoptages – en udløbet nedtælling går videre som efter TIMER.
+bool Vessel::restoreProcessState() {
+  JournalEntry entry;
+  if (!journal.latest(entry)) {
+    return index == KETTLE_VESSEL && restoreLegacyState();
+  }
+  const uint8_t autotune = static_cast<uint8_t>(BrewState::AUTOTUNE);
+  if (entry.state == static_cast<uint8_t>(BrewState::IDLE) || entry.state >= autotune ||
+      entry.state == LEGACY_MASHOUT_STATE || entry.previousState >= autotune ||
+      entry.previousState == LEGACY_MASHOUT_STATE) {
+    return false;
+  }
+  BrewState state = static_cast<BrewState>(entry.state);
+  BrewState counting = state == BrewState::PAUSED ? static_cast<BrewState>(entry.previousState) : state;
+  if (counting == BrewState::MASHING && entry.stepIndex >= schedule.count) {
+    return false;
+  }
+
+  uint64_t elapsed = entry.elapsedMs;
+  unsigned long currentEpoch = Clock::epoch();
+  if (entry.epoch != 0 && currentEpoch >= entry.epoch) {
+    unsigned long outage = currentEpoch - entry.epoch;
+    Serial.printf("[%s] Strømmen har været væk i %lu min.\n", getName(), outage / 60);
+    if (state != BrewState::PAUSED && entry.timerStarted) {
+      elapsed += outage * 1000ULL;
+    }
+  }
+
+  currentState = state;
+  previousState = static_cast<BrewState>(entry.previousState);
+  stepIndex = counting == BrewState::MASHING ? entry.stepIndex : 0;
+  timerStarted = entry.timerStarted;
+  boilingComplete = entry.boilingComplete;
+  timerFired = false;
+  uint64_t now = Clock::nowMs();
+  pauseOffset = elapsed;
+  processStartMillis = now - elapsed;
+  switch (counting) {
+    case BrewState::MASHING:    countdownMs = currentStep().minutes * 60000UL; break;
+    case BrewState::BOILHEATUP: countdownMs = boilHeatupTime * 1000UL; break;
+    case BrewState::BOILING:    countdownMs = boilTime * 1000UL; break;
+    default:                    countdownMs = 0; break;
+  }
+  processStartEpoch = currentEpoch != 0 ? currentEpoch - static_cast<unsigned long>(elapsed / 1000) : 0;
+  if (timerStarted && processStartEpoch != 0) {
+    startTimeStr = Clock::formatLocal(processStartEpoch);
+    endTimeStr = Clock::formatLocal(processStartEpoch + countdownMs / 1000);
+  }
+  if (counting == BrewState::BOILING && timerStarted) {
+    additionsDone = entry.additionsDone;
+    loadAdditionHeap();
+  }
+  awaitBoilStart();
+  lastCheckpoint = now;
+  Serial.printf("[%s] Genoptaget fra journalen: %s, %lu s forløbet.\n", getName(), stateName(currentState),
+                static_cast<unsigned long>(elapsed / 1000));
+  return true;
+}
+
+bool Vessel::restoreLegacyState() {
+  ProcessState ps;
+  Hal::storageGet(EEPROM_PROCESS_STATE_START, ps);
+  if (ps.processStartEpoch == 0)
+    return false;
+
+  // En afbrudt autotuning genoptages ikke – den skal startes forfra.
+  if (ps.currentState == static_cast<uint8_t>(BrewState::AUTOTUNE))
+    return false;
+
+  // Udmæskning gemt af ældre firmware fortsætter som planens sidste trin.
+  if (ps.currentState == LEGACY_MASHOUT_STATE) {
+    ps.currentState = static_cast<uint8_t>(BrewState::MASHING);
+    ps.stepIndex = schedule.count - 1;
+  }
+  if (ps.currentState > static_cast<uint8_t>(BrewState::AUTOTUNE))
+    return false;
+  if (ps.currentState == static_cast<uint8_t>(BrewState::MASHING) && ps.stepIndex >= schedule.count)
+    return false;
+
+  // Epoch er UTC og 0, indtil SNTP har synkroniseret; så genoptages intet.
+  unsigned long currentEpoch = Clock::epoch();
+  if (currentEpoch - ps.processStartEpoch < 3600) {
+    currentState = static_cast<BrewState>(ps.currentState);
+    stepIndex = ps.currentState == static_cast<uint8_t>(BrewState::MASHING) ? ps.stepIndex : 0;
+    timerStarted = ps.timerStarted;
+    processStartEpoch = ps.processStartEpoch;
+    unsigned long elapsed = currentEpoch - processStartEpoch;
+    processStartMillis = Clock::nowMs() - elapsed * 1000ULL;
+    switch (currentState) {
+      case BrewState::MASHING:    countdownMs = currentStep().minutes * 60000UL; break;
+      case BrewState::BOILHEATUP: countdownMs = boilHeatupTime * 1000UL; break;
+      case BrewState::BOILING:    countdownMs = boilTime * 1000UL; break;
+      default:                    countdownMs = 0; break;
+    }
+    timerFired = false;
+    if (currentState == BrewState::BOILING && timerStarted) {
+      additionsDone = ps.additionsDone;
+      loadAdditionHeap();
+    }
+    awaitBoilStart();
+    Serial.printf("[%s] Process state restored.\n", getName());
+    return true;
+  }
+  return false;
+}
+
+void Vessel::resetProcessState() {
+  postSimple(Event::Type::COMMAND, Event::Command::RESET);
+}
+
+String Vessel::getProcessStatus() const {
+  switch (currentState) {
+    case BrewState::IDLE:
+      return "Idle";
+    case BrewState::MASHING: {
+      const MashStep &step = currentStep();
+      String name = mashStepName(stepIndex, schedule.count, "Mæskning", "Udmæskning");
+      if (timerFired && !boils() && !hasNextStep()) {
+        return "Holder " + tempRawToString(step.target) + " °C";
+      }
+      return timerStarted ? name + " - Tid: " + getRemainingTimeFormatted() : name + ": varmer op til " + tempRawToString(step.target) + " °C - Tid: " + String(step.minutes) + " min";
+    }
+    case BrewState::BOILHEATUP: {
+      String status = "Opvarmning til kog ved " + String(boilDetector.getBoilingPoint(), 1) + " °C";
+      float rate = boilDetector.getRate();
+      if (!isnan(rate)) {
+        status += " (" + String(rate, 2) + " °C/min)";
+      }
+      return timerStarted ? status + " - Tid: " + getRemainingTimeFormatted() : status;
+    }
+    case BrewState::BOILING: {
+      if (!timerStarted) {
+        return "Venter på kogepunkt - Tid: " + String(boilTime / 60) + " min";
+      }
+      String status = "Kogning - Tid: " + getRemainingTimeFormatted();
+      unsigned long secondsLeft;
+      if (const BoilAddition *addition = getDueAddition()) {
+        status += " - Tilsæt nu: " + String(addition->name);
+      } else if (const BoilAddition *next = getNextAddition(secondsLeft)) {
+        status += " - Næste: " + String(next->name) + " om " + String((secondsLeft + 59) / 60) + " min";
+      }
+      return status;
+    }
+    case BrewState::PAUSED:
+      return "PAUSE";
+    case BrewState::AUTOTUNE:
+      return "Autotuning om " + tempRawToString(autotuneSetpoint) + " °C - Svingning " + String(autoTuner.getCycles());
+    default:
+      return "Ukendt";
+  }
+}
+
+// Under PAUSED står nedtællingen stille på det, der var tilbage ved pausen.
+unsigned long Vessel::getRemainingTime() const {
+  unsigned long duration = 0;
+  BrewState counting = currentState == BrewState::PAUSED ? previousState : currentState;
+  switch (counting) {
+    case BrewState::MASHING:
+      duration = currentStep().minutes * 60UL;
+      break;
+    case BrewState::BOILHEATUP:
+      duration = boilHeatupTime;
+      break;
+    case BrewState::BOILING:
+      duration = boilTime;
+      break;
+    case BrewState::IDLE:
+    case BrewState::PAUSED:
+    case BrewState::AUTOTUNE:
+      return 0;
+  }
+  if (!timerStarted) {
+    return duration;
+  }
+  unsigned long elapsed = elapsedMs() / 1000;
+  return (elapsed >= duration) ? 0 : (duration - elapsed);
+}
+
+String Vessel::getRemainingTimeFormatted() const {
+  unsigned long rem = getRemainingTime();
+  unsigned long mm = rem / 60;
+  unsigned long ss = rem % 60;
+  char buf[24];  // Plads til to vilkårlige unsigned long
+  snprintf(buf, sizeof(buf), "%02lu:%02lu", mm, ss);
+  return String(buf);
+}
+
+String Vessel::getProcessSymbol() const {
+  switch (currentState) {
+    case BrewState::IDLE:    return "\xB0";
+    case BrewState::PAUSED:  return "\xBA";
+    default:                return "\x10";
+  }
+}
+
+Vessel::Status Vessel::getStatus() const {
+  if (!isActive()) {
+    return Status::OFF;
+  }
+  if (!isSensorUsable(health) || !isTempRawValid(temp)) {
+    return Status::SENSOR_FAULT;
+  }
+  bool holding = timerStarted && (currentState == BrewState::MASHING || currentState == BrewState::BOILING);
+  return holding ? Status::HOLDING : Status::HEATING;
+}
+
+const char *Vessel::statusName(Status status) {
+  switch (status) {
+    case Status::OFF:          return "OFF";
+    case Status::HEATING:      return "HEATING";
+    case Status::HOLDING:      return "HOLDING";
+    case Status::SENSOR_FAULT: return "SENSOR_FAULT";
+  }
+  return "?";
+}
+
+// Trinnets temperatur under mæskning (og pausen i den), planens første trin i
+// IDLE; kogningen har intet fast mål.
+TempRaw Vessel::getTarget() const {
+  BrewState state = currentState == BrewState::PAUSED ? previousState : currentState;
+  switch (state) {
+    case BrewState::IDLE:
+      return schedule.first().target;
+    case BrewState::MASHING:
+      return currentStep().target;
+    case BrewState::AUTOTUNE:
+      return autotuneSetpoint;
+    case BrewState::BOILHEATUP:
+    case BrewState::BOILING:
+    case BrewState::PAUSED:
+      break;
+  }
+  return TEMP_RAW_INVALID;
+}
+
+Vessel::SamplingPolicy Vessel::getSamplingPolicy() const {
+  return SAMPLING_POLICIES[static_cast<uint8_t>(samplingProfile)];
+}
+
+bool Vessel::togglePump() {
+  bool requested = pumpRelay.isRequested();
+  if (!hasPump() || (currentState != BrewState::IDLE && currentState != BrewState::PAUSED)) {
+    return requested;
+  }
+  return postSimple(Event::Type::COMMAND, Event::Command::TOGGLE_PUMP) ? !requested : requested;
+}
+
+bool Vessel::toggleGasValve() {
+  bool requested = heatRelay.isRequested();
+  if (currentState != BrewState::IDLE && currentState != BrewState::PAUSED) {
+    return requested;
+  }
+  return postSimple(Event::Type::COMMAND, Event::Command::TOGGLE_GAS) ? !requested : requested;
+}
+
+RelayActuator::Stats Vessel::getGasRelayStats() const {
+  return heatRelay.getStats(Clock::nowMs());
+}
+
+RelayActuator::Stats Vessel::getPumpRelayStats() const {
+  return pumpRelay.getStats(Clock::nowMs());
+}
+
+String Vessel::getEndTime() const {
+  if (!timerStarted) {
+    long eta = getSetpointEta();
+    unsigned long epoch = Clock::epoch();
+    if (eta >= 0 && epoch != 0)
+      return "Setpoint ca. " + Clock::formatLocal(epoch + eta);
+    return "Venter på at setpoint er nået";
+  }
+  return endTimeStr;
+}
+
+long Vessel::getSetpointEta() const {
+  if (currentState != BrewState::MASHING || currentStep().gas != GasPolicy::REGULATE) {
+    return -1;
+  }
+  TempRaw target = currentStep().target - hysteresis;
+  unsigned long seconds;
+  if (timerStarted || !thermalModel.estimateSecondsTo(tempRawToC(target), seconds)) {
+    return -1;
+  }
+  return static_cast<long>(seconds);
+}
+
+void Vessel::setHysteresis(float value) {
+  hysteresis = tempRawFromC(value);
+}
+float Vessel::getHysteresis() const {
+  return tempRawToC(hysteresis);
+}
+
+void Vessel::setValveOffset(float offset) {
+  valveOffset = tempRawFromC(offset);
+}
+
+float Vessel::getValveOffset() const {
+  return tempRawToC(valveOffset);
+}
+
+void Vessel::setPidGains(float kp, float ki, float kd) {
+  pidKp = kp;
+  pidKi = ki;
+  pidKd = kd;
+  pid.setGains(kp, ki, kd);
+}
+
+void Vessel::setPidWindow(unsigned long seconds) {
+  pidWindow = seconds;
+  heatOutput.configure(seconds * 1000UL, minPulseMs);
+}
+
+void Vessel::setBoilDetection(float altitudeM, float thresholdC) {
+  boilAltitude = altitudeM;
+  boilThreshold = thresholdC;
+  boilDetector.configure(altitudeM, thresholdC);
+}
+
+float Vessel::getGasDuty() const {
+  if (pidRunning && currentState == BrewState::MASHING) {
+    return pid.getOutput();
+  }
+  return heatRelay.isOn() ? 100.0f : 0.0f;
+}
+
+bool Vessel::setAdditions(const BoilAdditions &newAdditions) {
+  bool boiling = currentState == BrewState::BOILING ||
+                 (currentState == BrewState::PAUSED && previousState == BrewState::BOILING);
+  if (!newAdditions.isValid() || boiling) {
+    return false;
+  }
+  additions = newAdditions;
+  return true;
+}
+
+const BoilAddition *Vessel::getDueAddition() const {
+  if (awaiting != Awaiting::ADDITION || additionHeap.empty()) {
+    return nullptr;
+  }
+  return &additions.items[additionHeap.top().index];
+}
+
+const BoilAddition *Vessel::getNextAddition(unsigned long &secondsLeft) const {
+  if (currentState != BrewState::BOILING || !timerStarted || additionHeap.empty()) {
+    return nullptr;
+  }
+  const AdditionHeap::Entry &next = additionHeap.top();
+  unsigned long elapsed = (Clock::nowMs() - processStartMillis) / 1000;
+  secondsLeft = elapsed >= next.dueSec ? 0 : next.dueSec - elapsed;
+  return &additions.items[next.index];
+}
+
+// Under mæskningen må trinnene ikke skifte under nedtællingen eller
+// journalen, så kun temperaturerne kan rettes (fx HLT'ens mål, mens den holder).
+bool Vessel::setSchedule(const MashSchedule &newSchedule) {
+  bool mashing = currentState == BrewState::MASHING ||
+                 (currentState == BrewState::PAUSED && previousState == BrewState::MASHING);
+  if (!newSchedule.isValid() || (mashing && !sameTiming(schedule, newSchedule))) {
+    return false;
+  }
+  schedule = newSchedule;
+  return true;
+}
+
+// De faste indstillinger retter planens første og sidste trin. Ændringen
+// bruges kun, hvis planen stadig er gyldig (fx setpoint inden for grænserne).
+void Vessel::setMashTime(unsigned long time) {
+  MashSchedule changed = schedule;
+  changed.first().minutes = time / 60;
+  if (changed.isValid()) schedule = changed;
+}
+unsigned long Vessel::getMashTime() const {
+  return schedule.first().minutes * 60UL;
+}
+
+void Vessel::setMashoutTime(unsigned long time) {
+  MashSchedule changed = schedule;
+  changed.last().minutes = time / 60;
+  if (changed.isValid()) schedule = changed;
+}
+unsigned long Vessel::getMashoutTime() const {
+  return schedule.last().minutes * 60UL;
+}
+
+void Vessel::setMashSetpoint(float temp) {
+  MashSchedule changed = schedule;
+  changed.first().target = tempRawFromC(temp);
+  if (changed.isValid()) schedule = changed;
+}
+float Vessel::getMashSetpoint() const {
+  return tempRawToC(schedule.first().target);
+}
+
+void Vessel::setMashoutSetpoint(float temp) {
+  MashSchedule changed = schedule;
+  changed.last().target = tempRawFromC(temp);
+  if (changed.isValid()) schedule = changed;
+}
+float Vessel::getMashoutSetpoint() const {
+  return tempRawToC(schedule.last().target);
+}
+
+// ============================
+// PRIVATE METODER
+// ============================
+// Varmen slukkes altid med det samme; kun PID- og autotuningspulser
+// (temperatureControl/autotuneControl) venter på relæets minimumstid.
+void Vessel::gasControl(bool state) {
+  if (state) {
+    heatRelay.request(true, Clock::nowMs());
+  } else {
+    heatRelay.forceOff(Clock::nowMs());
+  }
+}
+
+void Vessel::pumpControl(bool state) {
+  if (hasPump()) {
+    pumpRelay.request(state, Clock::nowMs());
+  }
+}
+
+// Levetidstællerne gemmes i portioner for at skåne flashen; force gemmer
+// alt, der ikke er gemt (fx når bryggen er slut).
+void Vessel::saveRelayCounters(uint64_t now, bool force) {
+  uint32_t cycles = heatRelay.getUnsavedCycles() + pumpRelay.getUnsavedCycles();
+  uint64_t onMs = max(heatRelay.getUnsavedOnMs(now), pumpRelay.getUnsavedOnMs(now));
+  bool due = cycles >= RELAY_SAVE_CYCLES || onMs >= RELAY_SAVE_MS || (force && (cycles > 0 || onMs >= 1000));
+  if (!due) {
+    return;
+  }
+  EEPROMHandler::saveRelayCounters(index, heatRelay.getCounters(now), pumpRelay.getCounters(now));
+  heatRelay.markSaved(now);
+  pumpRelay.markSaved(now);
+}
+
+// Venter på knappen; LED'en viser det altid, buzzeren kun når der skal kaldes.
+// ProcessHandler spiller dem for alle kar under ét.
+void Vessel::awaitConfirmation(Awaiting what, bool buzzer) {
+  awaiting = what;
+  calling = buzzer;
+}
+
+// Kogning uden nedtælling venter på kogepunktet (enterBoiling()); kaldes, når
+// tilstanden sættes uden om entry.
+void Vessel::awaitBoilStart() {
+  if (currentState == BrewState::BOILING && !timerStarted) {
+    awaitConfirmation(Awaiting::START, true);
+  }
+}
+
+void Vessel::clearConfirmation() {
+  awaiting = Awaiting::NONE;
+  calling = false;
+}
+
+// PID-regulering af varmen med tidsproportionalt relæ og ventil offset.
+//
+// PID'en opdateres hvert sekund og giver en duty i procent, som omsættes til
+// én varmepuls pr. vindue (pidWindow). Ventilgrænsen (setpoint + valveOffset)
+// er en hård grænse uden om PID'en: overskrides den, slukkes varmen med det
+// samme, og integralet står stille, til ventilen er under grænsen igen. Et
+// kar uden grænsesensor har ingen ventilgrænse.
+//
+// Under opvarmningen (før nedtællingen) lukkes varmen desuden forudsigende:
+// viser den termiske model, at varmen, der allerede er på vej, vil løfte
+// karret til setpoint, lukkes varmen nu i stedet for ved setpoint.
+//
+// Degraderet drift ud fra sensorsundhed:
+//   OK/SUSPECT    – normal regulering på den filtrerede (spike-rensede) værdi
+//   STALE/FAILED  – varmen holdes slukket; pumpen og nedtællingen kører videre.
+//                   FAILED giver desuden sensoralarm på buzzeren.
+// Det gælder for både karrets sensor og grænsesensoren, da ventilgrænsen ikke
+// kan håndhæves uden en frisk ventilmåling. Under opvarmning og kog gælder
+// det samme for karrets sensor (sampleBoil). Varmen genoptages automatisk,
+// når sensoren igen leverer gyldige målinger.
+void Vessel::temperatureControl(TempRaw currentTemp, TempRaw setpoint, TempRaw tVentil) {
+  unsigned long now = Hal::millis();
+  bool gap = now - lastControlCall > PID_RESTART_MS;
+  lastControlCall = now;
+
+  // En ugyldig måling tænder aldrig for varmen.
+  bool limitUnusable = hasLimitSensor() && (!isSensorUsable(limitHealth) || !isTempRawValid(tVentil));
+  if (!isSensorUsable(health) || !isTempRawValid(currentTemp) || limitUnusable) {
+    if (heatRelay.isRequested()) {
+      gasControl(false);
+      Serial.printf("[%s] Varmen slukket: mangler pålidelig temperaturmåling.\n", getName());
+    }
+    pidRunning = false;
+    return;
+  }
+
+  if (!pidRunning || gap || setpoint != pidSetpoint) {
+    pid.reset();
+    heatOutput.reset();
+    pidSetpoint = setpoint;
+    lastPidUpdate = now - PID_SAMPLE_MS;
+    pidRunning = true;
+  }
+
+  bool valveLimit = hasLimitSensor() && tVentil >= setpoint + valveOffset;
+  float peak = 0.0f;
+  bool cutoff = !timerStarted && thermalModel.predictPeakIfOff(peak) && peak >= tempRawToC(setpoint);
+  if (cutoff != predictiveCutoff) {
+    predictiveCutoff = cutoff;
+    if (cutoff) {
+      Serial.printf("[%s] Forudsigende varmestop: forventet top %.2f °C\n", getName(), peak);
+    }
+  }
+  if (now - lastPidUpdate >= PID_SAMPLE_MS) {
+    float dtS = (now - lastPidUpdate) / 1000.0f;
+    lastPidUpdate = now;
+    if (valveLimit || cutoff) {
+      pid.hold(tempRawToC(currentTemp), dtS);
+    } else {
+      pid.update(tempRawToC(setpoint), tempRawToC(currentTemp), dtS);
+    }
+  }
+
+  bool pulse = heatOutput.update(pid.getOutput(), now);
+  if (valveLimit || cutoff) {
+    gasControl(false);
+  } else {
+    heatRelay.request(pulse, Clock::nowMs());
+  }
+}
+
+// Relæ-autotuning: varmen følger RelayAutoTuner, men ventilgrænsen og
+// sensorsundheden gælder præcis som under mæskning. Er grænsen nået, holdes
+// varmen slukket, selvom relæet beder om varme; svingningen bliver så mindre,
+// hvilket giver forsigtigere gains. Når tuningen er færdig, gemmes gains i
+// EEPROM og tages i brug med det samme.
+void Vessel::autotuneControl(TempRaw currentTemp, TempRaw tVentil) {
+  unsigned long now = Hal::millis();
+
+  bool limitUnusable = hasLimitSensor() && (!isSensorUsable(limitHealth) || !isTempRawValid(tVentil));
+  if (!isSensorUsable(health) || !isTempRawValid(currentTemp) || limitUnusable) {
+    if (heatRelay.isRequested()) {
+      gasControl(false);
+      Serial.printf("[%s] Varmen slukket: mangler pålidelig temperaturmåling.\n", getName());
+    }
+    return;
+  }
+
+  bool relay = autoTuner.update(tempRawToC(currentTemp), now);
+  bool valveLimit = hasLimitSensor() && tVentil >= autotuneSetpoint + valveOffset;
+  if (valveLimit != autotuneValveLimited) {
+    autotuneValveLimited = valveLimit;
+    if (valveLimit) {
+      Serial.printf("[%s] Ventilgrænse nået under autotuning – varmen holdes slukket.\n", getName());
+    }
+  }
+  if (valveLimit) {
+    gasControl(false);
+  } else {
+    heatRelay.request(relay, Clock::nowMs());
+  }
+
+  RelayAutoTuner::Status status = autoTuner.getStatus();
+  if (status == RelayAutoTuner::Status::RUNNING) {
+    return;
+  }
+  if (status == RelayAutoTuner::Status::DONE) {
+    const RelayAutoTuner::Result &result = autoTuner.getResult();
+    EEPROMHandler::saveVesselGains(index, result.kp, result.ki, result.kd);
+    Settings saved = EEPROMHandler::getVesselSettings(index);
+    setPidGains(saved.pidKp, saved.pidKi, saved.pidKd);
+    Serial.printf("[%s] Autotuning færdig. Nye PID-gains gemt.\n", getName());
+  } else {
+    Serial.printf("[%s] Autotuning mislykkedes: %s\n", getName(), autoTuner.getFailReason());
+  }
+  gasControl(false);
+  pumpControl(false);
+  postSimple(Event::Type::DONE);
+}
+
+void Vessel::updateSamplingProfile(TempRaw tVentil) {
+  TempRaw setpoint = currentState == BrewState::AUTOTUNE ? autotuneSetpoint : currentStep().target;
+  if (isTempRawValid(tVentil)) {
+    TempRaw limit = setpoint + valveOffset;
+    if (tVentil >= limit - VALVE_NEAR_MARGIN) {
+      valveNearLimit = true;
+    } else if (tVentil < limit - VALVE_NEAR_RELEASE) {
+      valveNearLimit = false;
+    }
+  }
+
+  SamplingProfile profile = SamplingProfile::IDLE;
+  switch (currentState) {
+    case BrewState::MASHING:
+      profile = (timerStarted && !valveNearLimit) ? SamplingProfile::HOLD : SamplingProfile::RAMP;
+      break;
+    case BrewState::AUTOTUNE:
+      profile = valveNearLimit ? SamplingProfile::RAMP : SamplingProfile::HOLD;
+      break;
+    case BrewState::BOILHEATUP:
+    case BrewState::BOILING:
+      profile = SamplingProfile::BOIL;
+      break;
+    case BrewState::IDLE:
+    case BrewState::PAUSED:
+      break;
+  }
+  samplingProfile = profile;
+}
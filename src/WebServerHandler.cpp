@@ -6,13 +6,72 @@
 #include "ProcessHandler.h"
 #include "TemperatureHandler.h"
 #include "PinConfig.h"
+#include "RecipeParser.h"
+#include "Hal.h"
+#include "Clock.h"
+#include "SafetySupervisor.h"
 #include <WiFi.h>
-#include <ESPmDNS.h>
 #include <Version.h>
 
 // Statisk webserver og HTTPUpdateServer
 WebServer WebServerHandler::server(80);
 HTTPUpdateServer WebServerHandler::httpUpdater;
+RecipeParser WebServerHandler::recipeParser;
+bool WebServerHandler::recipeReady = false;
+
+namespace {
+  // Navne fra opskrifter og tilsætninger kan indeholde anførselstegn o.l.
+  String jsonText(const char *text) {
+    String result;
+    for (; *text; text++) {
+      if (*text == '"' || *text == '\\') {
+        result += '\\';
+        result += *text;
+      } else {
+        result += static_cast<uint8_t>(*text) < 0x20 ? ' ' : *text;
+      }
+    }
+    return result;
+  }
+
+  // Relæets slid og forbrug til /status.
+  String relayJson(const RelayActuator::Stats &stats) {
+    return "{\"cycles\":" + String(stats.lifetime.cycles) +
+           ",\"onHours\":\"" + String(stats.lifetime.onSeconds / 3600.0f, 1) +
+           "\",\"sessionCycles\":" + String(stats.sessionCycles) +
+           ",\"sessionDuty\":\"" + String(stats.sessionDuty, 1) +
+           "\",\"averageOnSeconds\":\"" + String(stats.averageOnSeconds, 0) +
+           "\",\"deferred\":" + String(stats.deferred) + "}";
+  }
+
+  // Alle kar til /status i ét array; statusnavnene er de samme som i loggen.
+  String vesselsJson() {
+    String json = "[";
+    for (uint8_t i = 0; i < ProcessHandler::getVesselCount(); i++) {
+      const Vessel &vessel = ProcessHandler::getVessel(i);
+      if (i > 0) json += ",";
+      json += "{\"name\":\"" + jsonText(vessel.getName()) + "\",\"temp\":\"" + tempRawToString(vessel.getTemp()) +
+              "\",\"target\":\"" + tempRawToString(vessel.getTarget()) +
+              "\",\"enabled\":" + (vessel.isActive() ? "true" : "false") +
+              ",\"heating\":" + (vessel.isHeating() ? "true" : "false") +
+              ",\"status\":\"" + Vessel::statusName(vessel.getStatus()) +
+              "\",\"health\":\"" + sensorHealthName(vessel.getHealth()) +
+              "\",\"process\":\"" + jsonText(vessel.getProcessStatus().c_str()) +
+              "\",\"schedule\":\"" + jsonText(vessel.getSchedule().toString().c_str()) + "\"}";
+    }
+    json += "]";
+    return json;
+  }
+
+  // Sikkerhedsvagtens låste alarm (se SafetySupervisor.h).
+  String safetyJson() {
+    bool tripped = SafetySupervisor::isTripped();
+    unsigned long ago = tripped ? (Hal::millis() - SafetySupervisor::getTrippedAt()) / 1000 : 0;
+    return String("{\"tripped\":") + (tripped ? "true" : "false") + ",\"trip\":\"" +
+           SafetySupervisor::tripName(SafetySupervisor::getTrip()) + "\",\"trippedAgo\":" + String(ago) +
+           ",\"maxGasOn\":" + String(SafetySupervisor::getMaxGasOnTime()) + "}";
+  }
+}
 
 // HTML-header og -footer
 const char* HTML_HEADER = R"html(
@@ -39,9 +98,10 @@ const char* HTML_HEADER = R"html(
         .then(data => {
           document.getElementById('grydeTemp').innerText = data.grydeTemp + ' °C';
           document.getElementById('ventilTemp').innerText = data.ventilTemp + ' °C';
+          document.getElementById('sensorHealth').innerText = data.grydeHealth + ' / ' + data.ventilHealth;
           document.getElementById('currentTime').innerText = data.currentTime;
           document.getElementById('pumpStatus').innerText = data.pumpStatus;
-          document.getElementById('gasValveStatus').innerText = data.gasValveStatus;
+          document.getElementById('gasValveStatus').innerText = data.gasValveStatus + ' (' + data.gasDuty + ' %)';
           document.getElementById('startTime').innerText = data.startTime;
           document.getElementById('endTime').innerText = data.endTime;
           document.getElementById('processStatus').innerText = data.processStatus;
@@ -49,6 +109,25 @@ const char* HTML_HEADER = R"html(
           let mm = Math.floor(secRemain / 60);
           let ss = secRemain % 60;
           document.getElementById('timeRemaining').innerText = mm + ":" + (ss < 10 ? "0" + ss : ss);
+          document.getElementById('nextAddition').innerText = data.additionDue
+            ? 'Tilsæt nu: ' + data.nextAddition + ' (bekræft på knappen)'
+            : (data.nextAddition ? data.nextAddition + ' om ' + Math.ceil(data.nextAdditionIn / 60) + ' min' : '–');
+          document.getElementById('thermalModel').innerText = data.modelValid
+            ? data.modelHeatRate + ' °C/min, τ ' + data.modelTau + ' s, dødtid ' + data.modelDeadTime + ' s'
+            : 'Lærer…';
+          document.getElementById('relayWear').innerText =
+            'gas ' + data.gasRelay.cycles + ' tændinger, ' + data.gasRelay.onHours + ' t (' + data.gasRelay.sessionDuty
+            + ' % siden start), pumpe ' + data.pumpRelay.cycles + ' tændinger, ' + data.pumpRelay.onHours + ' t';
+          document.getElementById('vessels').innerHTML = data.vessels.map((v, i) =>
+            v.name + ': ' + v.temp + ' / ' + v.target + ' °C, ' + VESSEL_STATUS[v.status] + (v.heating ? ' (varmer)' : '')
+            + ' – ' + v.process
+            + " <button onclick='setVesselTarget(" + i + ")'>Mål</button>"
+            + " <button onclick='setVesselEnabled(" + i + "," + !v.enabled + ")'>" + (v.enabled ? 'Sluk' : 'Tænd') + "</button>"
+          ).join('<br/>') || '–';
+          document.getElementById('safety').innerHTML = data.safety.tripped
+            ? '<b>' + SAFETY_TRIP[data.safety.trip] + '</b> – gas og pumpe er slukket'
+              + " <button onclick='resetSafety()'>Nulstil</button>"
+            : 'OK';
 
           // Opdater indstillingsfelter kun hvis de ikke er i fokus
           const updateIfNotFocused = (id, value) => {
@@ -65,6 +144,14 @@ const char* HTML_HEADER = R"html(
           updateIfNotFocused('mashoutSetpoint', data.mashoutSetpoint);
           updateIfNotFocused('hysteresis', data.hysteresis);
           updateIfNotFocused('valveOffset', data.valveOffset);
+          updateIfNotFocused('pidKp', data.pidKp);
+          updateIfNotFocused('pidKi', data.pidKi);
+          updateIfNotFocused('pidKd', data.pidKd);
+          updateIfNotFocused('pidWindow', data.pidWindow);
+          updateIfNotFocused('boilAltitude', data.boilAltitude);
+          updateIfNotFocused('boilThreshold', data.boilThreshold);
+          updateIfNotFocused('mashSchedule', data.mashSchedule);
+          updateIfNotFocused('boilAdditions', data.boilAdditions);
         })
         .catch(err => {
           console.error("Status update error:", err);
@@ -72,6 +159,37 @@ const char* HTML_HEADER = R"html(
     }
     setInterval(updateStatus, 1000);
     
+    const VESSEL_STATUS = {OFF: 'slukket', HEATING: 'varmer op', HOLDING: 'holder', SENSOR_FAULT: 'sensorfejl'};
+    function vesselCommand(query) {
+      fetch('/vessel?' + query)
+        .then(response => response.text())
+        .then(data => {
+          alert(data);
+          updateStatus();
+        });
+    }
+    function setVesselTarget(i) {
+      const target = prompt('Nyt mål (°C)');
+      if (target) {
+        vesselCommand('i=' + i + '&target=' + encodeURIComponent(target));
+      }
+    }
+    function setVesselEnabled(i, on) {
+      vesselCommand('i=' + i + '&on=' + (on ? 1 : 0));
+    }
+    const SAFETY_TRIP = {
+      LOOP_STALLED: 'styringen hang', SENSORS_STALE: 'ingen friske målinger', KETTLE_OVERTEMP: 'gryden for varm',
+      VALVE_OVERTEMP: 'ventilen for varm', GAS_ON_TOO_LONG: 'gassen tændt for længe', WATCHDOG_RESET: 'watchdog-genstart',
+      VESSEL_OVERTEMP: 'et kar for varmt'
+    };
+    function resetSafety() {
+      fetch('/safety?reset=1')
+        .then(response => response.text())
+        .then(data => {
+          alert(data);
+          updateStatus();
+        });
+    }
     function togglePump() {
       fetch('/togglePump')
         .then(response => response.text())
@@ -167,6 +285,48 @@ const char* HTML_HEADER = R"html(
         // Alternativt: ESP.restart() kan kaldes fra server-siden.
       });
     }
+
+    function saveSchedule(event) {
+      event.preventDefault();
+      fetch('/saveSchedule', {
+        method: 'POST',
+        body: new URLSearchParams(new FormData(event.target))
+      })
+      .then(response => response.text())
+      .then(data => {
+        alert(data);
+        updateStatus();
+      });
+    }
+
+    function saveAdditions(event) {
+      event.preventDefault();
+      fetch('/saveAdditions', {
+        method: 'POST',
+        body: new URLSearchParams(new FormData(event.target))
+      })
+      .then(response => response.text())
+      .then(data => {
+        alert(data);
+        updateStatus();
+      });
+    }
+
+    function uploadRecipe(event) {
+      event.preventDefault();
+      fetch('/recipe', { method: 'POST', body: new FormData(event.target) })
+      .then(response => response.json().then(data => ({ ok: response.ok, data })))
+      .then(({ ok, data }) => {
+        if (!ok) {
+          alert('Fejl: ' + data.error);
+          return;
+        }
+        let text = data.name + ': ' + data.mashSchedule + ', kogning ' + data.boilTime + ' min';
+        data.additions.forEach(a => { text += '\n' + a.minutes + ' min: ' + a.name + ' (' + a.grams + ' g)'; });
+        alert(text);
+        updateStatus();
+      });
+    }
   </script>
 </head>
 <body onload="updateStatus()">
@@ -191,12 +351,18 @@ void WebServerHandler::handleRoot() {
     <strong>Aktuel tid:</strong> <span id='currentTime'></span><br/>
     <strong>Gryde Temp:</strong> <span id='grydeTemp'></span> °C<br/>
     <strong>Ventil Temp:</strong> <span id='ventilTemp'></span> °C<br/>
+    <strong>Sensorstatus (gryde/ventil):</strong> <span id='sensorHealth'></span><br/>
     <strong>Pumpe Status:</strong> <span id='pumpStatus'></span><br/>
     <strong>Gasventil Status:</strong> <span id='gasValveStatus'></span><br/>
     <strong>Starttidspunkt:</strong> <span id='startTime'></span><br/>
     <strong>Sluttidspunkt:</strong> <span id='endTime'></span><br/>
     <strong>Proces Status:</strong> <span id='processStatus'></span><br/>
-    <strong>Resterende tid:</strong> <span id='timeRemaining'></span>
+    <strong>Resterende tid:</strong> <span id='timeRemaining'></span><br/>
+    <strong>Kogetilsætning:</strong> <span id='nextAddition'></span><br/>
+    <strong>Grydemodel:</strong> <span id='thermalModel'></span><br/>
+    <strong>Relæer:</strong> <span id='relayWear'></span><br/>
+    <strong>Kar:</strong> <span id='vessels'></span><br/>
+    <strong>Sikkerhed:</strong> <span id='safety'></span>
   </div>
   <br/>
   <div style="display:flex; flex-wrap:wrap; gap:10px;">
@@ -248,10 +414,129 @@ void WebServerHandler::handleRoot() {
   html += "<div><label class='label'>Ventil Offset (°C):</label><br/><input type='text' name='offset' value='" + String(cfg.tempOffset) + "' style='width:60px;'/></div>";
   html += R"html(
     </div>
+    <!-- Femte række: PID-regulering af gassen -->
+    <div style="display:flex; justify-content: flex-start; align-items: flex-start; margin-bottom:10px;">
+      <div style="margin-right:10px;">
+        <label class='label'>PID Kp (%/°C):</label><br/>
+        <input type='text' id='pidKp' name='pidKp' style="width:60px;"/>
+      </div>
+      <div style="margin-right:10px;">
+        <label class='label'>PID Ki (%/°C·s):</label><br/>
+        <input type='text' id='pidKi' name='pidKi' style="width:60px;"/>
+      </div>
+      <div style="margin-right:10px;">
+        <label class='label'>PID Kd (%·s/°C):</label><br/>
+        <input type='text' id='pidKd' name='pidKd' style="width:60px;"/>
+      </div>
+      <div>
+        <label class='label'>Gasvindue (s):</label><br/>
+        <input type='text' id='pidWindow' name='pidWindow' style="width:60px;"/>
+      </div>
+      <div style="margin-left:10px; margin-right:10px;">
+        <label class='label'>Højde (m o.h.):</label><br/>
+        <input type='text' id='boilAltitude' name='boilAltitude' style="width:60px;"/>
+      </div>
+      <div>
+        <label class='label'>Kogemargin (°C):</label><br/>
+        <input type='text' id='boilThreshold' name='boilThreshold' style="width:60px;"/>
+      </div>
+    </div>
     <div style="text-align:left; margin-bottom:10px;">
       <input class='button' type='submit' value='Gem Indstillinger'/>
     </div>
   </form>
+  <hr/>
+  <h2>Mæskeplan</h2>
+  <form onsubmit='saveSchedule(event)' style="max-width:800px; margin:auto;">
+    <label class='label'>Trin (temp,min[,flag]; …):</label><br/>
+    <input type='text' id='mashSchedule' name='steps' style="width:100%;"/><br/>
+    <small>Flag: P = pumpe, G = gas regulerer, S = bekræft ved setpoint, E = bekræft når tiden er gået (standard PGSE).
+    Sidste trin er udmæskningen. Fx 52,15;64,45;72,20;78,10</small>
+    <div style="text-align:left; margin:10px 0;">
+      <input class='button' type='submit' value='Gem Mæskeplan'/>
+    </div>
+  </form>
+  <h2>Kogetilsætninger</h2>
+  <form onsubmit='saveAdditions(event)' style="max-width:800px; margin:auto;">
+    <label class='label'>Tilsætninger (min før slut,navn[,gram]; …):</label><br/>
+    <input type='text' id='boilAdditions' name='items' style="width:100%;"/><br/>
+    <small>Buzzeren kalder, når en tilsætning skal i, og den bekræftes på knappen. 0 min = ved kogningens slutning
+    (fx whirlpool). Fx 60,Magnum,25;15,Irish moss;10,Cascade,30;0,Whirlpool</small>
+    <div style="text-align:left; margin:10px 0;">
+      <input class='button' type='submit' value='Gem Tilsætninger'/>
+    </div>
+  </form>
+  <form onsubmit='uploadRecipe(event)' style="max-width:800px; margin:auto;">
+    <label class='label'>Importér opskrift (BeerXML eller BeerJSON):</label><br/>
+    <input type='file' name='recipe' accept='.xml,.json'/>
+    <input class='button' type='submit' value='Importér'/>
+  </form>
+  <hr/>
+  <h2>Autotuning af PID</h2>
+  <div style="margin-bottom:10px;">
+    <label class='label'>Setpoint (°C):</label>
+    <input type='text' id='autotuneSetpoint' style="width:60px;"/>
+    <button class='button' onclick='startAutotune()' title="Start Autotuning">Start Autotuning</button><br/>
+    <span id='autotuneStatus'></span>
+  </div>
+  <canvas id='autotuneTrace' width='600' height='200' style="width:100%; border:1px solid #ccc;"></canvas>
+  <script>
+    // Sporet hentes løbende med ?since=, så kun nye punkter overføres.
+    let tracePoints = [];
+    let traceSeq = 0;
+    function startAutotune() {
+      const sp = document.getElementById('autotuneSetpoint').value || document.getElementById('mashSetpoint').value;
+      fetch('/startAutotune?setpoint=' + encodeURIComponent(sp))
+        .then(response => response.text())
+        .then(data => {
+          tracePoints = [];
+          alert(data);
+          updateStatus();
+        });
+    }
+    function drawTrace(setpoint) {
+      const canvas = document.getElementById('autotuneTrace');
+      const ctx = canvas.getContext('2d');
+      ctx.clearRect(0, 0, canvas.width, canvas.height);
+      if (tracePoints.length < 2) return;
+      const temps = tracePoints.map(p => p[2]);
+      const lo = Math.min(setpoint - 1, ...temps), hi = Math.max(setpoint + 1, ...temps);
+      const t0 = tracePoints[0][1], t1 = tracePoints[tracePoints.length - 1][1];
+      const x = t => (t - t0) / Math.max(1, t1 - t0) * canvas.width;
+      const y = v => canvas.height - (v - lo) / (hi - lo) * canvas.height;
+      ctx.fillStyle = '#fdd';
+      tracePoints.forEach((p, i) => {
+        if (p[3] && i + 1 < tracePoints.length) ctx.fillRect(x(p[1]), 0, x(tracePoints[i + 1][1]) - x(p[1]), canvas.height);
+      });
+      ctx.strokeStyle = '#888';
+      ctx.beginPath(); ctx.moveTo(0, y(setpoint)); ctx.lineTo(canvas.width, y(setpoint)); ctx.stroke();
+      ctx.strokeStyle = '#007BFF';
+      ctx.beginPath();
+      tracePoints.forEach((p, i) => i ? ctx.lineTo(x(p[1]), y(p[2])) : ctx.moveTo(x(p[1]), y(p[2])));
+      ctx.stroke();
+    }
+    function updateAutotune() {
+      fetch('/autotune?since=' + traceSeq)
+        .then(response => response.json())
+        .then(data => {
+          if (data.trace.length && data.trace[0][0] < traceSeq) tracePoints = [];
+          data.trace.forEach(p => tracePoints.push(p));
+          tracePoints = tracePoints.slice(-240);
+          traceSeq = data.seq;
+          let text = data.status;
+          if (data.status === 'RUNNING') text += ' – svingning ' + data.cycles;
+          if (data.status === 'DONE') text += ' – Ku ' + data.ku + ', Tu ' + data.tu + ' s -> Kp ' + data.kp + ', Ki ' + data.ki + ', Kd ' + data.kd;
+          if (data.status === 'FAILED') text += ' – ' + data.reason;
+          document.getElementById('autotuneStatus').innerText = text;
+          drawTrace(parseFloat(data.setpoint));
+        })
+        .catch(err => {
+          console.error("Autotune update error:", err);
+        });
+    }
+    setInterval(updateAutotune, 2000);
+  </script>
+  <hr/>
   <div style="text-align:left; margin-bottom:10px;">
     <button class='button' onclick='resetProcessState()' title="Reset Process">Reset Process</button>
   </div>
@@ -265,23 +550,79 @@ void WebServerHandler::handleRoot() {
 }
 
 void WebServerHandler::handleStatus() {
+  // Ét snapshot, så gryde- og ventiltemperatur altid stammer fra samme måling
+  TemperatureSnapshot sample = TemperatureHandler::getSnapshot();
+  AcquisitionStats acq = TemperatureHandler::getStats();
   String json = "{";
-  json += "\"grydeTemp\":\"" + String(TemperatureHandler::getGrydeTemp(), 1) + "\","; 
-  json += "\"ventilTemp\":\"" + String(TemperatureHandler::getVentilTemp(), 1) + "\","; 
+  json += "\"grydeTemp\":\"" + tempRawToString(sample.grydeTemp) + "\","; 
+  json += "\"ventilTemp\":\"" + tempRawToString(sample.ventilTemp) + "\","; 
+  json += "\"grydeFiltered\":\"" + tempRawToString(sample.grydeEstimate.temp) + "\",";
+  json += "\"grydeRate\":\"" + String(sample.grydeEstimate.rate, 2) + "\",";
+  json += "\"grydeVariance\":\"" + String(sample.grydeEstimate.variance, 4) + "\",";
+  json += "\"ventilFiltered\":\"" + tempRawToString(sample.ventilEstimate.temp) + "\",";
+  json += "\"ventilRate\":\"" + String(sample.ventilEstimate.rate, 2) + "\",";
+  json += "\"grydeHealth\":\"" + String(sensorHealthName(TemperatureHandler::checkStaleness(sample.grydeHealth, sample.timestamp))) + "\",";
+  json += "\"ventilHealth\":\"" + String(sensorHealthName(TemperatureHandler::checkStaleness(sample.ventilHealth, sample.timestamp))) + "\",";
+  json += "\"sensorAlarm\":" + String(ProcessHandler::isSensorAlarmActive() ? "true" : "false") + ",";
+  json += "\"sampleAge\":" + String(Hal::millis() - sample.timestamp) + ",";
+  json += "\"sensorJitter\":" + String(acq.lastJitter) + ",";
+  json += "\"sensorMaxJitter\":" + String(acq.maxJitter) + ",";
+  json += "\"sensors\":[";
+  for (uint8_t i = 0; i < sample.sensorCount; i++) {
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(TemperatureHandler::getSensorName(i)) + "\",\"temp\":\"" + tempRawToString(sample.temps[i])
+         + "\",\"filtered\":\"" + tempRawToString(sample.estimates[i].temp)
+         + "\",\"rate\":\"" + String(sample.estimates[i].rate, 2)
+         + "\",\"health\":\"" + String(sensorHealthName(sample.health[i])) + "\"}";
+  }
+  json += "],";
   json += "\"currentTime\":\"" + ProcessHandler::getFormattedTime() + "\","; 
-  json += "\"pumpStatus\":\"" + String(ProcessHandler::isPumpOn() ? "Pumpe tændt" : "Pumpe slukket") + "\","; 
-  json += "\"gasValveStatus\":\"" + String(ProcessHandler::isGasValveOn() ? "Gas åben" : "Gas lukket") + "\","; 
-  json += "\"startTime\":\"" + ProcessHandler::getStartTime() + "\","; 
-  json += "\"endTime\":\"" + ProcessHandler::getEndTime() + "\","; 
-  json += "\"processStatus\":\"" + ProcessHandler::getProcessStatus() + "\","; 
-  json += "\"timeRemaining\":\"" + String(ProcessHandler::getRemainingTime()) + "\","; 
-  json += "\"mashTime\":\"" + String(ProcessHandler::getMashTime()) + "\","; 
-  json += "\"mashoutTime\":\"" + String(ProcessHandler::getMashoutTime()) + "\","; 
-  json += "\"boilTime\":\"" + String(ProcessHandler::getBoilTime()) + "\","; 
-  json += "\"mashSetpoint\":\"" + String(ProcessHandler::getMashSetpoint()) + "\","; 
-  json += "\"mashoutSetpoint\":\"" + String(ProcessHandler::getMashoutSetpoint()) + "\","; 
-  json += "\"hysteresis\":\"" + String(ProcessHandler::getHysteresis()) + "\",";
-  json += "\"valveOffset\":\"" + String(ProcessHandler::getValveOffset()) + "\",";
+  json += "\"pumpStatus\":\"" + String(ProcessHandler::kettle().isPumpOn() ? "Pumpe tændt" : "Pumpe slukket") + "\","; 
+  json += "\"gasValveStatus\":\"" + String(ProcessHandler::kettle().isGasValveOn() ? "Gas åben" : "Gas lukket") + "\","; 
+  json += "\"startTime\":\"" + ProcessHandler::kettle().getStartTime() + "\","; 
+  json += "\"endTime\":\"" + ProcessHandler::kettle().getEndTime() + "\","; 
+  json += "\"processStatus\":\"" + ProcessHandler::kettle().getProcessStatus() + "\","; 
+  json += "\"timeRemaining\":\"" + String(ProcessHandler::kettle().getRemainingTime()) + "\","; 
+  json += "\"mashTime\":\"" + String(ProcessHandler::kettle().getMashTime()) + "\","; 
+  json += "\"mashoutTime\":\"" + String(ProcessHandler::kettle().getMashoutTime()) + "\","; 
+  json += "\"boilTime\":\"" + String(ProcessHandler::kettle().getBoilTime()) + "\",";
+  bool mashing = ProcessHandler::kettle().getCurrentState() == Vessel::BrewState::MASHING;
+  json += "\"mashSchedule\":\"" + ProcessHandler::kettle().getSchedule().toString() + "\",";
+  json += "\"mashStep\":" + String(mashing ? ProcessHandler::kettle().getStepIndex() + 1 : 0) + ",";
+  json += "\"mashSteps\":" + String(ProcessHandler::kettle().getSchedule().count) + ","; 
+  json += "\"boilAdditions\":\"" + jsonText(ProcessHandler::kettle().getAdditions().toString().c_str()) + "\",";
+  unsigned long additionIn = 0;
+  const BoilAddition *dueAddition = ProcessHandler::kettle().getDueAddition();
+  const BoilAddition *nextAddition = dueAddition ? dueAddition : ProcessHandler::kettle().getNextAddition(additionIn);
+  json += "\"additionDue\":" + String(dueAddition ? "true" : "false") + ",";
+  json += "\"nextAddition\":\"" + (nextAddition ? jsonText(nextAddition->name) : String("")) + "\",";
+  json += "\"nextAdditionIn\":" + String(additionIn) + ",";
+  json += "\"mashSetpoint\":\"" + String(ProcessHandler::kettle().getMashSetpoint()) + "\","; 
+  json += "\"mashoutSetpoint\":\"" + String(ProcessHandler::kettle().getMashoutSetpoint()) + "\","; 
+  json += "\"hysteresis\":\"" + String(ProcessHandler::kettle().getHysteresis()) + "\",";
+  json += "\"valveOffset\":\"" + String(ProcessHandler::kettle().getValveOffset()) + "\",";
+  json += "\"pidKp\":\"" + String(ProcessHandler::kettle().getPidKp(), 3) + "\",";
+  json += "\"pidKi\":\"" + String(ProcessHandler::kettle().getPidKi(), 4) + "\",";
+  json += "\"pidKd\":\"" + String(ProcessHandler::kettle().getPidKd(), 1) + "\",";
+  json += "\"pidWindow\":\"" + String(ProcessHandler::kettle().getPidWindow()) + "\",";
+  const BoilDetector &boil = ProcessHandler::kettle().getBoilDetector();
+  float boilRate = boil.getRate();
+  json += "\"boilAltitude\":\"" + String(ProcessHandler::kettle().getBoilAltitude(), 0) + "\",";
+  json += "\"boilThreshold\":\"" + String(ProcessHandler::kettle().getBoilThreshold(), 1) + "\",";
+  json += "\"boilingPoint\":" + String(boil.getBoilingPoint(), 2) + ",";
+  json += "\"boilRate\":" + (isnan(boilRate) ? String("null") : String(boilRate, 2)) + ",";
+  json += "\"boilDetected\":" + String(boil.isBoiling() ? "true" : "false") + ",";
+  json += "\"gasDuty\":\"" + String(ProcessHandler::kettle().getGasDuty(), 0) + "\",";
+  json += "\"gasRelay\":" + relayJson(ProcessHandler::kettle().getGasRelayStats()) + ",";
+  json += "\"pumpRelay\":" + relayJson(ProcessHandler::kettle().getPumpRelayStats()) + ",";
+  json += "\"vessels\":" + vesselsJson() + ",";
+  json += "\"safety\":" + safetyJson() + ",";
+  const ThermalModel &thermal = ProcessHandler::kettle().getThermalModel();
+  json += "\"setpointEta\":\"" + String(ProcessHandler::kettle().getSetpointEta()) + "\",";
+  json += "\"modelValid\":" + String(thermal.isValid() ? "true" : "false") + ",";
+  json += "\"modelTau\":\"" + String(thermal.getTauS(), 0) + "\",";
+  json += "\"modelDeadTime\":\"" + String(thermal.getDeadTimeS(), 0) + "\",";
+  json += "\"modelHeatRate\":\"" + String(thermal.getHeatRate(), 2) + "\",";
   json += "\"version\":\"" + String(SOFTWARE_VERSION) + "\"";
   json += "}";
   server.send(200, "application/json", json);
@@ -294,102 +635,327 @@ void WebServerHandler::handleDebug() {
 }
 
 void WebServerHandler::handleTogglePump() {
-  bool pumpState = ProcessHandler::togglePump();
+  bool pumpState = ProcessHandler::kettle().togglePump();
   server.send(200, "text/plain", pumpState ? "Pumpe tændt" : "Pumpe slukket");
 }
 
 void WebServerHandler::handleToggleGasValve() {
-  bool gasState = ProcessHandler::toggleGasValve();
+  bool gasState = ProcessHandler::kettle().toggleGasValve();
   server.send(200, "text/plain", gasState ? "Gas åben" : "Gas lukket");
 }
 
 void WebServerHandler::handleStartMashing() {
-  ProcessHandler::startMashing();
+  ProcessHandler::kettle().startMashing();
   server.send(200, "text/plain", "Mæskning startet");
 }
 
 void WebServerHandler::handleStartMashout() {
-  ProcessHandler::startMashout();
+  ProcessHandler::kettle().startMashout();
   server.send(200, "text/plain", "Udmæskning startet");
 }
 
 void WebServerHandler::handleStartBoiling() {
-  ProcessHandler::startBoiling();
+  ProcessHandler::kettle().startBoiling();
   server.send(200, "text/plain", "Kogning startet");
 }
 
 void WebServerHandler::handleStopProcess() {
-  ProcessHandler::stopProcess();
+  ProcessHandler::kettle().stopProcess();
   server.send(200, "text/plain", "Proces stoppet");
 }
 
 void WebServerHandler::handlePauseProcess() {
-  ProcessHandler::pauseProcess();
+  ProcessHandler::kettle().pauseProcess();
   server.send(200, "text/plain", "Proces pauset");
 }
 
 void WebServerHandler::handleResumeProcess() {
-  ProcessHandler::resumeProcess();
+  ProcessHandler::kettle().resumeProcess();
   server.send(200, "text/plain", "Proces genoptaget");
 }
 
+void WebServerHandler::handleStartAutotune() {
+  float setpoint = server.hasArg("setpoint") ? server.arg("setpoint").toFloat() : ProcessHandler::kettle().getMashSetpoint();
+  if (!(setpoint > 20.0f && setpoint < 90.0f)) {
+    server.send(400, "text/plain", "Ugyldigt setpoint");
+    return;
+  }
+  if (!ProcessHandler::kettle().startAutotune(setpoint)) {
+    server.send(409, "text/plain", "Autotuning kan kun startes, når der ikke brygges");
+    return;
+  }
+  server.send(200, "text/plain", "Autotuning startet");
+}
+
+// Autotuningens status og spor. ?since=<seq> giver kun punkter nyere end seq,
+// så UI'et kan hente sporet løbende uden at overføre det hele hver gang.
+// Hvert punkt er [seq, sekunder siden start, temperatur, gas].
+void WebServerHandler::handleAutotune() {
+  static const char *STATUS_NAMES[] = {"IDLE", "RUNNING", "DONE", "FAILED"};
+  static RelayAutoTuner::TracePoint points[RelayAutoTuner::TRACE_SIZE];
+  const RelayAutoTuner &tuner = ProcessHandler::kettle().getAutoTuner();
+  uint32_t since = server.hasArg("since") ? server.arg("since").toInt() : 0;
+  size_t count = tuner.getTrace(since, points, RelayAutoTuner::TRACE_SIZE);
+  const RelayAutoTuner::Result &result = tuner.getResult();
+
+  String json = "{";
+  json += "\"status\":\"" + String(STATUS_NAMES[static_cast<uint8_t>(tuner.getStatus())]) + "\",";
+  json += "\"setpoint\":\"" + String(tuner.getSetpoint(), 1) + "\",";
+  json += "\"cycles\":" + String(tuner.getCycles()) + ",";
+  json += "\"reason\":\"" + String(tuner.getFailReason()) + "\",";
+  json += "\"ku\":\"" + String(result.ku, 1) + "\",";
+  json += "\"tu\":\"" + String(result.tuS, 0) + "\",";
+  json += "\"kp\":\"" + String(result.kp, 3) + "\",";
+  json += "\"ki\":\"" + String(result.ki, 4) + "\",";
+  json += "\"kd\":\"" + String(result.kd, 1) + "\",";
+  json += "\"seq\":" + String(tuner.getTraceSeq()) + ",";
+  json += "\"trace\":[";
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) json += ",";
+    json += "[" + String(points[i].seq) + "," + String(points[i].timeS) + "," + tempRawToString(points[i].temp) + "," +
+            String(points[i].gasOn ? 1 : 0) + "]";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
+
+// Mæskeplanen som JSON (GET /schedule).
+void WebServerHandler::handleSchedule() {
+  const MashSchedule &schedule = ProcessHandler::kettle().getSchedule();
+  String json = "{\"text\":\"" + schedule.toString() + "\",\"steps\":[";
+  for (uint8_t i = 0; i < schedule.count; i++) {
+    const MashStep &step = schedule.steps[i];
+    if (i > 0) json += ",";
+    json += "{\"target\":\"" + tempRawToString(step.target) + "\",\"minutes\":" + String(step.minutes) +
+            ",\"pump\":" + String(step.pump == PumpMode::ON ? "true" : "false") +
+            ",\"gas\":" + String(step.gas == GasPolicy::REGULATE ? "true" : "false") +
+            ",\"confirmStart\":" + String(step.confirmStart ? "true" : "false") +
+            ",\"confirmEnd\":" + String(step.confirmEnd ? "true" : "false") + "}";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
+
+// Ny mæskeplan i tekstformatet fra MashSchedule.h (POST /saveSchedule?steps=...).
+void WebServerHandler::handleSaveSchedule() {
+  MashSchedule schedule;
+  if (!server.hasArg("steps") || !schedule.parse(server.arg("steps").c_str())) {
+    server.send(400, "text/plain", "Ugyldig mæskeplan");
+    return;
+  }
+  if (!ProcessHandler::kettle().setSchedule(schedule)) {
+    server.send(409, "text/plain", "Under mæskning kan kun trinnenes temperaturer ændres");
+    return;
+  }
+  EEPROMHandler::saveSchedule(schedule);
+  server.send(200, "text/plain", "Mæskeplan gemt (" + String(schedule.count) + " trin)");
+}
+
+// Et kars mæskeplan og start/stop: /vessel?i=<kar>[&target=<°C>][&steps=<plan>][&on=0|1].
+// target retter planens første trin, steps erstatter hele planen (MashSchedule.h);
+// on=1 starter mæskeplanen fra IDLE, on=0 stopper karret.
+void WebServerHandler::handleVessel() {
+  long index = server.hasArg("i") ? server.arg("i").toInt() : -1;
+  bool changesSchedule = server.hasArg("target") || server.hasArg("steps");
+  if (index < 0 || index >= ProcessHandler::getVesselCount() || (!changesSchedule && !server.hasArg("on"))) {
+    server.send(400, "text/plain", "Ukendt kar eller intet at ændre");
+    return;
+  }
+  Vessel &vessel = ProcessHandler::getVessel(index);
+  if (changesSchedule) {
+    MashSchedule schedule = vessel.getSchedule();
+    if (server.hasArg("steps") && !schedule.parse(server.arg("steps").c_str())) {
+      server.send(400, "text/plain", "Ugyldig mæskeplan");
+      return;
+    }
+    if (server.hasArg("target")) {
+      schedule.first().target = tempRawFromC(server.arg("target").toFloat());
+    }
+    if (!schedule.isValid()) {
+      server.send(400, "text/plain", "Ugyldigt mål");
+      return;
+    }
+    if (!vessel.setSchedule(schedule)) {
+      server.send(409, "text/plain", "Under mæskning kan kun trinnenes temperaturer ændres");
+      return;
+    }
+    EEPROMHandler::saveVesselSchedule(index, schedule);
+  }
+  if (server.hasArg("on")) {
+    if (server.arg("on").toInt() == 0) {
+      vessel.stopProcess();
+    } else if (vessel.getCurrentState() == Vessel::BrewState::IDLE) {
+      vessel.startMashing();
+    }
+  }
+  server.send(200, "text/plain", String(vessel.getName()) + ": " + vessel.getSchedule().toString() + ", " +
+                                     (server.hasArg("on") ? (server.arg("on").toInt() != 0 ? "startes" : "stoppes")
+                                                          : vessel.getProcessStatus()));
+}
+
+// Sikkerhedsvagtens alarm: GET /safety viser den, /safety?reset=1 nulstiller
+// den, hvis årsagen er væk.
+void WebServerHandler::handleSafety() {
+  if (server.hasArg("reset")) {
+    if (!SafetySupervisor::reset()) {
+      server.send(409, "text/plain", String("Årsagen er der stadig (") +
+                                         SafetySupervisor::tripName(SafetySupervisor::getTrip()) + ")");
+      return;
+    }
+    server.send(200, "text/plain", "Sikkerhedsalarmen er nulstillet");
+    return;
+  }
+  server.send(200, "application/json", safetyJson());
+}
+
+// Kogetilsætninger i tekstformatet fra BoilAdditions.h (POST /saveAdditions?items=...).
+void WebServerHandler::handleSaveAdditions() {
+  BoilAdditions additions;
+  if (!server.hasArg("items") || !additions.parse(server.arg("items").c_str())) {
+    server.send(400, "text/plain", "Ugyldige tilsætninger");
+    return;
+  }
+  if (!ProcessHandler::kettle().setAdditions(additions)) {
+    server.send(409, "text/plain", "Tilsætningerne kan ikke ændres under kogning");
+    return;
+  }
+  EEPROMHandler::saveAdditions(additions);
+  server.send(200, "text/plain", "Tilsætninger gemt (" + String(additions.count) + ")");
+}
+
+// Opskriften modtages som multipart-upload og fødes bid for bid til parseren,
+// så selv store eksporter med mange opskrifter ikke fylder i RAM.
+void WebServerHandler::handleRecipeUpload() {
+  HTTPUpload &upload = server.upload();
+  if (upload.status == UPLOAD_FILE_START) {
+    recipeParser.begin();
+    recipeReady = false;
+  } else if (upload.status == UPLOAD_FILE_WRITE) {
+    recipeParser.feed(upload.buf, upload.currentSize);
+  } else if (upload.status == UPLOAD_FILE_END) {
+    recipeReady = recipeParser.finish();
+  }
+}
+
+// Svar på POST /recipe: mæskeplan og kogetid tages i brug og gemmes.
+void WebServerHandler::handleRecipe() {
+  // En afbrudt upload når aldrig UPLOAD_FILE_END og bliver derfor ikke brugt.
+  if (!recipeReady) {
+    const char *error = recipeParser.getError() ? recipeParser.getError() : "Ingen hel fil modtaget";
+    server.send(400, "application/json", "{\"error\":\"" + String(error) + "\"}");
+    return;
+  }
+  recipeReady = false;
+  const Recipe &recipe = recipeParser.getRecipe();
+  if (!ProcessHandler::kettle().setSchedule(recipe.mash)) {
+    server.send(409, "application/json", "{\"error\":\"Mæskeplanen kan ikke ændres under mæskning\"}");
+    return;
+  }
+  EEPROMHandler::saveSchedule(recipe.mash);
+  // Under en kogning beholdes dens tilsætninger; resten af opskriften bruges.
+  bool additionsSaved = ProcessHandler::kettle().setAdditions(recipe.additions);
+  if (additionsSaved) {
+    EEPROMHandler::saveAdditions(recipe.additions);
+  }
+  if (recipe.boilMinutes > 0) {
+    Config cfg = EEPROMHandler::getConfig();
+    cfg.boilTime = recipe.boilMinutes * 60UL;
+    ProcessHandler::kettle().setBoilTime(cfg.boilTime);
+    EEPROMHandler::saveConfig(cfg);
+  }
+  Serial.println("[WebServerHandler] Opskrift '" + String(recipe.name) + "' importeret (" +
+                 String(recipeParser.getBytes()) + " bytes)");
+
+  String json = "{\"name\":\"" + jsonText(recipe.name) + "\",";
+  json += "\"format\":\"" + String(recipeParser.getFormat() == RecipeParser::Format::BEERXML ? "BeerXML" : "BeerJSON") + "\",";
+  json += "\"mashSchedule\":\"" + recipe.mash.toString() + "\",";
+  json += "\"boilTime\":" + String(recipe.boilMinutes) + ",";
+  json += "\"skippedSteps\":" + String(recipe.skippedSteps) + ",";
+  json += "\"skippedAdditions\":" + String(recipe.skippedAdditions) + ",";
+  json += "\"additionsSaved\":" + String(additionsSaved ? "true" : "false") + ",";
+  json += "\"additions\":[";
+  for (uint8_t i = 0; i < recipe.additions.count; i++) {
+    const BoilAddition &addition = recipe.additions.items[i];
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + jsonText(addition.name) + "\",\"minutes\":" + String(addition.minutes) + ",\"grams\":" +
+            String(addition.grams) + "}";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
+
 void WebServerHandler::handleResetProcessState() {
-  ProcessHandler::resetProcessState();
+  ProcessHandler::kettle().resetProcessState();
   server.send(200, "text/plain", "Process state reset. System is now IDLE.");
 }
 
 void WebServerHandler::handleSaveSettings() {
   Config cfg = EEPROMHandler::getConfig();
   if (server.hasArg("ssid"))
-    strncpy(cfg.ssid, server.arg("ssid").c_str(), sizeof(cfg.ssid));
+    snprintf(cfg.ssid, sizeof(cfg.ssid), "%s", server.arg("ssid").c_str());
   if (server.hasArg("password"))
-    strncpy(cfg.password, server.arg("password").c_str(), sizeof(cfg.password));
+    snprintf(cfg.password, sizeof(cfg.password), "%s", server.arg("password").c_str());
   if (server.hasArg("ip"))
-    strncpy(cfg.ip, server.arg("ip").c_str(), sizeof(cfg.ip));
+    snprintf(cfg.ip, sizeof(cfg.ip), "%s", server.arg("ip").c_str());
   if (server.hasArg("gw"))
-    strncpy(cfg.gw, server.arg("gw").c_str(), sizeof(cfg.gw));
+    snprintf(cfg.gw, sizeof(cfg.gw), "%s", server.arg("gw").c_str());
   if (server.hasArg("sn"))
-    strncpy(cfg.sn, server.arg("sn").c_str(), sizeof(cfg.sn));
+    snprintf(cfg.sn, sizeof(cfg.sn), "%s", server.arg("sn").c_str());
+  if (server.hasArg("tz") && Clock::isValidTimezone(server.arg("tz").c_str())) {
+    snprintf(cfg.timezone, sizeof(cfg.timezone), "%s", server.arg("tz").c_str());
+    Clock::setTimezone(cfg.timezone);
+  }
   
   if (server.hasArg("offset")) {
   cfg.tempOffset = server.arg("offset").toFloat();
-  ProcessHandler::setValveOffset(cfg.tempOffset);
+  ProcessHandler::kettle().setValveOffset(cfg.tempOffset);
   }
 
   if (server.hasArg("hysteresis")) {
   cfg.hysteresis = server.arg("hysteresis").toFloat();
-  ProcessHandler::setHysteresis(cfg.hysteresis);
+  ProcessHandler::kettle().setHysteresis(cfg.hysteresis);
   }
   
-  if (server.hasArg("mashTime")) {
-    cfg.mashTime = server.arg("mashTime").toInt() * 60;
-    ProcessHandler::setMashTime(cfg.mashTime);
-  }
-  if (server.hasArg("mashoutTime")) {
-    cfg.mashoutTime = server.arg("mashoutTime").toInt() * 60;
-    ProcessHandler::setMashoutTime(cfg.mashoutTime);
-  }
+  // Mæsketid og setpoints retter mæskeplanens første og sidste trin.
+  if (server.hasArg("mashTime"))
+    ProcessHandler::kettle().setMashTime(server.arg("mashTime").toInt() * 60);
+  if (server.hasArg("mashoutTime"))
+    ProcessHandler::kettle().setMashoutTime(server.arg("mashoutTime").toInt() * 60);
   if (server.hasArg("boilTime")) {
     cfg.boilTime = server.arg("boilTime").toInt() * 60;
-    ProcessHandler::setBoilTime(cfg.boilTime);
-  }
-  if (server.hasArg("mashSetpoint")) {
-    cfg.mashSetpoint = server.arg("mashSetpoint").toFloat();
-    ProcessHandler::setMashSetpoint(cfg.mashSetpoint);
-  }
-  if (server.hasArg("mashoutSetpoint")) {
-    cfg.mashoutSetpoint = server.arg("mashoutSetpoint").toFloat();
-    ProcessHandler::setMashoutSetpoint(cfg.mashoutSetpoint);
+    ProcessHandler::kettle().setBoilTime(cfg.boilTime);
   }
+  if (server.hasArg("mashSetpoint"))
+    ProcessHandler::kettle().setMashSetpoint(server.arg("mashSetpoint").toFloat());
+  if (server.hasArg("mashoutSetpoint"))
+    ProcessHandler::kettle().setMashoutSetpoint(server.arg("mashoutSetpoint").toFloat());
+  EEPROMHandler::saveSchedule(ProcessHandler::kettle().getSchedule());
+  if (server.hasArg("pidKp"))
+    cfg.pidKp = server.arg("pidKp").toFloat();
+  if (server.hasArg("pidKi"))
+    cfg.pidKi = server.arg("pidKi").toFloat();
+  if (server.hasArg("pidKd"))
+    cfg.pidKd = server.arg("pidKd").toFloat();
+  if (server.hasArg("pidWindow"))
+    cfg.pidWindow = server.arg("pidWindow").toInt();
+  if (server.hasArg("boilAltitude"))
+    cfg.boilAltitude = server.arg("boilAltitude").toFloat();
+  if (server.hasArg("boilThreshold"))
+    cfg.boilThreshold = server.arg("boilThreshold").toFloat();
   EEPROMHandler::saveConfig(cfg);
+  // saveConfig() erstatter ugyldige PID- og kogeparametre, så de hentes tilbage derfra.
+  cfg = EEPROMHandler::getConfig();
+  ProcessHandler::kettle().setPidGains(cfg.pidKp, cfg.pidKi, cfg.pidKd);
+  ProcessHandler::kettle().setPidWindow(cfg.pidWindow);
+  ProcessHandler::kettle().setBoilDetection(cfg.boilAltitude, cfg.boilThreshold);
   server.send(200, "text/html", "<h1>Indstillinger gemt</h1><p>Indstillingerne er blevet gemt.</p>");
 }
 
 void WebServerHandler::handleResetSettings() {
   EEPROMHandler::resetToDefaults();
   server.send(200, "text/html", "<h1>Indstillinger nulstillet</h1><p>Indstillingerne er blevet nulstillet.</p>");
-  delay(1500);
-  ESP.restart();
+  Hal::delay(1500);
+  Hal::restart();
 }
 
 
@@ -411,7 +977,10 @@ void WebServerHandler::handleSettings() {
   html += "<label class='label'>Gateway:</label><br/>";
   html += "<input type='text' name='gw' value='" + String(cfg.gw) + "'/><br/>";
   html += "<label class='label'>Subnet:</label><br/>";
-  html += "<input type='text' name='sn' value='" + String(cfg.sn) + "'/><br/><br/>";
+  html += "<input type='text' name='sn' value='" + String(cfg.sn) + "'/><br/>";
+  html += "<label class='label'>Tidszone (POSIX TZ):</label><br/>";
+  html += "<input type='text' name='tz' value='" + String(cfg.timezone) + "' style='width:260px;'/><br/>";
+  html += "<small>Fx CET-1CEST,M3.5.0,M10.5.0/3 (Danmark, med sommertid)</small><br/><br/>";
   html += "<input class='button' type='submit' value='Gem WiFi Indstillinger'/>";
   html += "</form>";
 
@@ -441,6 +1010,14 @@ void WebServerHandler::begin() {
   server.on("/resumeProcess", HTTP_GET, handleResumeProcess);
   server.on("/resetProcessState", HTTP_GET, handleResetProcessState);
   server.on("/debug", handleDebug);
+  server.on("/startAutotune", handleStartAutotune);
+  server.on("/autotune", handleAutotune);
+  server.on("/schedule", HTTP_GET, handleSchedule);
+  server.on("/saveSchedule", HTTP_POST, handleSaveSchedule);
+  server.on("/saveAdditions", HTTP_POST, handleSaveAdditions);
+  server.on("/vessel", handleVessel);
+  server.on("/safety", handleSafety);
+  server.on("/recipe", HTTP_POST, handleRecipe, handleRecipeUpload);
 
   httpUpdater.setup(&server);
   server.begin();
@@ -450,3 +1027,7 @@ void WebServerHandler::begin() {
 void WebServerHandler::handleClient() {
   server.handleClient();
 }
+
+WebServer &WebServerHandler::getServer() {
+  return server;
+}
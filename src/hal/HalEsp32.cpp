@@ -0,0 +1,169 @@
+#include "Hal.h"
+#include "RmtOneWireBus.h"
+#include "ArduinoOneWireBus.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <esp32-hal-rgb-led.h>
+#include <esp_idf_version.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <time.h>
+
+namespace {
+  constexpr uint8_t BUZZER_CHANNEL = 7;
+  constexpr uint32_t BUZZER_FREQUENCY_HZ = 750;  // Kun til opsætningen; tonen sættes pr. mønstertrin
+  constexpr uint8_t BUZZER_RESOLUTION_BITS = 10;
+  constexpr uint32_t BUZZER_DUTY = 256;  // ca. 25% duty for blødere lyd
+
+  // RMT-kanaler til 1-Wire. Kanal 0 overlades til neopixelWrite() (status-LED'en),
+  // som allokerer fra bunden; ESP32-S3 har TX på 0-3 og RX på 4-7.
+  constexpr uint8_t ONE_WIRE_RMT_TX_FIRST = 2;
+  constexpr uint8_t ONE_WIRE_RMT_RX_FIRST = 6;
+  constexpr uint8_t MAX_ONE_WIRE_BUSES = 2;
+
+  uint8_t oneWireBusCount = 0;
+
+  const char *NTP_SERVER_1 = "pool.ntp.org";
+  const char *NTP_SERVER_2 = "time.google.com";
+  // Systemuret starter i 1970; tider før dette er ikke synkroniseret endnu.
+  constexpr time_t MIN_VALID_EPOCH = 1704067200;  // 2024-01-01
+}
+
+unsigned long Hal::millis() {
+  return ::millis();
+}
+
+uint64_t IRAM_ATTR Hal::millis64() {
+  return esp_timer_get_time() / 1000;
+}
+
+void Hal::delay(unsigned long ms) {
+  ::delay(ms);
+}
+
+void Hal::pinMode(uint8_t pin, uint8_t mode) {
+  ::pinMode(pin, mode);
+}
+
+void Hal::digitalWrite(uint8_t pin, bool high) {
+  ::digitalWrite(pin, high ? HIGH : LOW);
+}
+
+bool IRAM_ATTR Hal::digitalRead(uint8_t pin) {
+  return ::digitalRead(pin) == HIGH;
+}
+
+void Hal::attachPinChange(uint8_t pin, void (*handler)()) {
+  attachInterrupt(digitalPinToInterrupt(pin), handler, CHANGE);
+}
+
+bool Hal::startPeriodic(void (*callback)(), unsigned long periodMs) {
+  esp_timer_create_args_t args = {};
+  args.callback = [](void *arg) { reinterpret_cast<void (*)()>(arg)(); };
+  args.arg = reinterpret_cast<void *>(callback);
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "hal_periodic";
+  esp_timer_handle_t timer;
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    return false;
+  }
+  return esp_timer_start_periodic(timer, static_cast<uint64_t>(periodMs) * 1000) == ESP_OK;
+}
+
+void Hal::buzzerBegin(uint8_t pin) {
+  ledcSetup(BUZZER_CHANNEL, BUZZER_FREQUENCY_HZ, BUZZER_RESOLUTION_BITS);
+  ledcAttachPin(pin, BUZZER_CHANNEL);
+  buzzerTone(0);
+}
+
+void Hal::buzzerTone(uint16_t frequencyHz) {
+  if (frequencyHz) {
+    ledcWriteTone(BUZZER_CHANNEL, frequencyHz);
+    ledcWrite(BUZZER_CHANNEL, BUZZER_DUTY);
+  } else {
+    ledcWrite(BUZZER_CHANNEL, 0);
+  }
+}
+
+void Hal::rgbWrite(uint8_t pin, uint8_t r, uint8_t g, uint8_t b) {
+  neopixelWrite(pin, r, g, b);
+}
+
+bool Hal::storageBegin(size_t size) {
+  return EEPROM.begin(size);
+}
+
+void Hal::storageRead(int address, void *data, size_t len) {
+  EEPROM.readBytes(address, data, len);
+}
+
+void Hal::storageWrite(int address, const void *data, size_t len) {
+  EEPROM.writeBytes(address, data, len);
+}
+
+bool Hal::storageCommit() {
+  return EEPROM.commit();
+}
+
+// Bustimingen genereres af RMT-periferien; lykkes det ikke at få kanalerne,
+// falder vi tilbage til OneWire-bibliotekets bit-banging.
+OneWireBus *Hal::oneWireBus(uint8_t pin) {
+  if (oneWireBusCount >= MAX_ONE_WIRE_BUSES) {
+    return nullptr;
+  }
+  uint8_t index = oneWireBusCount++;
+  RmtOneWireBus *rmt = new RmtOneWireBus(pin, ONE_WIRE_RMT_TX_FIRST + index, ONE_WIRE_RMT_RX_FIRST + index);
+  if (rmt->begin()) {
+    return rmt;
+  }
+  delete rmt;
+  Serial.printf("[Hal] RMT utilgængelig på GPIO %u – bruger bit-banging\n", pin);
+  ArduinoOneWireBus *wire = new ArduinoOneWireBus(pin);
+  wire->begin();
+  return wire;
+}
+
+// lwIP's SNTP-klient synkroniserer systemuret i baggrunden (standard hver
+// time). configTime() sætter også TZ, men den sættes bagefter af Clock.
+void Hal::networkTimeBegin() {
+  configTime(0, 0, NTP_SERVER_1, NTP_SERVER_2);
+}
+
+unsigned long Hal::epochTime() {
+  time_t now = time(nullptr);
+  return now >= MIN_VALID_EPOCH ? static_cast<unsigned long>(now) : 0;
+}
+
+// Task-watchdoggens timeout og panik gælder alle tilmeldte tasks, også
+// IDLE-tasks, som Arduino-kernen melder til. Er den allerede startet, bruges
+// den, som den er; ellers startes den uden IDLE-tasks, så kun de tasks, der
+// selv melder sig, er omfattet.
+bool Hal::watchdogBegin(uint32_t timeoutS) {
+  if (esp_task_wdt_status(nullptr) == ESP_ERR_INVALID_STATE) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_task_wdt_config_t config = {timeoutS * 1000, 0, true};
+    if (esp_task_wdt_init(&config) != ESP_OK) {
+      return false;
+    }
+#else
+    if (esp_task_wdt_init(timeoutS, true) != ESP_OK) {
+      return false;
+    }
+#endif
+  }
+  return esp_task_wdt_add(nullptr) == ESP_OK;
+}
+
+void Hal::watchdogFeed() {
+  esp_task_wdt_reset();
+}
+
+bool Hal::wasWatchdogReset() {
+  esp_reset_reason_t reason = esp_reset_reason();
+  return reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT || reason == ESP_RST_WDT;
+}
+
+void Hal::restart() {
+  ESP.restart();
+}
@@ -0,0 +1,272 @@
+#include "Hal.h"
+#include "HalSim.h"
+#include <string.h>
+
+namespace {
+  constexpr uint8_t PIN_COUNT = 64;
+  constexpr uint8_t MAX_SENSOR_BUSES = 4;
+  constexpr uint8_t MAX_PERIODIC = 4;
+
+  unsigned long clockMs = 0;
+
+  uint8_t pinModes[PIN_COUNT] = {};
+  bool inputLevels[PIN_COUNT] = {};
+  bool outputLevels[PIN_COUNT] = {};
+  uint32_t writeCounts[PIN_COUNT] = {};
+  void (*pinHandlers[PIN_COUNT])() = {};
+  uint16_t buzzerHz = 0;
+  uint32_t buzzerWrites = 0;
+
+  uint8_t storage[HalSim::STORAGE_SIZE] = {};
+  size_t storageSize = 0;
+
+  SimOneWireBus sensorBuses[MAX_SENSOR_BUSES];
+  uint8_t sensorBusPins[MAX_SENSOR_BUSES];
+  uint8_t sensorBusCount = 0;
+
+  // Epoch ved clockMs = 0; 0 betyder, at der ikke er nogen netværkstid.
+  unsigned long epochBase = 0;
+  uint32_t restartCount = 0;
+  uint32_t commitCount = 0;
+
+  // Periodiske callbacks kører på deres virtuelle tidspunkter, mens uret flyttes.
+  struct Periodic {
+    void (*callback)();
+    unsigned long periodMs;
+    unsigned long nextMs;
+  };
+  Periodic periodics[MAX_PERIODIC];
+  uint8_t periodicCount = 0;
+  bool runningPeriodic = false;
+
+  bool validPin(uint8_t pin) {
+    return pin < PIN_COUNT;
+  }
+
+  void advanceClock(unsigned long ms) {
+    unsigned long target = clockMs + ms;
+    if (runningPeriodic) {
+      clockMs = target;
+      return;
+    }
+    runningPeriodic = true;
+    for (;;) {
+      Periodic *next = nullptr;
+      for (uint8_t i = 0; i < periodicCount; i++) {
+        if (periodics[i].nextMs <= target && (!next || periodics[i].nextMs < next->nextMs)) {
+          next = &periodics[i];
+        }
+      }
+      if (!next) {
+        break;
+      }
+      clockMs = max(clockMs, next->nextMs);
+      next->nextMs += next->periodMs;
+      next->callback();
+    }
+    clockMs = target;
+    runningPeriodic = false;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Hal
+// ---------------------------------------------------------------------------
+unsigned long Hal::millis() {
+  return clockMs;
+}
+
+uint64_t Hal::millis64() {
+  return clockMs;
+}
+
+void Hal::delay(unsigned long ms) {
+  advanceClock(ms);
+}
+
+void Hal::pinMode(uint8_t pin, uint8_t mode) {
+  if (!validPin(pin)) {
+    return;
+  }
+  pinModes[pin] = mode;
+  if (mode == INPUT_PULLUP) {
+    inputLevels[pin] = true;
+  }
+}
+
+void Hal::digitalWrite(uint8_t pin, bool high) {
+  if (!validPin(pin)) {
+    return;
+  }
+  if (outputLevels[pin] != high) {
+    writeCounts[pin]++;
+  }
+  outputLevels[pin] = high;
+}
+
+bool Hal::digitalRead(uint8_t pin) {
+  if (!validPin(pin)) {
+    return false;
+  }
+  return pinModes[pin] == OUTPUT ? outputLevels[pin] : inputLevels[pin];
+}
+
+void Hal::buzzerBegin(uint8_t pin) {
+  (void)pin;
+  buzzerHz = 0;
+}
+
+void Hal::buzzerTone(uint16_t frequencyHz) {
+  buzzerHz = frequencyHz;
+  buzzerWrites++;
+}
+
+void Hal::rgbWrite(uint8_t pin, uint8_t r, uint8_t g, uint8_t b) {
+  (void)pin;
+  (void)r;
+  (void)g;
+  (void)b;
+}
+
+bool Hal::storageBegin(size_t size) {
+  if (size > HalSim::STORAGE_SIZE) {
+    return false;
+  }
+  storageSize = size;
+  return true;
+}
+
+void Hal::storageRead(int address, void *data, size_t len) {
+  if (address < 0 || address + len > storageSize) {
+    memset(data, 0, len);
+    return;
+  }
+  memcpy(data, storage + address, len);
+}
+
+void Hal::storageWrite(int address, const void *data, size_t len) {
+  if (address < 0 || address + len > storageSize) {
+    return;
+  }
+  memcpy(storage + address, data, len);
+}
+
+bool Hal::storageCommit() {
+  if (storageSize == 0) {
+    return false;
+  }
+  commitCount++;
+  return true;
+}
+
+OneWireBus *Hal::oneWireBus(uint8_t pin) {
+  SimOneWireBus *bus = HalSim::sensorBus(pin);
+  if (bus) {
+    bus->begin();
+  }
+  return bus;
+}
+
+void Hal::attachPinChange(uint8_t pin, void (*handler)()) {
+  if (validPin(pin)) {
+    pinHandlers[pin] = handler;
+  }
+}
+
+bool Hal::startPeriodic(void (*callback)(), unsigned long periodMs) {
+  if (periodicCount >= MAX_PERIODIC || periodMs == 0) {
+    return false;
+  }
+  periodics[periodicCount++] = {callback, periodMs, clockMs + periodMs};
+  return true;
+}
+
+// Ingen watchdog i simuleringen; SafetySupervisor kører som periodisk callback.
+bool Hal::watchdogBegin(uint32_t timeoutS) {
+  (void)timeoutS;
+  return false;
+}
+
+void Hal::watchdogFeed() {}
+
+bool Hal::wasWatchdogReset() {
+  return false;
+}
+
+void Hal::networkTimeBegin() {}
+
+unsigned long Hal::epochTime() {
+  return epochBase ? epochBase + clockMs / 1000 : 0;
+}
+
+void Hal::restart() {
+  restartCount++;
+  Serial.println("[Hal] Genstart anmodet (ignoreret i simuleringen)");
+}
+
+// ---------------------------------------------------------------------------
+// HalSim
+// ---------------------------------------------------------------------------
+void HalSim::advance(unsigned long ms) {
+  advanceClock(ms);
+}
+
+// Et niveauskift kalder pinnens handler med det samme, som en ISR ville.
+void HalSim::setInput(uint8_t pin, bool high) {
+  if (!validPin(pin) || inputLevels[pin] == high) {
+    return;
+  }
+  inputLevels[pin] = high;
+  if (pinHandlers[pin]) {
+    pinHandlers[pin]();
+  }
+}
+
+bool HalSim::getOutput(uint8_t pin) {
+  return validPin(pin) && outputLevels[pin];
+}
+
+uint32_t HalSim::getWriteCount(uint8_t pin) {
+  return validPin(pin) ? writeCounts[pin] : 0;
+}
+
+bool HalSim::isBuzzerOn() {
+  return buzzerHz != 0;
+}
+
+uint32_t HalSim::getBuzzerWrites() {
+  return buzzerWrites;
+}
+
+SimOneWireBus *HalSim::sensorBus(uint8_t pin) {
+  for (uint8_t i = 0; i < sensorBusCount; i++) {
+    if (sensorBusPins[i] == pin) {
+      return &sensorBuses[i];
+    }
+  }
+  if (sensorBusCount >= MAX_SENSOR_BUSES) {
+    return nullptr;
+  }
+  sensorBusPins[sensorBusCount] = pin;
+  return &sensorBuses[sensorBusCount++];
+}
+
+uint8_t *HalSim::storageData() {
+  return storage;
+}
+
+void HalSim::eraseStorage() {
+  memset(storage, 0, sizeof(storage));
+}
+
+void HalSim::setNetworkTime(unsigned long epoch) {
+  epochBase = epoch ? epoch - clockMs / 1000 : 0;
+}
+
+uint32_t HalSim::getRestartCount() {
+  return restartCount;
+}
+
+uint32_t HalSim::getCommitCount() {
+  return commitCount;
+}
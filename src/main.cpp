@@ -3,10 +3,12 @@
 #include "WebServerHandler.h"
 #include "TemperatureHandler.h"
 #include "ProcessHandler.h"
+#include "SafetySupervisor.h"
 #include "EEPROMHandler.h"
 #include "DisplayHandler.h"
 #include "OTAHandler.h"
 #include "StatusLED.h"
+#include "Clock.h"
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include "Version.h"
@@ -19,12 +21,7 @@
 unsigned long lastBlinkToggle = 0;
 bool blinkState = false;
 
-const unsigned long longPressThreshold = 3000; // 3000 ms = 3 sekunder
-unsigned long buttonPressStart = 0;
-bool longPressHandled = false;
-
-unsigned long lastTemperatureRead = 0;
-const unsigned long temperatureInterval = 1000; // 1 sekund
+const unsigned long temperatureInterval = 1000; // 1 sekund indtil ProcessHandler vælger en måleprofil
 
 void setup() {
   Serial.begin(115200);
@@ -37,11 +34,21 @@ void setup() {
   pinMode(PIN_PUMP, OUTPUT);
   pinMode(PIN_BUZZER, OUTPUT);
   pinMode(PIN_BUTTON, INPUT);
+  // Vagten startes, før noget kan tænde gassen; WiFi-forbindelsen og
+  // ventetiderne herunder tæller ikke, for hjerteslaget overvåges først fra loop().
+  SafetySupervisor::begin(PIN_GAS, PIN_PUMP);
 
   WiFiHandler::begin();
+  // SNTP kører i baggrunden; ventetiden er begrænset og kun ved opstart, så
+  // en gemt proces kan genoptages ud fra epoch.
+  Clock::begin(EEPROMHandler::getConfig().timezone);
+  if (!WiFiHandler::isAPMode() && !Clock::waitForSync(3000)) {
+    Serial.println("[Clock] Ingen tid fra SNTP endnu – fortsætter uden.");
+  }
   WebServerHandler::begin();
-  TemperatureHandler::begin(PIN_TEMP_GRYDE, PIN_TEMP_VENTIL);
-  ProcessHandler::begin(PIN_GAS, PIN_PUMP, PIN_BUZZER, PIN_BUTTON);
+  TemperatureHandler::begin(PIN_TEMP_GRYDE, PIN_TEMP_VENTIL, temperatureInterval);
+  TemperatureHandler::startTask();
+  ProcessHandler::begin(PIN_BUZZER, PIN_BUTTON);
   DisplayHandler::begin();
 
   DisplayHandler::displayBeerAnimation();
@@ -58,62 +65,52 @@ void setup() {
 }
 
 void loop() {
+  SafetySupervisor::heartbeat();
   WebServerHandler::handleClient();
   WiFiHandler::handleWiFi();
 
-  // Opdater temperatur hvert sekund
+  // Temperaturmålingen kører i sin egen task på kerne 0. Her læses blot det
+  // seneste målesæt, der altid er konsistent (begge sensorer fra samme konvertering).
+  // Styring og display bruger de filtrerede værdier (median + Kalman).
+  // En ugyldig måling videregives som ugyldig – der genbruges aldrig en gammel
+  // værdi. Sundheden tager også højde for, at selve snapshottet kan være forældet.
   unsigned long now = millis();
-  static float tGryde = NAN;
-  static float tVentil = NAN;
-  static bool isGrydeValid = false;
-  static bool isVentilValid = false;
-
-  if (now - lastTemperatureRead >= temperatureInterval) {
-    lastTemperatureRead = now;
-    TemperatureHandler::readTemperatures();
-
-    isGrydeValid = TemperatureHandler::isGrydeValid();
-    isVentilValid = TemperatureHandler::isVentilValid();
-
-    if (isGrydeValid) {
-      tGryde = TemperatureHandler::getGrydeTemp();
-    }
-    if (isVentilValid) {
-      tVentil = TemperatureHandler::getVentilTemp();
-    }
+  TemperatureHandler::update(); // no-op når måletasken kører
+  TemperatureSnapshot sample = TemperatureHandler::getSnapshot();
+  SensorHealth grydeHealth = TemperatureHandler::checkStaleness(sample.grydeHealth, sample.timestamp);
+  SensorHealth ventilHealth = TemperatureHandler::checkStaleness(sample.ventilHealth, sample.timestamp);
+  bool isGrydeValid = sample.grydeEstimate.valid && isSensorUsable(grydeHealth);
+  bool isVentilValid = sample.ventilEstimate.valid && isSensorUsable(ventilHealth);
+  TempRaw tGryde = isGrydeValid ? sample.grydeEstimate.temp : TEMP_RAW_INVALID;
+  TempRaw tVentil = isVentilValid ? sample.ventilEstimate.temp : TEMP_RAW_INVALID;
+
+  // Opdater processtyring og display med de aktuelle temperaturer. Hvert kar
+  // finder sine egne sensorer i målesættet.
+  ProcessHandler::update(sample);
+
+  // Opløsning og målefrekvens følger procesfasen. Sensorerne omprogrammeres
+  // kun, når profilen faktisk skifter.
+  static uint8_t appliedResolution = 0;
+  static unsigned long appliedInterval = 0;
+  ProcessHandler::SamplingPolicy policy = ProcessHandler::getSamplingPolicy();
+  if (policy.resolutionBits != appliedResolution || policy.intervalMs != appliedInterval) {
+    appliedResolution = policy.resolutionBits;
+    appliedInterval = policy.intervalMs;
+    TemperatureHandler::setResolution(policy.resolutionBits);
+    TemperatureHandler::setSampleInterval(policy.intervalMs);
   }
-
-  // Opdater processtyring og display med seneste gyldige temperaturer
-  ProcessHandler::update(tGryde, tVentil);
-  auto brewState = ProcessHandler::getCurrentState();
-  bool processRunning = (brewState != ProcessHandler::BrewState::IDLE) && (brewState != ProcessHandler::BrewState::PAUSED);
-
   DisplayHandler::update(
-    isGrydeValid ? tGryde : NAN,
-    isVentilValid ? tVentil : NAN,
+    tGryde,
+    tVentil,
     blinkState,
-    ProcessHandler::getProcessStep(),
-    ProcessHandler::getRemainingTime()
+    ProcessHandler::kettle().getProcessStep(),
+    ProcessHandler::kettle().getRemainingTime()
   );
 
-  StatusLED::setProcessActive(processRunning);
+  StatusLED::setProcessActive(ProcessHandler::isProcessActive());
   StatusLED::update();
 
-  if (digitalRead(PIN_BUTTON) == LOW) {
-    if (buttonPressStart == 0) {
-      buttonPressStart = millis();
-      longPressHandled = false;
-    } else if (!longPressHandled && (millis() - buttonPressStart >= longPressThreshold)) {
-      ProcessHandler::startMashing();
-      longPressHandled = true;
-      Serial.println("Long press: Start mæsning");
-    }
-  } else {
-    buttonPressStart = 0;
-    longPressHandled = false;
-  }
-
-  bool pumpOn = ProcessHandler::isPumpOn();
+  bool pumpOn = ProcessHandler::kettle().isPumpOn();
   if (!pumpOn) {
     if (now - lastBlinkToggle >= 500) {
       lastBlinkToggle = now;
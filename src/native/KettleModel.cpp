@@ -0,0 +1,36 @@
+#include "KettleModel.h"
+
+namespace {
+  // Ét Euler-skridt af et førsteordens led mod target.
+  float approach(float value, float target, float dtS, float tauS) {
+    if (tauS <= dtS) {
+      return target;
+    }
+    return value + (target - value) * dtS / tauS;
+  }
+}
+
+KettleModel::KettleModel(const KettleParams &params) : params(params) {
+  reset(params.ambientC);
+}
+
+void KettleModel::reset(float tempC) {
+  burnerPower = 0.0f;
+  kettle = tempC;
+  grydeSensor = tempC;
+  ventilSensor = tempC;
+}
+
+void KettleModel::step(float dtS, bool gasOn, bool pumpOn) {
+  burnerPower = approach(burnerPower, gasOn ? params.burnerW : 0.0f, dtS, params.burnerTauS);
+
+  float netW = burnerPower - params.lossWPerK * (kettle - params.ambientC);
+  kettle += netW * dtS / params.heatCapacityJPerK;
+  if (kettle > params.boilC) {
+    kettle = params.boilC;
+  }
+
+  float rise = (pumpOn ? params.ventilRisePumpC : params.ventilRiseC) * burnerPower / params.burnerW;
+  grydeSensor = approach(grydeSensor, kettle, dtS, params.grydeSensorTauS);
+  ventilSensor = approach(ventilSensor, kettle + rise, dtS, params.ventilSensorTauS);
+}
@@ -0,0 +1,629 @@
+// Indgang til env:native: deterministisk brygsimulator.
+//
+//   pio run -e native && .pio/build/native/program [-v] [-a] [-p <mæskeplan>] [-r <opskrift>] [-s <min>] [-h <min>]
+//
+// Styringsmodulerne kører uændret på simuleret hardware (HalSim). Uret er
+// virtuelt, så hele bryggen IDLE -> MASHING (mæskeplanens trin) ->
+// BOILHEATUP -> BOILING -> IDLE tager millisekunder. Gryden er en førsteordens termisk
+// model (KettleModel), der drives af gas- og pumperelæet og fodrer de
+// simulerede DS18B20'ere. Webkommandoer kommer fra et fast script, og en
+// simuleret brygger trykker på knappen, når buzzeren kalder. Kogepunktet
+// findes af BoilDetector; bryggeren trykker ikke for at starte kogetiden.
+//
+// Rapporten (tilstandsforløb, relæskift, oversving og samlet tid) er den
+// samme ved hver kørsel og bruges som regressionsbenchmark for ændringer i
+// styringen. -v viser desuden modulernes egen log. -a kører først en
+// relæ-autotuning om mæske-setpointet, lader gryden køle helt af og brygger
+// derefter med de fundne PID-gains. -p brygger med en anden mæskeplan end
+// scriptets mæskning + udmæskning (tekstformatet fra MashSchedule.h, fx
+// "52,15;64,45;72,20;78,10"). -r importerer i stedet en BeerXML/BeerJSON-fil
+// gennem /recipe. -s afbryder strømmen <min> minutter inde i scriptet: relæerne
+// falder fra i POWER_LOSS_MS, enheden starter igen uden netværkstid, og
+// ProcessHandler genoptager fra fremdriftsjournalen. -h lader loop() hænge i
+// LOOP_HANG_MS <min> minutter inde i scriptet (som en WiFi-forbindelse, der
+// ikke kommer): SafetySupervisor slukker gassen og låser alarmen, og bryggeren
+// nulstiller den på /safety, når loop() kører igen. Exit-koden er 1, hvis
+// bryggen ikke blev færdig inden for MAX_SIM_MS.
+
+// Simulatoren er et program for sig; testene i test/ (pio test -e native)
+// har deres egen main() og bygges uden den.
+#ifndef PIO_UNIT_TESTING
+
+#include <Arduino.h>
+#include <chrono>
+#include <climits>
+#include <vector>
+#include "BuzzerHandler.h"
+#include "Clock.h"
+#include "EEPROMHandler.h"
+#include "Hal.h"
+#include "HalSim.h"
+#include "KettleModel.h"
+#include "PinConfig.h"
+#include "ProcessHandler.h"
+#include "SafetySupervisor.h"
+#include "StatusLED.h"
+#include "TemperatureHandler.h"
+#include "WebServerHandler.h"
+
+namespace {
+  using BrewState = Vessel::BrewState;
+
+  constexpr unsigned long LOOP_STEP_MS = 20;
+  constexpr unsigned long MAX_SIM_MS = 8UL * 60 * 60 * 1000;
+  constexpr unsigned long OPERATOR_REACTION_MS = 15000;
+  constexpr unsigned long BUTTON_HOLD_MS = 200;
+  constexpr unsigned long POWER_LOSS_MS = 5000;
+  constexpr unsigned long LOOP_HANG_MS = 60000;  // WiFiHandlers forbindelsestimeout
+  constexpr unsigned long SIM_START_EPOCH = 1735732800;  // 2025-01-01 12:00 UTC
+  constexpr uint8_t MAX_TRANSITIONS = 32;
+  constexpr int LABEL_WIDTH = 14;
+
+  // CRC-byten (sidste byte) udfyldes af addSensor(), da Search ROM kræver den.
+  const OneWireRom GRYDE_ROM = {0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  const OneWireRom VENTIL_ROM = {0x28, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  // HLT'ens sensor sidder som "Gryde 2" på grydebussen (VESSEL_PINS).
+  const OneWireRom HLT_ROM = {0x28, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  constexpr uint8_t HLT_SENSOR_INDEX = 1;
+  constexpr uint8_t HLT_VESSEL = 1;
+  static_assert(HLT_VESSEL < VESSEL_COUNT, "Simulatoren kører med HLT'en: byg med -D ENABLE_HLT");
+
+  struct WebCommand {
+    unsigned long atMs;
+    HTTPMethod method;
+    const char *uri;
+  };
+
+  // Brygget: ét mæskehvil på 60 min, 10 min udmæskning og 60 min kogning.
+  // Tiderne er relative til scriptets start.
+  const WebCommand WEB_SCRIPT[] = {
+    {0, HTTP_POST, "/saveSettings?mashSetpoint=66&mashoutSetpoint=76&mashTime=60&mashoutTime=10"
+                   "&boilTime=60&hysteresis=0.5&offset=5"},
+    {0, HTTP_GET, "/vessel?i=1&target=78&on=1"},
+    {60000, HTTP_GET, "/startMashing"},
+  };
+
+  // HLT'en: ca. 40 L vand over et 3,5 kW varmelegeme, så skyllevandet er
+  // klar under mæskningen.
+  KettleParams hltParams() {
+    KettleParams params;
+    params.heatCapacityJPerK = 175000.0f;
+    params.burnerW = 3500.0f;
+    params.burnerTauS = 10.0f;
+    params.lossWPerK = 10.0f;
+    params.grydeSensorTauS = 10.0f;
+    return params;
+  }
+
+  // Sikkerhedsvagten: første udløsning, og hvornår bryggeren nulstillede den.
+  struct SafetyStats {
+    uint32_t trips;
+    SafetySupervisor::Trip firstTrip;
+    unsigned long trippedMs;
+    unsigned long resetMs;
+    unsigned long gasOffMs;  // Hvornår gassen faktisk var slukket efter udløsningen
+  };
+
+  // Temperaturforløbet i HLT'en, efter den er tændt.
+  struct VesselStats {
+    unsigned long reachedMs;  // 0 = målet ikke nået
+    float maxC;
+    float minAfterC;          // Laveste temperatur efter målet er nået
+  };
+
+  struct Transition {
+    unsigned long atMs;
+    BrewState from;
+    BrewState to;
+    uint8_t fromStep;  // Trin i mæskeplanen (kun under MASHING)
+    uint8_t toStep;
+    float kettleC;
+  };
+
+  // Temperaturforløb for et trin i mæskeplanen.
+  struct RestStats {
+    bool visited;
+    float setpointC;
+    float maxC;
+    float minHoldC;  // Laveste temperatur efter nedtællingen er startet
+    // Modellens ETA: hvornår den første gang var kendt, og spændet i de
+    // forudsagte ankomsttider holdt op mod den faktiske start på nedtællingen.
+    unsigned long firstEtaMs;
+    unsigned long minArrivalMs;
+    unsigned long maxArrivalMs;
+    unsigned long reachedMs;
+  };
+
+  // Strømsvigtet (-s): hvor i bryggen det skete, og hvad der blev genoptaget.
+  struct PowerLoss {
+    bool done;
+    unsigned long atMs;
+    BrewState state;
+    uint8_t step;
+    unsigned long remainingBefore;
+    BrewState resumedState;
+    uint8_t resumedStep;
+    unsigned long remainingAfter;
+  };
+
+  Transition transitions[MAX_TRANSITIONS];
+  uint8_t transitionCount = 0;
+  RestStats stepStats[MashSchedule::MAX_STEPS];
+  KettleModel hltModel(hltParams());
+  VesselStats hltStats = {0, -1000.0f, 1000.0f};
+  unsigned long gasOnMs = 0;
+  uint32_t buttonPresses = 0;
+  SafetyStats safetyStats = {};
+
+  void addSensor(SimOneWireBus *bus, const OneWireRom rom, float celsius) {
+    OneWireRom address;
+    memcpy(address, rom, sizeof(OneWireRom));
+    address[7] = OneWireBus::crc8(address, 7);
+    bus->addDevice(address, celsius);
+  }
+
+  const char *stateName(BrewState state) {
+    switch (state) {
+      case BrewState::IDLE:       return "IDLE";
+      case BrewState::MASHING:    return "MASHING";
+      case BrewState::BOILHEATUP: return "BOILHEATUP";
+      case BrewState::BOILING:    return "BOILING";
+      case BrewState::PAUSED:     return "PAUSED";
+      case BrewState::AUTOTUNE:   return "AUTOTUNE";
+    }
+    return "?";
+  }
+
+  // "MASHING 2" for mæskeplanens trin, ellers tilstandens navn.
+  String stateLabel(BrewState state, uint8_t step) {
+    String label = stateName(state);
+    if (state == BrewState::MASHING) {
+      label += " " + String(step + 1);
+    }
+    return label;
+  }
+
+  String formatDuration(unsigned long ms) {
+    unsigned long s = ms / 1000;
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%02lu:%02lu:%02lu", s / 3600, (s / 60) % 60, s % 60);
+    return String(buf);
+  }
+
+  // Samme flow som loop() i main.cpp, uden display og WiFi.
+  void controlStep() {
+    SafetySupervisor::heartbeat();
+    WebServerHandler::handleClient();
+    TemperatureHandler::update();
+    TemperatureSnapshot sample = TemperatureHandler::getSnapshot();
+    ProcessHandler::update(sample);
+
+    static uint8_t appliedResolution = 0;
+    static unsigned long appliedInterval = 0;
+    ProcessHandler::SamplingPolicy policy = ProcessHandler::getSamplingPolicy();
+    if (policy.resolutionBits != appliedResolution || policy.intervalMs != appliedInterval) {
+      appliedResolution = policy.resolutionBits;
+      appliedInterval = policy.intervalMs;
+      TemperatureHandler::setResolution(policy.resolutionBits);
+      TemperatureHandler::setSampleInterval(policy.intervalMs);
+    }
+
+    StatusLED::setProcessActive(ProcessHandler::isProcessActive());
+    StatusLED::update();
+  }
+
+  // Bryggeren trykker OPERATOR_REACTION_MS efter, at buzzeren begynder at
+  // kalde (også gennem mønstrets pauser) – eller når opvarmningen til kog er talt ned, hvor styringen venter
+  // på knappen uden at bruge buzzeren.
+  void operatorStep(unsigned long now) {
+    static unsigned long callingSince = 0;
+    static unsigned long releaseAt = 0;
+
+    if (releaseAt) {
+      if (now >= releaseAt) {
+        HalSim::setInput(PIN_BUTTON, true);
+        releaseAt = 0;
+      }
+      return;
+    }
+
+    // En låst sikkerhedsalarm nulstilles på websiden, ikke på knappen.
+    if (SafetySupervisor::isTripped()) {
+      if (!callingSince) {
+        callingSince = now;
+      } else if (now - callingSince >= OPERATOR_REACTION_MS) {
+        int code = WebServerHandler::getServer().request(HTTP_GET, "/safety?reset=1");
+        Serial.printf("[Sim] /safety?reset=1 -> %d\n", code);
+        if (code == 200 && !safetyStats.resetMs) {
+          safetyStats.resetMs = now;
+        }
+        callingSince = 0;
+      }
+      return;
+    }
+
+    if (!BuzzerHandler::isSounding()) {
+      callingSince = 0;
+      return;
+    }
+    if (!callingSince) {
+      callingSince = now;
+    } else if (now - callingSince >= OPERATOR_REACTION_MS) {
+      HalSim::setInput(PIN_BUTTON, false);
+      releaseAt = now + BUTTON_HOLD_MS;
+      callingSince = 0;
+      buttonPresses++;
+    }
+  }
+
+  void recordStats(const KettleModel &model, unsigned long dtMs) {
+    BrewState state = ProcessHandler::kettle().getCurrentState();
+    float kettle = model.getKettleTemp();
+    uint8_t step = ProcessHandler::kettle().getStepIndex();
+    RestStats *stats = state == BrewState::MASHING ? &stepStats[step] : nullptr;
+    if (stats) {
+      if (!stats->visited) {
+        *stats = {true, 0.0f, -1000.0f, 1000.0f, 0, ULONG_MAX, 0, 0};
+      }
+      stats->setpointC = tempRawToC(ProcessHandler::kettle().getSchedule().steps[step].target);
+      stats->maxC = max(stats->maxC, kettle);
+      unsigned long now = Hal::millis();
+      if (ProcessHandler::kettle().isTimerStarted()) {
+        stats->minHoldC = min(stats->minHoldC, kettle);
+        if (!stats->reachedMs) {
+          stats->reachedMs = now;
+        }
+      }
+      long eta = ProcessHandler::kettle().getSetpointEta();
+      if (eta >= 0) {
+        unsigned long arrival = now + eta * 1000UL;
+        if (!stats->firstEtaMs) {
+          stats->firstEtaMs = now;
+        }
+        stats->minArrivalMs = min(stats->minArrivalMs, arrival);
+        stats->maxArrivalMs = max(stats->maxArrivalMs, arrival);
+      }
+    }
+    if (HalSim::getOutput(PIN_GAS)) {
+      gasOnMs += dtMs;
+    }
+    static bool wasTripped = false;
+    bool tripped = SafetySupervisor::isTripped();
+    if (tripped && !wasTripped && safetyStats.trips++ == 0) {
+      safetyStats.firstTrip = SafetySupervisor::getTrip();
+      safetyStats.trippedMs = SafetySupervisor::getTrippedAt();
+    }
+    if (tripped && !safetyStats.gasOffMs && !HalSim::getOutput(PIN_GAS)) {
+      safetyStats.gasOffMs = Hal::millis();
+    }
+    wasTripped = tripped;
+  }
+
+  // Printf's feltbredde tæller bytes, så æ/ø ville skubbe kolonnerne.
+  void printLabel(const char *label) {
+    int width = 0;
+    for (const char *p = label; *p; p++) {
+      if ((*p & 0xC0) != 0x80) {
+        width++;
+      }
+    }
+    printf("%s%*s", label, LABEL_WIDTH - width, "");
+  }
+
+  void printRest(const char *label, const RestStats &stats) {
+    printLabel(label);
+    if (!stats.visited) {
+      printf("ikke nået\n");
+      return;
+    }
+    printf("setpoint %.1f °C, max %.2f °C (oversving %+.2f °C), min under hvil %.2f °C\n",
+           stats.setpointC, stats.maxC, stats.maxC - stats.setpointC, stats.minHoldC);
+    printLabel("  ETA:");
+    if (!stats.firstEtaMs || !stats.reachedMs || stats.firstEtaMs > stats.reachedMs) {
+      printf("ingen\n");
+      return;
+    }
+    long earliest = (static_cast<long>(stats.minArrivalMs) - static_cast<long>(stats.reachedMs)) / 1000;
+    long latest = (static_cast<long>(stats.maxArrivalMs) - static_cast<long>(stats.reachedMs)) / 1000;
+    printf("kendt %s før setpoint, forudsagt ankomst %+ld … %+ld s fra den faktiske\n",
+           formatDuration(stats.reachedMs - stats.firstEtaMs).c_str(), earliest, latest);
+  }
+
+  // Ét skridt af modellen over den tid, styringen faktisk har brugt –
+  // Hal::delay() i styringen flytter også uret.
+  void modelStep(KettleModel &model, SimOneWireBus *grydeBus, SimOneWireBus *ventilBus) {
+    static unsigned long lastModelMs = 0;
+    unsigned long now = Hal::millis();
+    unsigned long dtMs = now - lastModelMs;
+    lastModelMs = now;
+    model.step(dtMs / 1000.0f, HalSim::getOutput(PIN_GAS), HalSim::getOutput(PIN_PUMP));
+    grydeBus->setTemperature(0, model.getGrydeSensorTemp());
+    ventilBus->setTemperature(0, model.getVentilSensorTemp());
+    recordStats(model, dtMs);
+
+    hltModel.step(dtMs / 1000.0f, HalSim::getOutput(VESSEL_PINS[HLT_VESSEL].heatPin), false);
+    grydeBus->setTemperature(HLT_SENSOR_INDEX, hltModel.getGrydeSensorTemp());
+    const Vessel &hlt = ProcessHandler::getVessel(HLT_VESSEL);
+    float water = hltModel.getKettleTemp();
+    if (hlt.isActive()) {
+      hltStats.maxC = max(hltStats.maxC, water);
+      if (!hltStats.reachedMs && hlt.getStatus() == Vessel::Status::HOLDING) {
+        hltStats.reachedMs = now;
+      }
+      if (hltStats.reachedMs) {
+        hltStats.minAfterC = min(hltStats.minAfterC, water);
+      }
+    }
+  }
+
+  // Relæerne falder fra, gryden passer sig selv i POWER_LOSS_MS, og enheden
+  // starter forfra uden netværkstid (som i AP-tilstand). Kun lageret overlever.
+  void powerLoss(PowerLoss &loss, KettleModel &model, SimOneWireBus *grydeBus, SimOneWireBus *ventilBus) {
+    loss.done = true;
+    loss.state = ProcessHandler::kettle().getCurrentState();
+    loss.step = ProcessHandler::kettle().getStepIndex();
+    loss.remainingBefore = ProcessHandler::kettle().getRemainingTime();
+    Hal::digitalWrite(PIN_GAS, false);
+    Hal::digitalWrite(PIN_PUMP, false);
+    Hal::digitalWrite(VESSEL_PINS[HLT_VESSEL].heatPin, false);
+    Hal::buzzerTone(0);
+    for (unsigned long t = 0; t < POWER_LOSS_MS; t += LOOP_STEP_MS) {
+      HalSim::advance(LOOP_STEP_MS);
+      modelStep(model, grydeBus, ventilBus);
+    }
+    HalSim::setNetworkTime(0);
+    Serial.println("[Sim] Strømsvigt – genstarter");
+    SafetySupervisor::begin(PIN_GAS, PIN_PUMP);
+    ProcessHandler::begin(PIN_BUZZER, PIN_BUTTON);
+    loss.resumedState = ProcessHandler::kettle().getCurrentState();
+    loss.resumedStep = ProcessHandler::kettle().getStepIndex();
+    loss.remainingAfter = ProcessHandler::kettle().getRemainingTime();
+  }
+
+  // loop() står stille i LOOP_HANG_MS; kun gryden, timerne og vagten kører.
+  void loopHang(KettleModel &model, SimOneWireBus *grydeBus, SimOneWireBus *ventilBus) {
+    Serial.println("[Sim] loop() hænger");
+    for (unsigned long t = 0; t < LOOP_HANG_MS; t += LOOP_STEP_MS) {
+      HalSim::advance(LOOP_STEP_MS);
+      modelStep(model, grydeBus, ventilBus);
+    }
+  }
+
+  // Autotuning om mæske-setpointet. Returnerer false, hvis den ikke blev færdig.
+  bool runAutotune(KettleModel &model, SimOneWireBus *grydeBus, SimOneWireBus *ventilBus) {
+    WebServer &server = WebServerHandler::getServer();
+    server.request(HTTP_POST, WEB_SCRIPT[0].uri);
+    String uri = "/startAutotune?setpoint=" + String(ProcessHandler::kettle().getMashSetpoint(), 1);
+    int code = server.request(HTTP_GET, uri.c_str());
+    Serial.printf("[Sim] %s -> %d\n", uri.c_str(), code);
+
+    unsigned long start = Hal::millis();
+    controlStep();  // Kommandoen ligger i køen til næste update()
+    while (ProcessHandler::kettle().getCurrentState() == BrewState::AUTOTUNE && Hal::millis() - start < MAX_SIM_MS) {
+      controlStep();
+      modelStep(model, grydeBus, ventilBus);
+      HalSim::advance(LOOP_STEP_MS);
+    }
+
+    const RelayAutoTuner &tuner = ProcessHandler::kettle().getAutoTuner();
+    const RelayAutoTuner::Result &result = tuner.getResult();
+    printf("==== Autotuning ====\n");
+    printLabel("Varighed:");
+    printf("%s, %u svingninger\n", formatDuration(Hal::millis() - start).c_str(), tuner.getCycles());
+    if (tuner.getStatus() != RelayAutoTuner::Status::DONE) {
+      printLabel("Resultat:");
+      printf("mislykkedes (%s)\n", tuner.getFailReason());
+      return false;
+    }
+    printLabel("Svingning:");
+    printf("Tu %.0f s, amplitude %.2f °C -> Ku %.1f %%/°C\n", result.tuS, result.amplitude, result.ku);
+    printLabel("PID-gains:");
+    printf("Kp %.2f, Ki %.4f, Kd %.0f\n", ProcessHandler::kettle().getPidKp(), ProcessHandler::kettle().getPidKi(),
+           ProcessHandler::kettle().getPidKd());
+    return true;
+  }
+
+  // Filen sendes som upload til /recipe, som en browser ville gøre.
+  bool importRecipe(WebServer &server, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+      printf("Kan ikke åbne %s\n", path);
+      return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+      data.insert(data.end(), buf, buf + n);
+    }
+    fclose(file);
+    int code = server.requestUpload("/recipe", path, data.data(), data.size());
+    Serial.printf("[Sim] /recipe (%s) -> %d\n", path, code);
+    if (code != 200) {
+      printf("Opskriften blev afvist: %s\n", server.responseBody().c_str());
+      return false;
+    }
+    printLabel("Opskrift:");
+    printf("%s\n", server.responseBody().c_str());
+    return true;
+  }
+}
+
+int main(int argc, char **argv) {
+  bool verbose = false;
+  bool autotune = false;
+  const char *plan = nullptr;
+  const char *recipeFile = nullptr;
+  unsigned long powerLossMs = 0;
+  unsigned long hangMs = 0;
+  for (int i = 1; i < argc; i++) {
+    verbose = verbose || strcmp(argv[i], "-v") == 0;
+    autotune = autotune || strcmp(argv[i], "-a") == 0;
+    if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      plan = argv[++i];
+    }
+    if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      recipeFile = argv[++i];
+    }
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      powerLossMs = strtoul(argv[++i], nullptr, 10) * 60000UL;
+    }
+    if (strcmp(argv[i], "-h") == 0 && i + 1 < argc) {
+      hangMs = strtoul(argv[++i], nullptr, 10) * 60000UL;
+    }
+  }
+  Serial.setOutput(verbose ? stdout : nullptr);
+
+  KettleModel model;
+  HalSim::setNetworkTime(SIM_START_EPOCH);
+  HalSim::setInput(PIN_BUTTON, true);
+  SimOneWireBus *grydeBus = HalSim::sensorBus(PIN_TEMP_GRYDE);
+  SimOneWireBus *ventilBus = HalSim::sensorBus(PIN_TEMP_VENTIL);
+  addSensor(grydeBus, GRYDE_ROM, model.getGrydeSensorTemp());
+  addSensor(ventilBus, VENTIL_ROM, model.getVentilSensorTemp());
+  addSensor(grydeBus, HLT_ROM, hltModel.getGrydeSensorTemp());
+
+  EEPROMHandler::begin();
+  Clock::begin(EEPROMHandler::getConfig().timezone);
+  StatusLED::begin(PIN_RGB_LED);
+  SafetySupervisor::begin(PIN_GAS, PIN_PUMP);
+  WebServerHandler::begin();
+  TemperatureHandler::begin(PIN_TEMP_GRYDE, PIN_TEMP_VENTIL);
+  TemperatureHandler::startTask();
+  ProcessHandler::begin(PIN_BUZZER, PIN_BUTTON);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  if (autotune) {
+    if (!runAutotune(model, grydeBus, ventilBus)) {
+      return 1;
+    }
+    // Næste bryg starter med koldt vand, og statistikken gælder kun bryggen.
+    model.reset(model.getParams().ambientC);
+    gasOnMs = 0;
+    printf("\n");
+  }
+
+  WebServer &server = WebServerHandler::getServer();
+  size_t nextCommand = 0;
+  BrewState lastState = ProcessHandler::kettle().getCurrentState();
+  uint8_t lastStep = ProcessHandler::kettle().getStepIndex();
+  bool boiled = false;
+  unsigned long scriptStart = Hal::millis();
+  uint32_t gasSwitchesBefore = HalSim::getWriteCount(PIN_GAS);
+  uint32_t pumpSwitchesBefore = HalSim::getWriteCount(PIN_PUMP);
+  uint32_t hltSwitchesBefore = HalSim::getWriteCount(VESSEL_PINS[HLT_VESSEL].heatPin);
+  uint32_t commitsBefore = HalSim::getCommitCount();
+  uint32_t buzzerWritesBefore = HalSim::getBuzzerWrites();
+  PowerLoss loss = {};
+  bool hung = false;
+
+  while (Hal::millis() - scriptStart < MAX_SIM_MS) {
+    unsigned long now = Hal::millis();
+    while (nextCommand < sizeof(WEB_SCRIPT) / sizeof(WEB_SCRIPT[0]) &&
+           scriptStart + WEB_SCRIPT[nextCommand].atMs <= now) {
+      const WebCommand &cmd = WEB_SCRIPT[nextCommand++];
+      int code = server.request(cmd.method, cmd.uri);
+      Serial.printf("[Sim] %s -> %d\n", cmd.uri, code);
+      // Planen gemmes efter indstillingerne, der ellers retter dens første og sidste trin.
+      if (nextCommand == 1 && plan) {
+        String uri = String("/saveSchedule?steps=") + plan;
+        code = server.request(HTTP_POST, uri.c_str());
+        Serial.printf("[Sim] %s -> %d\n", uri.c_str(), code);
+        if (code != 200) {
+          printf("Ugyldig mæskeplan: %s\n", plan);
+          return 1;
+        }
+      }
+      if (nextCommand == 1 && recipeFile && !importRecipe(server, recipeFile)) {
+        return 1;
+      }
+    }
+    if (powerLossMs && !loss.done && now - scriptStart >= powerLossMs) {
+      loss.atMs = now - scriptStart;
+      powerLoss(loss, model, grydeBus, ventilBus);
+      now = Hal::millis();
+    }
+    if (hangMs && !hung && now - scriptStart >= hangMs) {
+      hung = true;
+      loopHang(model, grydeBus, ventilBus);
+      now = Hal::millis();
+    }
+    operatorStep(now);
+
+    controlStep();
+
+    modelStep(model, grydeBus, ventilBus);
+
+    now = Hal::millis();
+    BrewState state = ProcessHandler::kettle().getCurrentState();
+    uint8_t step = ProcessHandler::kettle().getStepIndex();
+    if (state != lastState || (state == BrewState::MASHING && step != lastStep)) {
+      if (transitionCount < MAX_TRANSITIONS) {
+        transitions[transitionCount++] = {now - scriptStart, lastState, state, lastStep, step, model.getKettleTemp()};
+      }
+      boiled = boiled || lastState == BrewState::BOILING;
+      lastState = state;
+      lastStep = step;
+    }
+    if (boiled && state == BrewState::IDLE) {
+      break;
+    }
+    HalSim::advance(LOOP_STEP_MS);
+  }
+  std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+  unsigned long totalMs = Hal::millis() - scriptStart;
+
+  printf("==== Brygsimulering ====\n");
+  printf("Tilstandsforløb:\n");
+  for (uint8_t i = 0; i < transitionCount; i++) {
+    const Transition &t = transitions[i];
+    printf("  %s  %-10s -> %-10s %6.2f °C\n", formatDuration(t.atMs).c_str(),
+           stateLabel(t.from, t.fromStep).c_str(), stateLabel(t.to, t.toStep).c_str(), t.kettleC);
+  }
+  for (uint8_t i = 0; i < ProcessHandler::kettle().getSchedule().count; i++) {
+    printRest(("Trin " + String(i + 1) + ":").c_str(), stepStats[i]);
+  }
+  printLabel("Gasrelæ:");
+  printf("%u skift, tændt %s (%.1f %%)\n", HalSim::getWriteCount(PIN_GAS) - gasSwitchesBefore, formatDuration(gasOnMs).c_str(),
+         100.0 * gasOnMs / totalMs);
+  printLabel("  Skifteplan:");
+  printf("%u skift måtte vente på minimumstid/skifterate\n", ProcessHandler::kettle().getGasRelayStats().deferred);
+  printLabel("Pumperelæ:");
+  printf("%u skift\n", HalSim::getWriteCount(PIN_PUMP) - pumpSwitchesBefore);
+  printLabel("HLT:");
+  if (hltStats.reachedMs) {
+    printf("%.1f °C nået efter %s, max %.2f °C, derefter min %.2f °C, %u skift\n",
+           tempRawToC(ProcessHandler::getVessel(HLT_VESSEL).getTarget()),
+           formatDuration(hltStats.reachedMs - scriptStart).c_str(), hltStats.maxC, hltStats.minAfterC,
+           HalSim::getWriteCount(VESSEL_PINS[HLT_VESSEL].heatPin) - hltSwitchesBefore);
+  } else {
+    printf("målet ikke nået\n");
+  }
+  printLabel("Knap:");
+  printf("%u tryk\n", buttonPresses);
+  printLabel("Buzzer:");
+  printf("%u toneskift\n", HalSim::getBuzzerWrites() - buzzerWritesBefore);
+  printLabel("Flash:");
+  printf("%u skrivninger\n", HalSim::getCommitCount() - commitsBefore);
+  if (loss.done) {
+    printLabel("Strømsvigt:");
+    printf("%s i %s (%s tilbage) -> %s (%s tilbage)\n", formatDuration(loss.atMs).c_str(),
+           stateLabel(loss.state, loss.step).c_str(), formatDuration(loss.remainingBefore * 1000).c_str(),
+           stateLabel(loss.resumedState, loss.resumedStep).c_str(),
+           formatDuration(loss.remainingAfter * 1000).c_str());
+  }
+  printLabel("Sikkerhed:");
+  if (safetyStats.trips == 0) {
+    printf("ingen udløsninger\n");
+  } else {
+    printf("%u udløsning(er), første %s efter %s, gas slukket efter %lu ms, nulstillet efter %s\n",
+           safetyStats.trips, SafetySupervisor::tripName(safetyStats.firstTrip),
+           formatDuration(safetyStats.trippedMs - scriptStart).c_str(), safetyStats.gasOffMs - safetyStats.trippedMs,
+           safetyStats.resetMs ? formatDuration(safetyStats.resetMs - safetyStats.trippedMs).c_str() : "–");
+  }
+  printLabel("Samlet tid:");
+  printf("%s simuleret på %.3f s (%.0f x realtid)%s\n", formatDuration(totalMs).c_str(), wall.count(),
+         Hal::millis() / 1000.0 / wall.count(), boiled ? "" : " – IKKE FÆRDIG");
+  return boiled ? 0 : 1;
+}
+#endif // PIO_UNIT_TESTING
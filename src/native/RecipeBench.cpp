@@ -0,0 +1,399 @@
+// Indgang til env:native_bench: benchmark af RecipeParser på værten.
+//
+//   pio run -e native_bench && .pio/build/native_bench/program [BeerXML/BeerJSON-filer …]
+//
+// Uden filer parses eksporterne i test/fixtures/recipes (BeerSmith, Brewfather
+// og BeerJSON-eksemplet; stien er relativ til projektmappen), og resultatet
+// kontrolleres mod FIXTURES. Derefter genereres store BeerXML- og
+// BeerJSON-eksporter løbende, hvor første opskrift er kendt. Alt streames i
+// bidder af HTTP_UPLOAD_BUFLEN som ved en upload til /recipe. Exit-koden er 0,
+// når alle dokumenter blev parset (og genkendt).
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include "RecipeParser.h"
+
+// Alle heap-allokeringer tælles, så benchmarken kan vise, at parseren ikke
+// bruger heap – hukommelsen er sizeof(RecipeParser) plus uploadbufferen. Den
+// globale erstatning er grunden til, at benchmarken er sit eget program og
+// ikke en del af simulatoren i env:native.
+namespace {
+  size_t allocations = 0;
+}
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+namespace {
+  constexpr uint32_t SYNTHETIC_RECIPES = 4000;
+  constexpr size_t NOTES_SIZE = 2500;
+  // Små filer parses igen og igen, til målingen er til at stole på.
+  constexpr double MIN_FILE_SECONDS = 0.2;
+  constexpr const char *FIXTURE_DIR = "test/fixtures/recipes/";
+
+  // Det, parseren skal finde i de rigtige eksporter.
+  struct Fixture {
+    const char *file;
+    const char *name;
+    const char *mash;  // MashSchedule::toString()
+    uint16_t boilMinutes;
+    uint8_t additions;
+    uint8_t skippedSteps;
+  };
+
+  const Fixture FIXTURES[] = {
+    // BeerSmith 2: alle DISPLAY_-felter, MISC med USE Boil, flameout som Aroma 0 min
+    {"beersmith_pale_ale.xml", "Sierra Nevada Pale Ale Clone", "66.7,60,PGS;75.6,10,PGE", 60, 4, 0},
+    // Brewfather: UTF-8, First Wort, Mash-humle, dekoktion og et 95 °C-spargetrin
+    {"brewfather_hefeweizen.xml", "Hefeweizen Dekoktion", "45.0,15,PGS;63.0,35,PG;72.0,30,PGS;78.0,10,PGE", 90, 2,
+     1},
+    // BeerJSON 1.0: °F, oz og tørhumle med duration
+    {"beerjson_american_stout.json", "American Stout", "66.7,60,PGS;75.6,10,PGE", 60, 2, 0},
+    // Brewfather BeerJSON på én linje: kogning i timer, whirlpool ved 0 min
+    {"brewfather_neipa.json", "NEIPA – Juicy Bits", "67.0,60,PGS;76.0,10,PGE", 60, 3, 0},
+  };
+
+  // Samler tekst i en buffer på HTTP_UPLOAD_BUFLEN og fodrer parseren, når den
+  // er fuld – som WebServer gør med en multipart-upload.
+  class ChunkFeeder {
+  public:
+    explicit ChunkFeeder(RecipeParser &parser) : parser(parser) {}
+
+    void write(const char *text, size_t len) {
+      while (len > 0) {
+        size_t n = min(len, static_cast<size_t>(HTTP_UPLOAD_BUFLEN) - fill);
+        memcpy(buf + fill, text, n);
+        fill += n;
+        text += n;
+        len -= n;
+        if (fill == HTTP_UPLOAD_BUFLEN) {
+          flush();
+        }
+      }
+    }
+    void write(const std::string &text) { write(text.data(), text.size()); }
+
+    void flush() {
+      if (fill > 0) {
+        size_t before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        parser.feed(buf, fill);
+        parseSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        parseAllocations += allocations - before;
+        fill = 0;
+      }
+    }
+
+    // Kun tid og allokeringer i parseren; generatoren bygger selv tekst med std::string.
+    size_t parseAllocations = 0;
+    double parseSeconds = 0.0;
+
+  private:
+    RecipeParser &parser;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+    size_t fill = 0;
+  };
+
+  // Lang fritekst som i rigtige eksporter (noter, smagsbeskrivelser).
+  std::string notes(uint32_t seed) {
+    static const char *words[] = {"maltet", "humlet", "frugtig", "tør", "rund", "karamel", "citrus", "fyrrenål",
+                                  "brødskorpe", "kold", "gæring", "<ikke>", "&", "\"citat\""};
+    std::string text;
+    while (text.size() < NOTES_SIZE) {
+      seed = seed * 1103515245u + 12345u;
+      text += words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+      text += ' ';
+    }
+    return text;
+  }
+
+  std::string xmlEscape(const std::string &text) {
+    std::string result;
+    for (char c : text) {
+      if (c == '<') result += "&lt;";
+      else if (c == '&') result += "&amp;";
+      else if (c == '"') result += "&quot;";
+      else result += c;
+    }
+    return result;
+  }
+
+  std::string jsonEscape(const std::string &text) {
+    std::string result;
+    for (char c : text) {
+      if (c == '"' || c == '\\') result += '\\';
+      result += c;
+    }
+    return result;
+  }
+
+  struct SynthStep {
+    const char *name;
+    const char *type;
+    float tempC;
+    uint16_t minutes;
+  };
+
+  struct SynthHop {
+    const char *name;
+    const char *xmlUse;
+    const char *jsonUse;
+    uint16_t minutes;
+    uint16_t grams;
+  };
+
+  // Første opskrift: det, parseren skal finde.
+  const SynthStep STEPS[] = {
+    {"Proteinrast", "Temperature", 52.0f, 15},
+    {"Betarast", "Infusion", 64.0f, 45},
+    {"Alfarast", "Temperature", 72.0f, 20},
+    {"Udmæskning", "Temperature", 78.0f, 10},
+  };
+  const SynthHop HOPS[] = {
+    {"Magnum", "Boil", "add_to_boil", 60, 25},
+    {"Cascade", "Boil", "add_to_boil", 10, 30},
+    {"Citra", "Aroma", "add_to_boil", 0, 50},
+    {"Citra", "Dry Hop", "add_to_fermentation", 4320, 100},
+  };
+  constexpr uint8_t EXPECTED_ADDITIONS = 3;  // Tørhumlen er ikke en kogetilsætning
+  constexpr uint16_t BOIL_MINUTES = 60;
+
+  std::string recipeName(uint32_t index) {
+    return index == 0 ? "Bench & \"IPA\"" : "Opskrift " + std::to_string(index);
+  }
+
+  void generateXml(ChunkFeeder &out) {
+    out.write("\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!-- Eksport fra brygprogram -->\n<RECIPES>\n");
+    for (uint32_t r = 0; r < SYNTHETIC_RECIPES; r++) {
+      std::string x = "<RECIPE>\n <NAME>" + xmlEscape(recipeName(r)) + "</NAME>\n <VERSION>1</VERSION>\n"
+                      " <TYPE>All Grain</TYPE>\n <BATCH_SIZE>25.0</BATCH_SIZE>\n <BOIL_SIZE>30.0</BOIL_SIZE>\n"
+                      " <BOIL_TIME>" + std::to_string(BOIL_MINUTES) + ".0</BOIL_TIME>\n"
+                      " <EQUIPMENT><NAME>Gryde 50 L</NAME><BOIL_TIME>90</BOIL_TIME></EQUIPMENT>\n <HOPS>\n";
+      for (const SynthHop &hop : HOPS) {
+        x += "  <HOP><NAME>" + std::string(hop.name) + "</NAME><VERSION>1</VERSION><ALPHA>12.0</ALPHA>"
+             "<AMOUNT>" + std::to_string(hop.grams / 1000.0) + "</AMOUNT><USE>" + hop.xmlUse + "</USE>"
+             "<TIME>" + std::to_string(hop.minutes) + "</TIME><NOTES><![CDATA[Aroma ]] <b>" + hop.name +
+             "</b>]]></NOTES></HOP>\n";
+      }
+      x += " </HOPS>\n <FERMENTABLES>\n";
+      for (int f = 0; f < 6; f++) {
+        x += "  <FERMENTABLE><NAME>Malt " + std::to_string(f) + "</NAME><TYPE>Grain</TYPE><AMOUNT>1.5</AMOUNT>"
+             "<YIELD>80</YIELD><COLOR>4</COLOR></FERMENTABLE>\n";
+      }
+      x += " </FERMENTABLES>\n <MASH>\n  <NAME>Trinmæskning</NAME>\n  <GRAIN_TEMP>18</GRAIN_TEMP>\n  <MASH_STEPS>\n";
+      for (const SynthStep &step : STEPS) {
+        x += "   <MASH_STEP>\n    <NAME>" + xmlEscape(step.name) + "</NAME>\n    <TYPE>" + step.type + "</TYPE>\n"
+             "    <STEP_TEMP>" + std::to_string(step.tempC) + "</STEP_TEMP>\n"
+             "    <STEP_TIME>" + std::to_string(step.minutes) + "</STEP_TIME>\n    <RAMP_TIME>2</RAMP_TIME>\n"
+             "   </MASH_STEP>\n";
+      }
+      x += "  </MASH_STEPS>\n </MASH>\n <NOTES>" + xmlEscape(notes(r)) + "</NOTES>\n</RECIPE>\n";
+      out.write(x);
+    }
+    out.write("</RECIPES>\n");
+  }
+
+  void generateJson(ChunkFeeder &out) {
+    out.write("{\n  \"beerjson\": {\n    \"version\": 1.0,\n    \"recipes\": [\n");
+    for (uint32_t r = 0; r < SYNTHETIC_RECIPES; r++) {
+      std::string j = r > 0 ? ",\n" : "";
+      // Alfarasten i °F og kogningen i timer for at prøve enhederne.
+      j += "      {\n        \"name\": \"" + jsonEscape(recipeName(r)) + "\",\n        \"type\": \"all grain\",\n"
+           "        \"batch_size\": {\"unit\": \"l\", \"value\": 25},\n"
+           "        \"efficiency\": {\"brewhouse\": {\"unit\": \"%\", \"value\": 72}},\n"
+           "        \"ingredients\": {\n          \"fermentable_additions\": [";
+      for (int f = 0; f < 6; f++) {
+        j += std::string(f ? ", " : "") + "{\"name\": \"Malt " + std::to_string(f) +
+             "\", \"type\": \"grain\", \"amount\": {\"unit\": \"kg\", \"value\": 1.5}, \"yield\": "
+             "{\"fine_grind\": {\"unit\": \"%\", \"value\": 80}}}";
+      }
+      j += "],\n          \"hop_additions\": [";
+      bool first = true;
+      for (const SynthHop &hop : HOPS) {
+        j += std::string(first ? "" : ", ") + "{\"name\": \"" + hop.name + "\", \"alpha_acid\": {\"unit\": \"%\", "
+             "\"value\": 12}, \"amount\": {\"unit\": \"kg\", \"value\": " + std::to_string(hop.grams / 1000.0) +
+             "}, \"timing\": {\"use\": \"" + hop.jsonUse + "\", \"time\": {\"unit\": \"min\", \"value\": " +
+             std::to_string(hop.minutes) + "}}}";
+        first = false;
+      }
+      j += "]\n        },\n        \"mash\": {\n          \"name\": \"Trinm\\u00e6skning\",\n"
+           "          \"grain_temperature\": {\"unit\": \"C\", \"value\": 18},\n          \"mash_steps\": [";
+      first = true;
+      for (const SynthStep &step : STEPS) {
+        bool fahrenheit = step.tempC == 72.0f;
+        j += std::string(first ? "" : ", ") + "{\"name\": \"" + step.name + "\", \"type\": \"" +
+             (strcmp(step.type, "Infusion") == 0 ? "infusion" : "temperature") + "\", \"step_temperature\": "
+             "{\"unit\": \"" + (fahrenheit ? "F" : "C") + "\", \"value\": " +
+             std::to_string(fahrenheit ? step.tempC * 1.8f + 32.0f : step.tempC) + "}, \"step_time\": "
+             "{\"unit\": \"min\", \"value\": " + std::to_string(step.minutes) + "}, \"ramp_time\": "
+             "{\"unit\": \"min\", \"value\": 2}}";
+        first = false;
+      }
+      j += "]\n        },\n        \"boil\": {\"pre_boil_size\": {\"unit\": \"l\", \"value\": 30}, \"boil_time\": "
+           "{\"unit\": \"hr\", \"value\": 1}},\n        \"notes\": \"" + jsonEscape(notes(r)) + "\",\n"
+           "        \"flags\": [true, false, null, -1.5e3]\n      }";
+      out.write(j);
+    }
+    out.write("\n    ]\n  }\n}\n");
+  }
+
+  // Kontrol af første syntetiske opskrift.
+  bool matchesSynthetic(const Recipe &recipe) {
+    if (strcmp(recipe.name, recipeName(0).c_str()) != 0 || recipe.boilMinutes != BOIL_MINUTES ||
+        recipe.mash.count != sizeof(STEPS) / sizeof(STEPS[0]) || recipe.additions.count != EXPECTED_ADDITIONS ||
+        recipe.skippedSteps != 0 || recipe.skippedAdditions != 0) {
+      return false;
+    }
+    for (uint8_t i = 0; i < recipe.mash.count; i++) {
+      const MashStep &step = recipe.mash.steps[i];
+      bool confirmStart = i == 0 || strcmp(STEPS[i].type, "Infusion") == 0;
+      if (step.target != tempRawFromC(STEPS[i].tempC) || step.minutes != STEPS[i].minutes ||
+          step.confirmStart != confirmStart || step.confirmEnd != (i == recipe.mash.count - 1)) {
+        return false;
+      }
+    }
+    for (uint8_t i = 0; i < recipe.additions.count; i++) {
+      const BoilAddition &addition = recipe.additions.items[i];
+      if (strcmp(addition.name, HOPS[i].name) != 0 || addition.minutes != HOPS[i].minutes ||
+          addition.grams != HOPS[i].grams) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const char *formatName(RecipeParser::Format format) {
+    switch (format) {
+      case RecipeParser::Format::BEERXML:  return "BeerXML";
+      case RecipeParser::Format::BEERJSON: return "BeerJSON";
+      default:                             return "?";
+    }
+  }
+
+  // Én linje pr. dokument; tid og MB/s er pr. gennemløb, heap i alt.
+  void report(const char *label, const RecipeParser &parser, bool ok, double seconds, size_t parseAllocations,
+              uint32_t runs = 1) {
+    const Recipe &recipe = parser.getRecipe();
+    double mb = parser.getBytes() / 1.0e6;
+    seconds /= runs;
+    printf("%-28s %-8s %8.3f MB %9.6f s %7.1f MB/s  heap %zu  ", label, formatName(parser.getFormat()), mb, seconds,
+           seconds > 0 ? mb / seconds : 0.0, parseAllocations);
+    if (!ok) {
+      printf("FEJL: %s\n", parser.getError() ? parser.getError() : "?");
+      return;
+    }
+    printf("'%s': %s, kogning %u min, %u tilsætninger", recipe.name, recipe.mash.toString().c_str(),
+           recipe.boilMinutes, recipe.additions.count);
+    if (recipe.skippedSteps || recipe.skippedAdditions) {
+      printf(" (%u trin og %u tilsætninger sprunget over)", recipe.skippedSteps, recipe.skippedAdditions);
+    }
+    printf("\n");
+  }
+
+  // Parseren står i statisk hukommelse som på ESP32 (WebServerHandler).
+  RecipeParser parser;
+
+  // Filen læses ind én gang, så kun parseren måles.
+  bool readFile(const char *path, std::string &text) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+      return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+      text.append(buf, n);
+    }
+    fclose(file);
+    return true;
+  }
+
+  bool matchesFixture(const Recipe &recipe, const Fixture &fixture) {
+    return strcmp(recipe.name, fixture.name) == 0 && recipe.mash.toString() == fixture.mash &&
+           recipe.boilMinutes == fixture.boilMinutes && recipe.additions.count == fixture.additions &&
+           recipe.skippedSteps == fixture.skippedSteps && recipe.skippedAdditions == 0;
+  }
+
+  bool runFile(const char *path, const Fixture *fixture) {
+    const char *slash = strrchr(path, '/');
+    const char *label = slash ? slash + 1 : path;
+    std::string text;
+    if (!readFile(path, text)) {
+      printf("%-28s kan ikke åbnes\n", label);
+      return false;
+    }
+    bool ok = true;
+    uint32_t runs = 0;
+    double seconds = 0.0;
+    size_t parseAllocations = 0;
+    do {
+      parser.begin();
+      ChunkFeeder feeder(parser);
+      feeder.write(text);
+      feeder.flush();
+      size_t before = allocations;
+      auto start = std::chrono::steady_clock::now();
+      ok = parser.finish();
+      feeder.parseSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      feeder.parseAllocations += allocations - before;
+      seconds += feeder.parseSeconds;
+      parseAllocations += feeder.parseAllocations;
+      runs++;
+    } while (ok && seconds < MIN_FILE_SECONDS);
+    if (ok && fixture && !matchesFixture(parser.getRecipe(), *fixture)) {
+      printf("%-28s genkendes ikke: forventede '%s': %s, kogning %u min, %u tilsætninger\n", label, fixture->name,
+             fixture->mash, fixture->boilMinutes, fixture->additions);
+      ok = false;
+    }
+    report(label, parser, ok, seconds, parseAllocations, runs);
+    return ok;
+  }
+
+  bool runSynthetic(const char *label, void (*generate)(ChunkFeeder &)) {
+    parser.begin();
+    ChunkFeeder feeder(parser);
+    generate(feeder);
+    feeder.flush();
+    size_t before = allocations;
+    bool ok = parser.finish();
+    feeder.parseAllocations += allocations - before;
+    ok = ok && matchesSynthetic(parser.getRecipe());
+    report(label, parser, ok, feeder.parseSeconds, feeder.parseAllocations);
+    return ok;
+  }
+}
+
+int main(int argc, char **argv) {
+  printf("==== Opskriftsparser ====\n");
+  printf("Parsertilstand %zu bytes + uploadbuffer %d bytes, uafhængigt af dokumentets størrelse\n",
+         sizeof(RecipeParser), HTTP_UPLOAD_BUFLEN);
+  bool ok = true;
+  if (argc < 2) {
+    for (const Fixture &fixture : FIXTURES) {
+      ok = runFile((std::string(FIXTURE_DIR) + fixture.file).c_str(), &fixture) && ok;
+    }
+    ok = runSynthetic("syntetisk.xml", generateXml) && ok;
+    ok = runSynthetic("syntetisk.json", generateJson) && ok;
+  }
+  for (int i = 1; i < argc; i++) {
+    ok = runFile(argv[i], nullptr) && ok;
+  }
+  return ok ? 0 : 1;
+}
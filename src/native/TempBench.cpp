@@ -0,0 +1,135 @@
+// Indgang til env:native_tempbench: benchmark af temperaturkonverteringen på værten.
+//
+//   pio run -e native_tempbench && .pio/build/native_tempbench/program
+//
+// Sammenligner de to veje fra en læst DS18B20-scratchpad til en kontrolleret
+// temperatur over de samme faste scratchpads:
+//
+//   float – som DallasTemperature::getTempC(): CRC8 bit for bit, 1/128 °C
+//           ganget op til float og isValidTemperature() med float-grænser.
+//   rå    – som TemperatureHandler: CRC8 med opslagstabel
+//           (OneWireBus::crc8), tempRawFromScratchpad() og heltalsgrænser.
+//
+// Busoverførslen er ens for begge veje og er ikke med. Exit-koden er 0, når
+// vejene er enige om hver scratchpad.
+
+#include <Arduino.h>
+#include <chrono>
+#include "OneWireBus.h"
+#include "Temperature.h"
+
+namespace {
+  constexpr uint8_t SCRATCHPAD_SIZE = 9;
+  constexpr uint32_t CONVERSIONS = 20000000;
+
+  // Som TemperatureHandler: alt uden for ]-50; 150[ °C er en fejl.
+  constexpr TempRaw TEMP_RAW_MIN = tempRawFromC(-50.0f);
+  constexpr TempRaw TEMP_RAW_MAX = tempRawFromC(150.0f);
+  constexpr float DEVICE_DISCONNECTED_C = -127.0f;
+
+  struct Sample {
+    const char *label;
+    uint8_t sp[SCRATCHPAD_SIZE];
+  };
+
+  // Faste scratchpads (TH/TL 0x4B/0x46) med korrekt CRC – på nær den sidste.
+  const Sample SAMPLES[] = {
+    {"20,0625 °C 12 bit", {0x41, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0xAA}},
+    {"65,5 °C 12 bit", {0x18, 0x04, 0x4B, 0x46, 0x7F, 0xFF, 0x08, 0x10, 0x79}},
+    {"100,0 °C 12 bit", {0x40, 0x06, 0x4B, 0x46, 0x7F, 0xFF, 0x10, 0x10, 0xAE}},
+    {"-10,125 °C 12 bit", {0x5E, 0xFF, 0x4B, 0x46, 0x7F, 0xFF, 0x02, 0x10, 0xB6}},
+    {"78,0 °C 11 bit", {0xE0, 0x04, 0x4B, 0x46, 0x5F, 0xFF, 0x10, 0x10, 0x9E}},
+    {"52,5 °C 9 bit", {0x48, 0x03, 0x4B, 0x46, 0x1F, 0xFF, 0x08, 0x10, 0x47}},
+    {"85,0 °C 12 bit", {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x10, 0x10, 0xBD}},
+    {"-0,5 °C 10 bit", {0xF8, 0xFF, 0x4B, 0x46, 0x3F, 0xFF, 0x08, 0x10, 0x18}},
+    {"CRC-fejl", {0x18, 0x04, 0x4B, 0x46, 0x7F, 0xFF, 0x08, 0x10, 0x7A}},
+  };
+  constexpr uint8_t SAMPLE_COUNT = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+
+  // Dallas/Maxim CRC8 uden tabel, som OneWire::crc8() med ONEWIRE_CRC8_TABLE 0.
+  uint8_t crc8Bitwise(const uint8_t *data, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+      uint8_t inbyte = *data++;
+      for (uint8_t i = 8; i; i--) {
+        uint8_t mix = (crc ^ inbyte) & 0x01;
+        crc >>= 1;
+        if (mix) {
+          crc ^= 0x8C;
+        }
+        inbyte >>= 1;
+      }
+    }
+    return crc;
+  }
+
+  // getTempC(): DEVICE_DISCONNECTED_C ved CRC-fejl, ellers fortegnsudvidet 1/128 °C
+  // gange 0,0078125.
+  float floatPath(const uint8_t *sp) {
+    if (crc8Bitwise(sp, SCRATCHPAD_SIZE - 1) != sp[SCRATCHPAD_SIZE - 1]) {
+      return DEVICE_DISCONNECTED_C;
+    }
+    int32_t neg = (sp[1] & 0x80) ? static_cast<int32_t>(0xFFF80000) : 0;
+    int32_t fixed = (static_cast<int16_t>(sp[1]) << 11) | (static_cast<int16_t>(sp[0]) << 3) | neg;
+    float temp = static_cast<float>(fixed) * 0.0078125f;
+    return temp != DEVICE_DISCONNECTED_C && temp > -50.0f && temp < 150.0f ? temp : NAN;
+  }
+
+  TempRaw rawPath(const uint8_t *sp) {
+    if (OneWireBus::crc8(sp, SCRATCHPAD_SIZE) != 0) {
+      return TEMP_RAW_INVALID;
+    }
+    TempRaw raw = tempRawFromScratchpad(sp);
+    return raw > TEMP_RAW_MIN && raw < TEMP_RAW_MAX ? raw : TEMP_RAW_INVALID;
+  }
+
+  bool isFloatValid(float temp) {
+    return temp == temp && temp != DEVICE_DISCONNECTED_C;
+  }
+
+  // Vejene skal give samme temperatur og afvise de samme scratchpads.
+  bool checkSamples() {
+    bool ok = true;
+    for (const Sample &sample : SAMPLES) {
+      float celsius = floatPath(sample.sp);
+      TempRaw raw = rawPath(sample.sp);
+      bool agree = isFloatValid(celsius) ? raw != TEMP_RAW_INVALID && tempRawToC(raw) == celsius
+                                         : raw == TEMP_RAW_INVALID;
+      char text[12];
+      formatTempRaw(raw, text, sizeof(text));
+      printf("%-20s float %9.4f  rå %6d (%s)%s\n", sample.label, celsius, raw, text, agree ? "" : "  FEJL: uenige");
+      ok = ok && agree;
+    }
+    return ok;
+  }
+
+  // Summen bruges bagefter, så compileren ikke kan fjerne konverteringerne.
+  template <typename Convert>
+  double timePath(const char *label, Convert convert) {
+    double sum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CONVERSIONS; i++) {
+      sum += convert(SAMPLES[i % SAMPLE_COUNT].sp);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double ns = seconds * 1.0e9 / CONVERSIONS;
+    printf("%-6s %8.2f ns pr. konvertering  (%u konverteringer, kontrolsum %.1f)\n", label, ns, CONVERSIONS, sum);
+    return ns;
+  }
+}
+
+int main(int, char **) {
+  printf("==== Temperaturkonvertering ====\n");
+  bool ok = checkSamples();
+  // NaN fra en afvist måling tælles som 0 i kontrolsummen.
+  double floatNs = timePath("float", [](const uint8_t *sp) {
+    float temp = floatPath(sp);
+    return isFloatValid(temp) ? static_cast<double>(temp) : 0.0;
+  });
+  double rawNs = timePath("rå", [](const uint8_t *sp) {
+    TempRaw raw = rawPath(sp);
+    return raw != TEMP_RAW_INVALID ? static_cast<double>(raw) / TEMP_RAW_PER_DEGREE : 0.0;
+  });
+  printf("Rå vej %.1fx hurtigere\n", rawNs > 0 ? floatNs / rawNs : 0.0);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,430 @@
+// Tilstandsmaskinens transitioner (transitionstabellen i Vessel.cpp), kørt
+// gennem ProcessHandler på simuleret hardware ligesom i loop():
+//
+//   pio test -e native -f test_process
+//
+// Temperaturerne sættes direkte på de simulerede DS18B20'ere og går gennem
+// TemperatureHandler, så karrene ser dem præcis som på enheden. Uret er
+// virtuelt (HalSim), så en mæskeplan på minutter tager millisekunder.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "ButtonHandler.h"
+#include "BuzzerHandler.h"
+#include "EEPROMHandler.h"
+#include "Hal.h"
+#include "HalSim.h"
+#include "MashSchedule.h"
+#include "PinConfig.h"
+#include "ProcessHandler.h"
+#include "SafetySupervisor.h"
+#include "TemperatureHandler.h"
+
+namespace {
+  using BrewState = Vessel::BrewState;
+
+  constexpr unsigned long LOOP_STEP_MS = 20;
+  // Tid til, at medianvinduet og Kalman-filteret har fulgt et spring i temperaturen.
+  constexpr unsigned long SETTLE_MS = 30000;
+  constexpr unsigned long STEP_MS = 60000;  // Et trin på 1 min
+  // I IDLE måles der kun hvert 10. s, og reguleringen starter ved næste måling.
+  constexpr unsigned long IDLE_SAMPLE_MS = 10000;
+  constexpr float AMBIENT_C = 20.0f;
+
+  // Samme sensorer som i simulatoren: gryden og HLT'en ("Gryde 2") på
+  // grydebussen, ventilen på sin egen.
+  const OneWireRom GRYDE_ROM = {0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  const OneWireRom VENTIL_ROM = {0x28, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  const OneWireRom HLT_ROM = {0x28, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  constexpr uint8_t GRYDE_SENSOR = 0;
+  constexpr uint8_t HLT_SENSOR = 1;
+  constexpr uint8_t VENTIL_SENSOR = 0;
+  constexpr uint8_t HLT_VESSEL = 1;
+  static_assert(HLT_VESSEL < VESSEL_COUNT, "Testene kører med HLT'en: byg med -D ENABLE_HLT");
+
+  SimOneWireBus *grydeBus = nullptr;
+  SimOneWireBus *ventilBus = nullptr;
+
+  void addSensor(SimOneWireBus *bus, const OneWireRom rom, float celsius) {
+    OneWireRom address;
+    memcpy(address, rom, sizeof(OneWireRom));
+    address[7] = OneWireBus::crc8(address, 7);
+    bus->addDevice(address, celsius);
+  }
+
+  // Samme flow som loop() i main.cpp: måling, hændelser og den måleprofil,
+  // karrene beder om.
+  void run(unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += LOOP_STEP_MS) {
+      SafetySupervisor::heartbeat();
+      TemperatureHandler::update();
+      ProcessHandler::update(TemperatureHandler::getSnapshot());
+      ProcessHandler::SamplingPolicy policy = ProcessHandler::getSamplingPolicy();
+      TemperatureHandler::setResolution(policy.resolutionBits);
+      TemperatureHandler::setSampleInterval(policy.intervalMs);
+      HalSim::advance(LOOP_STEP_MS);
+    }
+  }
+
+  void setKettleTemp(float celsius) {
+    grydeBus->setTemperature(GRYDE_SENSOR, celsius);
+  }
+
+  void setHltTemp(float celsius) {
+    grydeBus->setTemperature(HLT_SENSOR, celsius);
+  }
+
+  // Et tryk på knappen; der ventes, til gestussen er afgjort.
+  void press(unsigned long holdMs = 200) {
+    HalSim::setInput(PIN_BUTTON, false);
+    run(holdMs);
+    HalSim::setInput(PIN_BUTTON, true);
+    run(ButtonHandler::DOUBLE_GAP_MS + 200);
+  }
+
+  void doublePress() {
+    HalSim::setInput(PIN_BUTTON, false);
+    run(100);
+    HalSim::setInput(PIN_BUTTON, true);
+    run(100);
+    HalSim::setInput(PIN_BUTTON, false);
+    run(100);
+    HalSim::setInput(PIN_BUTTON, true);
+    run(ButtonHandler::DOUBLE_GAP_MS + 200);
+  }
+
+  void useSchedule(Vessel &vessel, const char *steps) {
+    MashSchedule schedule;
+    TEST_ASSERT_TRUE(schedule.parse(steps));
+    TEST_ASSERT_TRUE(vessel.setSchedule(schedule));
+  }
+
+  // Fylder hændelseskøen med hændelser til et kar, der ikke findes (dispatch
+  // ignorerer dem), så karrenes egne hændelser afvises.
+  void fillQueue() {
+    ProcessHandler::Event filler = {ProcessHandler::Event::Type::COMMAND, ProcessHandler::Event::Command::NONE,
+                                    VESSEL_COUNT, 0, TEMP_RAW_INVALID, TEMP_RAW_INVALID, SensorHealth::OK,
+                                    SensorHealth::OK, 0.0f};
+    while (ProcessHandler::post(filler)) {
+    }
+  }
+
+  // Procestilstanden, som firmware fra før journalen gemte den (Vessel.cpp).
+  struct LegacyProcessState {
+    unsigned long processStartEpoch;
+    uint8_t currentState;
+    bool timerStarted;
+    uint8_t stepIndex;
+    uint8_t additionsDone;
+  };
+  constexpr int LEGACY_STATE_ADDRESS = 256;
+  constexpr unsigned long TEST_EPOCH = 1700000000UL;
+
+  // Starter mæskningen og varmer op til første trin, så nedtællingen kører.
+  void mashToFirstStep(Vessel &vessel, void (*setTemp)(float)) {
+    vessel.startMashing();
+    run(1000);
+    TEST_ASSERT_EQUAL(BrewState::MASHING, vessel.getCurrentState());
+    setTemp(tempRawToC(vessel.getSchedule().first().target) + 0.2f);
+    run(SETTLE_MS);
+  }
+}
+
+// Hver test starter fra en tom EEPROM og en kold opstart af karrene.
+void setUp() {
+  HalSim::eraseStorage();
+  HalSim::setNetworkTime(0);
+  HalSim::setInput(PIN_BUTTON, true);
+  for (uint8_t i = 0; i < 2; i++) {
+    grydeBus->setPresent(i, true);
+  }
+  setKettleTemp(AMBIENT_C);
+  setHltTemp(AMBIENT_C);
+  ventilBus->setTemperature(VENTIL_SENSOR, AMBIENT_C);
+  EEPROMHandler::begin();
+  ProcessHandler::begin(PIN_BUZZER, PIN_BUTTON);
+  run(SETTLE_MS);
+  // Først når målingerne er tilbage ved stuetemperatur, så en alarm fra
+  // forrige test ikke låses igen.
+  SafetySupervisor::begin(PIN_GAS, PIN_PUMP);
+}
+
+// Karrene stoppes, så ingen hændelser fra en test ligger i køen til den næste.
+void tearDown() {
+  for (uint8_t i = 0; i < ProcessHandler::getVesselCount(); i++) {
+    ProcessHandler::getVessel(i).stopProcess();
+  }
+  run(1000);
+}
+
+void test_begins_idle_with_heat_off() {
+  for (uint8_t i = 0; i < ProcessHandler::getVesselCount(); i++) {
+    const Vessel &vessel = ProcessHandler::getVessel(i);
+    TEST_ASSERT_EQUAL(BrewState::IDLE, vessel.getCurrentState());
+    TEST_ASSERT_FALSE(vessel.isHeating());
+    TEST_ASSERT_EQUAL(Vessel::Status::OFF, vessel.getStatus());
+  }
+  TEST_ASSERT_FALSE(ProcessHandler::isProcessActive());
+}
+
+void test_long_press_starts_mashing() {
+  press(ButtonHandler::LONG_PRESS_MS + 200);
+  run(IDLE_SAMPLE_MS);
+  Vessel &kettle = ProcessHandler::kettle();
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_EQUAL(0, kettle.getStepIndex());
+  TEST_ASSERT_FALSE(kettle.isTimerStarted());
+  TEST_ASSERT_TRUE(kettle.isHeating());
+  TEST_ASSERT_EQUAL(Vessel::Status::HEATING, kettle.getStatus());
+}
+
+void test_steps_advance_to_boil_heatup() {
+  Vessel &kettle = ProcessHandler::kettle();
+  useSchedule(kettle, "66,1,G;76,1,G");
+  mashToFirstStep(kettle, setKettleTemp);
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+  TEST_ASSERT_EQUAL(Vessel::Status::HOLDING, kettle.getStatus());
+
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_EQUAL(1, kettle.getStepIndex());
+  TEST_ASSERT_FALSE(kettle.isTimerStarted());
+
+  setKettleTemp(76.2f);
+  run(SETTLE_MS);
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(BrewState::BOILHEATUP, kettle.getCurrentState());
+}
+
+void test_confirm_at_setpoint_waits_for_button() {
+  Vessel &kettle = ProcessHandler::kettle();
+  useSchedule(kettle, "66,1,GS;76,1,G");
+  mashToFirstStep(kettle, setKettleTemp);
+  TEST_ASSERT_TRUE(kettle.isAwaitingConfirmation());
+  TEST_ASSERT_TRUE(kettle.isCalling());
+  TEST_ASSERT_FALSE(kettle.isTimerStarted());
+
+  press();
+  TEST_ASSERT_FALSE(kettle.isAwaitingConfirmation());
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+  TEST_ASSERT_EQUAL(0, kettle.getStepIndex());
+}
+
+void test_confirm_end_holds_step_until_button() {
+  Vessel &kettle = ProcessHandler::kettle();
+  useSchedule(kettle, "66,1,GE;76,1,G");
+  mashToFirstStep(kettle, setKettleTemp);
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(0, kettle.getStepIndex());
+  TEST_ASSERT_TRUE(kettle.isAwaitingConfirmation());
+
+  press();
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_EQUAL(1, kettle.getStepIndex());
+  TEST_ASSERT_FALSE(kettle.isAwaitingConfirmation());
+}
+
+void test_timer_survives_full_queue() {
+  Vessel &kettle = ProcessHandler::kettle();
+  useSchedule(kettle, "66,1,G;76,1,G");
+  mashToFirstStep(kettle, setKettleTemp);
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+
+  // Nedtællingen udløber, mens køen er fuld ved hver poll.
+  for (unsigned long t = 0; t < STEP_MS; t += LOOP_STEP_MS) {
+    fillQueue();
+    run(LOOP_STEP_MS);
+  }
+  TEST_ASSERT_EQUAL(0, kettle.getStepIndex());
+
+  run(1000);
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_EQUAL(1, kettle.getStepIndex());
+}
+
+void test_double_press_pauses_and_resumes_countdown() {
+  Vessel &kettle = ProcessHandler::kettle();
+  useSchedule(kettle, "66,10,G;76,1,G");
+  mashToFirstStep(kettle, setKettleTemp);
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+
+  doublePress();
+  TEST_ASSERT_EQUAL(BrewState::PAUSED, kettle.getCurrentState());
+  TEST_ASSERT_FALSE(kettle.isHeating());
+  unsigned long remaining = kettle.getRemainingTime();
+  setKettleTemp(60.0f);
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(remaining, kettle.getRemainingTime());
+
+  doublePress();
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_EQUAL(0, kettle.getStepIndex());
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+  TEST_ASSERT_LESS_THAN(remaining + 1, kettle.getRemainingTime());
+}
+
+void test_stop_returns_to_idle() {
+  Vessel &kettle = ProcessHandler::kettle();
+  kettle.startMashing();
+  run(IDLE_SAMPLE_MS);
+  TEST_ASSERT_TRUE(kettle.isHeating());
+
+  kettle.stopProcess();
+  run(1000);
+  TEST_ASSERT_EQUAL(BrewState::IDLE, kettle.getCurrentState());
+  TEST_ASSERT_FALSE(kettle.isHeating());
+  TEST_ASSERT_FALSE(ProcessHandler::isProcessActive());
+}
+
+void test_failed_sensor_raises_alarm_and_cuts_heat() {
+  Vessel &kettle = ProcessHandler::kettle();
+  kettle.startMashing();
+  run(IDLE_SAMPLE_MS);
+  TEST_ASSERT_TRUE(kettle.isHeating());
+
+  grydeBus->setPresent(GRYDE_SENSOR, false);
+  run(SETTLE_MS);
+  TEST_ASSERT_TRUE(kettle.isSensorAlarmActive());
+  TEST_ASSERT_TRUE(ProcessHandler::isSensorAlarmActive());
+  TEST_ASSERT_FALSE(kettle.isHeating());
+  TEST_ASSERT_EQUAL(Vessel::Status::SENSOR_FAULT, kettle.getStatus());
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+
+  // Genoptages af sig selv, når sensoren svarer igen (efter backoff).
+  grydeBus->setPresent(GRYDE_SENSOR, true);
+  run(2 * SETTLE_MS);
+  TEST_ASSERT_FALSE(kettle.isSensorAlarmActive());
+  TEST_ASSERT_TRUE(kettle.isHeating());
+}
+
+void test_hlt_holds_last_step_instead_of_boiling() {
+  Vessel &hlt = ProcessHandler::getVessel(HLT_VESSEL);
+  TEST_ASSERT_FALSE(hlt.boils());
+  useSchedule(hlt, "78,1,G");
+  mashToFirstStep(hlt, setHltTemp);
+  TEST_ASSERT_TRUE(hlt.isTimerStarted());
+
+  run(STEP_MS);
+  TEST_ASSERT_EQUAL(BrewState::MASHING, hlt.getCurrentState());
+  TEST_ASSERT_EQUAL(0, hlt.getStepIndex());
+  TEST_ASSERT_EQUAL(Vessel::Status::HOLDING, hlt.getStatus());
+  TEST_ASSERT_EQUAL(BrewState::IDLE, ProcessHandler::kettle().getCurrentState());
+
+  // Det holdte trin regulerer stadig: under målet tændes varmen igen,
+  // senest ved starten af næste PID-vindue.
+  setHltTemp(70.0f);
+  run(SETTLE_MS + hlt.getPidWindow() * 1000UL);
+  TEST_ASSERT_EQUAL(BrewState::MASHING, hlt.getCurrentState());
+  TEST_ASSERT_TRUE(hlt.isHeating());
+}
+
+void test_button_confirms_for_waiting_vessel() {
+  Vessel &kettle = ProcessHandler::kettle();
+  Vessel &hlt = ProcessHandler::getVessel(HLT_VESSEL);
+  useSchedule(kettle, "66,10,GSE;76,1,G");
+  kettle.startMashing();
+  useSchedule(hlt, "78,1,GS");
+  mashToFirstStep(hlt, setHltTemp);
+  TEST_ASSERT_TRUE(hlt.isAwaitingConfirmation());
+  TEST_ASSERT_FALSE(kettle.isAwaitingConfirmation());
+
+  press();
+  TEST_ASSERT_FALSE(hlt.isAwaitingConfirmation());
+  TEST_ASSERT_TRUE(hlt.isTimerStarted());
+  TEST_ASSERT_EQUAL(BrewState::MASHING, kettle.getCurrentState());
+  TEST_ASSERT_FALSE(kettle.isTimerStarted());
+}
+
+void test_latched_trip_keeps_fault_sounding() {
+  Vessel &kettle = ProcessHandler::kettle();
+  kettle.startMashing();
+  run(IDLE_SAMPLE_MS);
+  TEST_ASSERT_TRUE(kettle.isHeating());
+
+  setKettleTemp(SafetySupervisor::MAX_KETTLE_C + 5.0f);
+  run(SETTLE_MS);
+  TEST_ASSERT_EQUAL(SafetySupervisor::Trip::KETTLE_OVERTEMP, SafetySupervisor::getTrip());
+  TEST_ASSERT_FALSE(kettle.isHeating());
+  TEST_ASSERT_FALSE(kettle.isSensorAlarmActive());
+
+  // Mønstret skal være ønsket i hvert gennemløb, ikke kun når vagten kontrollerer.
+  for (unsigned long t = 0; t < 5000; t += LOOP_STEP_MS) {
+    run(LOOP_STEP_MS);
+    TEST_ASSERT_TRUE(BuzzerHandler::isRequested(BuzzerHandler::Pattern::FAULT));
+  }
+
+  setKettleTemp(AMBIENT_C);
+  run(SETTLE_MS);
+  TEST_ASSERT_TRUE(SafetySupervisor::reset());
+  run(LOOP_STEP_MS);
+  TEST_ASSERT_FALSE(BuzzerHandler::isRequested(BuzzerHandler::Pattern::FAULT));
+}
+
+void test_hlt_overtemp_trips_on_its_own_sensor() {
+  Vessel &hlt = ProcessHandler::getVessel(HLT_VESSEL);
+  useSchedule(hlt, "78,10,G");
+  hlt.startMashing();
+  run(IDLE_SAMPLE_MS);
+  TEST_ASSERT_TRUE(hlt.isHeating());
+
+  // Gryden er kold; kun HLT'ens egen sensor er over grænsen.
+  setHltTemp(SafetySupervisor::MAX_KETTLE_C + 5.0f);
+  run(SETTLE_MS);
+  TEST_ASSERT_EQUAL(SafetySupervisor::Trip::VESSEL_OVERTEMP, SafetySupervisor::getTrip());
+  TEST_ASSERT_FALSE(hlt.isHeating());
+  TEST_ASSERT_FALSE(Hal::digitalRead(VESSEL_PINS[HLT_VESSEL].heatPin));
+
+  setHltTemp(AMBIENT_C);
+  run(SETTLE_MS);
+  TEST_ASSERT_TRUE(SafetySupervisor::reset());
+}
+
+void test_restored_boil_starts_after_pause() {
+  // Gemt af ældre firmware i kog, før kogepunktet var fundet.
+  HalSim::setNetworkTime(TEST_EPOCH);
+  LegacyProcessState legacy = {TEST_EPOCH - 60, static_cast<uint8_t>(BrewState::BOILING), false, 0, 0};
+  memcpy(HalSim::storageData() + LEGACY_STATE_ADDRESS, &legacy, sizeof(legacy));
+  ProcessHandler::begin(PIN_BUZZER, PIN_BUTTON);
+  run(SETTLE_MS);
+  Vessel &kettle = ProcessHandler::kettle();
+  TEST_ASSERT_EQUAL(BrewState::BOILING, kettle.getCurrentState());
+  TEST_ASSERT_FALSE(kettle.isTimerStarted());
+  TEST_ASSERT_TRUE(kettle.isAwaitingConfirmation());
+
+  doublePress();
+  TEST_ASSERT_EQUAL(BrewState::PAUSED, kettle.getCurrentState());
+  doublePress();
+  TEST_ASSERT_EQUAL(BrewState::BOILING, kettle.getCurrentState());
+  TEST_ASSERT_TRUE(kettle.isAwaitingConfirmation());
+
+  press();
+  TEST_ASSERT_TRUE(kettle.isTimerStarted());
+}
+
+int main(int, char **) {
+  Serial.setOutput(nullptr);
+  grydeBus = HalSim::sensorBus(PIN_TEMP_GRYDE);
+  ventilBus = HalSim::sensorBus(PIN_TEMP_VENTIL);
+  addSensor(grydeBus, GRYDE_ROM, AMBIENT_C);
+  addSensor(ventilBus, VENTIL_ROM, AMBIENT_C);
+  addSensor(grydeBus, HLT_ROM, AMBIENT_C);
+  TemperatureHandler::begin(PIN_TEMP_GRYDE, PIN_TEMP_VENTIL);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_begins_idle_with_heat_off);
+  RUN_TEST(test_long_press_starts_mashing);
+  RUN_TEST(test_steps_advance_to_boil_heatup);
+  RUN_TEST(test_confirm_at_setpoint_waits_for_button);
+  RUN_TEST(test_confirm_end_holds_step_until_button);
+  RUN_TEST(test_timer_survives_full_queue);
+  RUN_TEST(test_double_press_pauses_and_resumes_countdown);
+  RUN_TEST(test_restored_boil_starts_after_pause);
+  RUN_TEST(test_stop_returns_to_idle);
+  RUN_TEST(test_failed_sensor_raises_alarm_and_cuts_heat);
+  RUN_TEST(test_hlt_holds_last_step_instead_of_boiling);
+  RUN_TEST(test_button_confirms_for_waiting_vessel);
+  RUN_TEST(test_latched_trip_keeps_fault_sounding);
+  RUN_TEST(test_hlt_overtemp_trips_on_its_own_sensor);
+  return UNITY_END();
+}
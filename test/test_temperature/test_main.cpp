@@ -0,0 +1,195 @@
+// Sensorernes sundhed i TemperatureHandler, kørt mod simulerede busser
+// (SimOneWireBus) i stedet for RMT:
+//
+//   pio test -e native -f test_temperature
+//
+// Fejlene sprøjtes ind på bussen – CRC-fejl og en sensor, der forsvinder –
+// og testene følger sundheden gennem SUSPECT, STALE og FAILED, pausen
+// mellem genforsøgene og vejen tilbage til OK.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "HalSim.h"
+#include "SimOneWireBus.h"
+#include "TemperatureHandler.h"
+
+namespace {
+  constexpr unsigned long SAMPLE_INTERVAL_MS = 1000;
+  constexpr unsigned long LOOP_STEP_MS = 10;
+  constexpr float GRYDE_C = 65.5f;
+  constexpr float VENTIL_C = 40.25f;
+
+  const OneWireRom GRYDE_ROM = {0x28, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  const OneWireRom VENTIL_ROM = {0x28, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  constexpr uint8_t GRYDE_SENSOR = 0;  // Indeks både på bussen og i målesættet
+
+  // Med en periode på 1 s og STALE efter 5 s uden gyldig måling: efter to
+  // fejl i træk venter sensoren 1, 2, 4 … perioder mellem forsøgene, så de
+  // første ni målesæt efter udfaldet læser den i målesæt 0, 1, 2, 4 og 8.
+  // Den femte fejl giver FAILED; uden pausen var det sket allerede i målesæt 4.
+  constexpr uint8_t FAIL_SAMPLES = 9;
+  const bool EXPECTED_ATTEMPT[FAIL_SAMPLES] = {true, true, true, false, true, false, false, false, true};
+  const SensorHealth EXPECTED_HEALTH[FAIL_SAMPLES] = {
+    SensorHealth::SUSPECT, SensorHealth::SUSPECT, SensorHealth::SUSPECT, SensorHealth::SUSPECT,
+    SensorHealth::SUSPECT, SensorHealth::STALE,   SensorHealth::STALE,   SensorHealth::STALE,
+    SensorHealth::FAILED};
+  // Pausen efter den femte fejl er 8 perioder, så næste forsøg er i målesæt 16.
+  constexpr uint8_t RETRY_AFTER_FAILED = 8;
+
+  SimOneWireBus grydeBus;
+  SimOneWireBus ventilBus;
+
+  void addSensor(SimOneWireBus &bus, const OneWireRom rom, float celsius) {
+    OneWireRom address;
+    memcpy(address, rom, sizeof(OneWireRom));
+    address[7] = OneWireBus::crc8(address, 7);
+    bus.addDevice(address, celsius);
+  }
+
+  // Kører update() som loop(), til næste målesæt er klar.
+  TemperatureSnapshot nextSample() {
+    for (unsigned long t = 0; t < 2 * SAMPLE_INTERVAL_MS; t += LOOP_STEP_MS) {
+      HalSim::advance(LOOP_STEP_MS);
+      if (TemperatureHandler::update()) {
+        return TemperatureHandler::getSnapshot();
+      }
+    }
+    TEST_FAIL_MESSAGE("Intet nyt målesæt");
+    return {};
+  }
+
+  // Et målesæt, hvor grydesensoren blev læst: Convert T er én reset-puls på
+  // bussen, og læsningen af scratchpad'en er en til.
+  TemperatureSnapshot nextSample(bool &grydeAttempted) {
+    uint32_t before = grydeBus.getTransactionCount();
+    TemperatureSnapshot sample = nextSample();
+    grydeAttempted = grydeBus.getTransactionCount() - before > 1;
+    return sample;
+  }
+
+  // Fjerner grydesensoren fra bussen og kører, til den er FAILED.
+  void failGrydeSensor() {
+    grydeBus.setPresent(GRYDE_SENSOR, false);
+    for (uint8_t i = 0; i < FAIL_SAMPLES; i++) {
+      nextSample();
+    }
+    TEST_ASSERT_EQUAL(SensorHealth::FAILED, TemperatureHandler::getSnapshot().grydeHealth);
+  }
+}
+
+// Hver test får nye busser og en frisk TemperatureHandler med ét gyldigt målesæt.
+void setUp() {
+  grydeBus = SimOneWireBus();
+  ventilBus = SimOneWireBus();
+  addSensor(grydeBus, GRYDE_ROM, GRYDE_C);
+  addSensor(ventilBus, VENTIL_ROM, VENTIL_C);
+  TemperatureHandler::begin(&grydeBus, &ventilBus, SAMPLE_INTERVAL_MS);
+  nextSample();
+}
+
+void tearDown() {}
+
+void test_discovers_and_reads_sensors() {
+  TEST_ASSERT_EQUAL(2, TemperatureHandler::getSensorCount());
+  TEST_ASSERT_EQUAL_STRING("Gryde", TemperatureHandler::getSensorName(0));
+  TEST_ASSERT_EQUAL_STRING("Ventil", TemperatureHandler::getSensorName(1));
+
+  TemperatureSnapshot sample = nextSample();
+  TEST_ASSERT_TRUE(sample.grydeValid);
+  TEST_ASSERT_TRUE(sample.ventilValid);
+  TEST_ASSERT_EQUAL(tempRawFromC(GRYDE_C), sample.grydeTemp);
+  TEST_ASSERT_EQUAL(tempRawFromC(VENTIL_C), sample.ventilTemp);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.grydeHealth);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.ventilHealth);
+}
+
+void test_crc_error_rejects_one_reading() {
+  grydeBus.injectCrcError(GRYDE_SENSOR);
+  TemperatureSnapshot sample = nextSample();
+  TEST_ASSERT_FALSE(sample.grydeValid);
+  TEST_ASSERT_EQUAL(TEMP_RAW_INVALID, sample.grydeTemp);
+  TEST_ASSERT_FALSE(sample.estimates[GRYDE_SENSOR].valid);
+  TEST_ASSERT_EQUAL(SensorHealth::SUSPECT, sample.grydeHealth);
+  // Den anden bus mærker intet.
+  TEST_ASSERT_TRUE(sample.ventilValid);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.ventilHealth);
+
+  sample = nextSample();
+  TEST_ASSERT_TRUE(sample.grydeValid);
+  TEST_ASSERT_EQUAL(tempRawFromC(GRYDE_C), sample.grydeTemp);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.grydeHealth);
+}
+
+void test_repeated_crc_errors_fail_sensor() {
+  for (uint8_t i = 0; i < FAIL_SAMPLES; i++) {
+    grydeBus.injectCrcError(GRYDE_SENSOR);  // Gælder næste læsning, også efter en pause
+    bool attempted;
+    TemperatureSnapshot sample = nextSample(attempted);
+    TEST_ASSERT_EQUAL_MESSAGE(EXPECTED_ATTEMPT[i], attempted, "Læst uden for backoff-planen");
+    TEST_ASSERT_EQUAL_MESSAGE(EXPECTED_HEALTH[i], sample.grydeHealth, "Forkert sundhed efter CRC-fejl");
+    TEST_ASSERT_FALSE(sample.grydeValid);
+  }
+}
+
+void test_dropout_backs_off_through_stale_to_failed() {
+  grydeBus.setPresent(GRYDE_SENSOR, false);
+  for (uint8_t i = 0; i < FAIL_SAMPLES; i++) {
+    bool attempted;
+    TemperatureSnapshot sample = nextSample(attempted);
+    TEST_ASSERT_EQUAL_MESSAGE(EXPECTED_ATTEMPT[i], attempted, "Læst uden for backoff-planen");
+    TEST_ASSERT_EQUAL_MESSAGE(EXPECTED_HEALTH[i], sample.grydeHealth, "Forkert sundhed efter udfald");
+    TEST_ASSERT_FALSE(sample.grydeValid);
+    TEST_ASSERT_TRUE(sample.ventilValid);
+    TEST_ASSERT_EQUAL(SensorHealth::OK, sample.ventilHealth);
+  }
+  TEST_ASSERT_EQUAL(SensorHealth::FAILED, TemperatureHandler::getGrydeHealth());
+}
+
+void test_failed_sensor_recovers_at_next_retry() {
+  failGrydeSensor();
+  grydeBus.setPresent(GRYDE_SENSOR, true);
+
+  // Sensoren svarer igen, men læses først, når pausen er gået.
+  for (uint8_t i = 1; i < RETRY_AFTER_FAILED; i++) {
+    bool attempted;
+    TemperatureSnapshot sample = nextSample(attempted);
+    TEST_ASSERT_FALSE(attempted);
+    TEST_ASSERT_EQUAL(SensorHealth::FAILED, sample.grydeHealth);
+  }
+  bool attempted;
+  TemperatureSnapshot sample = nextSample(attempted);
+  TEST_ASSERT_TRUE(attempted);
+  TEST_ASSERT_TRUE(sample.grydeValid);
+  TEST_ASSERT_EQUAL(tempRawFromC(GRYDE_C), sample.grydeTemp);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.grydeHealth);
+
+  // Derefter læses den igen i hvert målesæt.
+  sample = nextSample(attempted);
+  TEST_ASSERT_TRUE(attempted);
+  TEST_ASSERT_EQUAL(SensorHealth::OK, sample.grydeHealth);
+}
+
+void test_snapshot_goes_stale_without_new_samples() {
+  TemperatureSnapshot sample = nextSample();
+  TEST_ASSERT_EQUAL(SensorHealth::OK, TemperatureHandler::getGrydeHealth());
+
+  // Måletasken står stille: ingen update(), kun uret går.
+  HalSim::advance(TemperatureHandler::getStaleThreshold() + SAMPLE_INTERVAL_MS);
+  TEST_ASSERT_EQUAL(SensorHealth::STALE, TemperatureHandler::getGrydeHealth());
+  TEST_ASSERT_EQUAL(SensorHealth::STALE, TemperatureHandler::checkStaleness(sample.grydeHealth, sample.timestamp));
+  TEST_ASSERT_EQUAL(SensorHealth::FAILED, TemperatureHandler::checkStaleness(SensorHealth::FAILED, sample.timestamp));
+}
+
+int main(int, char **) {
+  Serial.setOutput(nullptr);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_discovers_and_reads_sensors);
+  RUN_TEST(test_crc_error_rejects_one_reading);
+  RUN_TEST(test_repeated_crc_errors_fail_sensor);
+  RUN_TEST(test_dropout_backs_off_through_stale_to_failed);
+  RUN_TEST(test_failed_sensor_recovers_at_next_retry);
+  RUN_TEST(test_snapshot_goes_stale_without_new_samples);
+  return UNITY_END();
+}